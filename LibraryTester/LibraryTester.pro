@@ -30,9 +30,30 @@ SOURCES += \
 	Libraries/Templates/relational_operators.test.cpp \
 	Libraries/cstrings/tempmem.test.cpp \
 	Libraries/cstrings/cstrings.test.cpp \
+	Libraries/cstrings/utf8.test.cpp \
 	Libraries/Templates/Array.test.cpp \
+	Libraries/Templates/SmallArray.test.cpp \
+	Libraries/Templates/MappedArray.test.cpp \
+	Libraries/Templates/FrozenHashMap.test.cpp \
+	Libraries/Templates/PerfectHashMap.test.cpp \
+	Libraries/Templates/SortedArray.test.cpp \
+	Libraries/Templates/BitArray.test.cpp \
+	Libraries/Templates/BloomFilter.test.cpp \
+	Libraries/Templates/CuckooFilter.test.cpp \
+	Libraries/Templates/ChunkedArray.test.cpp \
+	Libraries/Templates/CowArray.test.cpp \
+	Libraries/Templates/RCPool.test.cpp \
+	Libraries/Templates/RCMailbox.test.cpp \
 	Libraries/Templates/StrArray.test.cpp \
+	Libraries/Templates/PooledStrArray.test.cpp \
 	Libraries/Templates/HashMap.test.cpp \
+	Libraries/Templates/FlatHashMap.test.cpp \
+	Libraries/Templates/FilteredHashMap.test.cpp \
+	Libraries/Templates/ConcurrentHashMap.test.cpp \
+	Libraries/Templates/Queue.test.cpp \
+	Libraries/Templates/MPMCQueue.test.cpp \
+	Libraries/Templates/PriorityQueue.test.cpp \
+	Libraries/Templates/RadixTree.test.cpp \
 	Libraries/Templates/Sort.test.cpp \
 	Libraries/Templates/RCArray.test.cpp \
 	Libraries/Z80/goodies/z80_clock_cycles.test.cpp \
@@ -82,11 +103,32 @@ HEADERS += \
 	Libraries/kio/detect_configuration.h \
 	Libraries/kio/util/msbit.h \
 	Libraries/Templates/Array.h \
+	Libraries/Templates/SmallArray.h \
+	Libraries/Templates/MappedArray.h \
+	Libraries/Templates/FrozenHashMap.h \
+	Libraries/Templates/PerfectHashMap.h \
+	Libraries/Templates/SortedArray.h \
+	Libraries/Templates/BitArray.h \
+	Libraries/Templates/BloomFilter.h \
+	Libraries/Templates/CuckooFilter.h \
+	Libraries/Templates/ChunkedArray.h \
+	Libraries/Templates/CowArray.h \
 	Libraries/Templates/HashMap.h \
+	Libraries/Templates/FlatHashMap.h \
+	Libraries/Templates/FilteredHashMap.h \
+	Libraries/Templates/ConcurrentHashMap.h \
+	Libraries/cpp/cppthreads.h \
+	Libraries/Templates/Queue.h \
+	Libraries/Templates/MPMCQueue.h \
+	Libraries/Templates/PriorityQueue.h \
+	Libraries/Templates/RadixTree.h \
 	Libraries/Templates/NVPtr.h \
 	Libraries/Templates/RCPtr.h \
+	Libraries/Templates/RCPool.h \
+	Libraries/Templates/RCMailbox.h \
 	Libraries/Templates/sort.h \
 	Libraries/Templates/StrArray.h \
+	Libraries/Templates/PooledStrArray.h \
 	Libraries/Templates/sorter.h \
 	Libraries/Templates/relational_operators.h \
 	Libraries/kio/standard_types.h \
@@ -104,10 +104,20 @@ Array<NameID> Names::merge(const Names& q)
 {
 	// append names from another Names map.
 	// returns array with old-to-new ID mappings.
+	// the names are first looked up in one batch and then the missing names are added:
+	// add() may reallocate the items in the hashmap and invalidate the found pointers.
 
-	Array<NameID> map(q.hashmap.count());
+	const uint32  cnt	= q.hashmap.count();
+	Array<NameID> map(cnt);
 
-	for (uint32 id = 0; id < map.count(); id++) { map[id] = add(q.get(NameID(id))); }
+	Array<const NameID*> found(cnt);
+	hashmap.find_many(q.hashmap.getKeys().getData(), cnt, found.getData());
+	for (uint32 id = 0; id < cnt; id++) { map[id] = found[id] ? *found[id] : NameID(~0u); }
+
+	for (uint32 id = 0; id < cnt; id++)
+	{
+		if (map[id] == NameID(~0u)) map[id] = add(q.get(NameID(id)));
+	}
 
 	return map;
 }
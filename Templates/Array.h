@@ -10,6 +10,9 @@
 #include <memory>
 #include <stdexcept>
 #include <type_traits>
+#ifdef _LINUX
+  #include <sys/mman.h>
+#endif
 
 /*	Array for items and cstr
 
@@ -26,29 +29,51 @@
 
 	specializations for Array<str> and Array<cstr> with allocation in TempMem.
 	see StrArray.h for strings with new[] & delete[].
+
+	on Linux data[] for trivially copyable items is allocated with mmap() if it is ≥ ArrayMMAP bytes
+	and resized with mremap(), which avoids copying and a temporary second copy when the array grows.
 */
 
 #ifndef ArrayMAX
   #define ArrayMAX 0x40000000u /* max size  ((not count)) */
 #endif
+#if defined(_LINUX) && !defined(ArrayMMAP)
+  #define ArrayMMAP 0x00400000u /* min size for mmap() */
+#endif
 
 
 // ------------------------------------------------------------
 //				template class "Array"
 // ------------------------------------------------------------
 
+template<typename T, uint N>
+class SmallArray;
+
 template<typename T>
 class Array
 {
+	template<typename, uint>
+	friend class SmallArray; // may hand over data[]
+
 protected:
 	uint max, cnt;
 	T*	 data;
 
-	T*			allocate(uint n) throws;
+	static T*	allocate(uint max) throws;
+	static T*	reallocate(T* data, uint cnt, uint max, uint newmax) throws;
+	static void deallocate(T* data, uint max) noexcept;
 	void		memmove(uint z, uint q, uint n) noexcept { ::memmove(ptr(data + z), cptr(data + q), n * sizeof(T)); }
 	static void memcopy(T* z, const void* q, uint n) noexcept { ::memcpy(ptr(z), cptr(q), n * sizeof(T)); }
 	void		memclr(uint z, uint n) noexcept { ::memset(ptr(data + z), 0, n * sizeof(T)); }
-	void		deallocate(T* data) noexcept { delete[] ptr(data); }
+
+	static constexpr bool is_mapped(uint max) noexcept // data[] allocated with mmap()?
+	{
+#ifdef ArrayMMAP
+		return std::is_trivially_copyable<T>::value && size_t(max) * sizeof(T) >= ArrayMMAP;
+#else
+		return (void)max, false;
+#endif
+	}
 
 public:
 	static constexpr uint maxCount = ArrayMAX / sizeof(T);
@@ -64,7 +89,7 @@ public:
 	~Array() noexcept
 	{
 		for (uint i = 0; i < cnt; i++) data[i].~T();
-		deallocate(data);
+		deallocate(data, max);
 	}
 	Array() noexcept : max(0), cnt(0), data(nullptr) {}
 	Array(Array&& q) noexcept : max(q.max), cnt(q.cnt), data(q.data)
@@ -171,7 +196,7 @@ public:
 	void purge() noexcept
 	{
 		for (uint i = 0; i < cnt; i++) data[i].~T();
-		deallocate(data);
+		deallocate(data, max);
 		max = cnt = 0;
 		data	  = nullptr;
 	}
@@ -278,6 +303,43 @@ public:
 		if (cnt) ::sort(data, data + cnt, gt);
 	}
 
+	// parallel sorts: sort large arrays on all cores. these are stable:
+	void parallel_sort() throws
+	{
+		::parallel_sort(data, data + cnt);
+	} // uses gt()
+	void parallel_rsort() throws
+	{
+		::parallel_rsort(data, data + cnt);
+	} // uses lt()
+	void parallel_sort(COMPARATOR(T) gt) throws
+	{
+		::parallel_sort(data, data + cnt, gt);
+	}
+
+	// stable sorts: the order of equal items is preserved:
+	void stable_sort() throws
+	{
+		if (cnt) ::stable_sort(data, data + cnt);
+	} // uses gt()
+	void stable_rsort() throws
+	{
+		if (cnt) ::stable_rsort(data, data + cnt);
+	} // uses lt()
+	void stable_sort(COMPARATOR(T) gt) throws
+	{
+		if (cnt) ::stable_sort(data, data + cnt, gt);
+	}
+	template<typename KEYFN>
+	void radix_sort(KEYFN keyfn) throws // keyfn(T) must return an integer or float
+	{
+		if (cnt) ::radix_sort(data, data + cnt, keyfn);
+	}
+	void radix_sort() throws // for integer and float items
+	{
+		if (cnt) ::radix_sort(data, data + cnt);
+	}
+
 	void swap(uint i, uint j) noexcept
 	{
 		assert(i < cnt && j < cnt);
@@ -300,8 +362,57 @@ public:
 template<typename T>
 T* Array<T>::allocate(uint n) throws
 {
-	if (n <= maxCount) return n ? reinterpret_cast<T*>(new char[n * sizeof(T)]) : nullptr;
-	throw std::length_error(usingstr("Array::allocate(): new count = %u exceeds maximum of %u", n, maxCount));
+	if (n > maxCount)
+		throw std::length_error(usingstr("Array::allocate(): new count = %u exceeds maximum of %u", n, maxCount));
+
+	if (n == 0) return nullptr;
+
+#ifdef ArrayMMAP
+	if (is_mapped(n))
+	{
+		void* p = mmap(nullptr, size_t(n) * sizeof(T), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (p == MAP_FAILED) throw std::bad_alloc();
+		return reinterpret_cast<T*>(p);
+	}
+#endif
+
+	return reinterpret_cast<T*>(new char[n * sizeof(T)]);
+}
+
+template<typename T>
+void Array<T>::deallocate(T* data, uint max) noexcept
+{
+	// max must be the size used for allocate()
+
+#ifdef ArrayMMAP
+	if (is_mapped(max)) { munmap(data, size_t(max) * sizeof(T)); }
+	else
+#endif
+		delete[] ptr(data);
+}
+
+template<typename T>
+T* Array<T>::reallocate(T* data, uint cnt, uint max, uint newmax) throws
+{
+	// resize data[] from max to newmax and keep the first cnt items
+	// returns the new data[]; the old data[] is deallocated
+
+	assert(cnt <= max && cnt <= newmax);
+
+#ifdef ArrayMMAP
+	if (is_mapped(max) && is_mapped(newmax))
+	{
+		// let the kernel move the pages:
+		void* p = mremap(data, size_t(max) * sizeof(T), size_t(newmax) * sizeof(T), MREMAP_MAYMOVE);
+		if (p == MAP_FAILED) throw std::bad_alloc();
+		return reinterpret_cast<T*>(p);
+	}
+#endif
+
+	T* newdata = allocate(newmax);
+	memcopy(newdata, data, cnt);
+	deallocate(data, max);
+	return newdata;
 }
 
 template<typename T>
@@ -436,10 +547,7 @@ void Array<T>::growmax(uint newmax) throws
 	{
 		if (newmax < maxCount) newmax = ::min(maxCount, newmax + newmax / 8 + 4);
 
-		T* newdata = allocate(newmax);
-		memcopy(newdata, data, cnt);
-		deallocate(data);
-		data = newdata;
+		data = reallocate(data, cnt, max, newmax);
 		max	 = newmax;
 	}
 }
@@ -459,10 +567,7 @@ void Array<T>::grow(uint newcnt, uint newmax) throws
 
 	if (newmax > max)
 	{
-		T* newdata = allocate(newmax);
-		memcopy(newdata, data, cnt);
-		deallocate(data);
-		data = newdata;
+		data = reallocate(data, cnt, max, newmax);
 		max	 = newmax;
 	}
 
@@ -507,10 +612,7 @@ void Array<T>::shrink(uint newcnt) noexcept
 	{
 		try
 		{
-			T* newdata = allocate(newcnt);
-			memcopy(newdata, data, newcnt);
-			deallocate(data);
-			data = newdata;
+			data = reallocate(data, newcnt, max, newcnt);
 			max	 = newcnt;
 		}
 		catch (std::bad_alloc&)
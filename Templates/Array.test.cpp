@@ -6,6 +6,7 @@
 #include "Templates/Array.h"
 #include "doctest/doctest/doctest.h"
 #include "unix/FD.h"
+#include <sys/resource.h>
 
 
 static bool foo_gt(int a, int b) { return (a ^ 3) > (b ^ 3); }
@@ -634,6 +635,90 @@ TEST_CASE("Array")
 }
 
 
+TEST_CASE("Array: large arrays")
+{
+	// on Linux these cross the ArrayMMAP threshold
+	// and data[] is resized with mremap()
+
+	static const uint N = 3000000;
+
+	Array<uint32> a;
+	for (uint32 i = 0; i < N; i++) a.append(i * 3);
+	CHECK(a.count() == N);
+	uint errors = 0;
+	for (uint32 i = 0; i < N; i++) errors += a[i] != i * 3;
+	CHECK(errors == 0);
+
+	Array<uint32> b(a);
+	CHECK(a == b);
+	b.grow(N * 2);
+	CHECK(b[N - 1] == (N - 1) * 3);
+	CHECK(b[N * 2 - 1] == 0);
+	b.shrink(N / 2);
+	CHECK(b[N / 2 - 1] == (N / 2 - 1) * 3);
+	b.shrink(1000); // below threshold
+	CHECK(b.count() == 1000);
+	CHECK(b[999] == 999 * 3);
+	b.grow(N, N);
+	CHECK(b[999] == 999 * 3);
+	CHECK(b[1000] == 0);
+
+	Array<uint32> c(std::move(a));
+	CHECK(c.count() == N);
+	CHECK(c.last() == (N - 1) * 3);
+	c.purge();
+	CHECK(c.count() == 0);
+}
+
+static uint64 peak_rss() // in bytes
+{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return uint64(usage.ru_maxrss) * 1024;
+}
+
+static void reset_peak_rss()
+{
+	// since Linux 4.0: reset VmHWM and ru_maxrss to the current rss:
+	FILE* f = fopen("/proc/self/clear_refs", "w");
+	if (f) fputs("5", f), fclose(f);
+}
+
+struct Uint32 // not trivially copyable
+{
+	uint32 n;
+	Uint32(uint32 n = 0) : n(n) {}
+	Uint32(const Uint32& q) : n(q.n) {}
+};
+
+TEST_CASE("Array: append performance test" * doctest::skip(true))
+{
+	// append 1e9 uint32 as requested, limited by ArrayMAX
+	// compare with a not trivially copyable type which is not mapped
+
+	static const uint N = min(1000000000u, Array<uint32>::maxCount);
+
+	{
+		reset_peak_rss();
+		uint64		  rss0 = peak_rss();
+		double		  t0   = now();
+		Array<uint32> a;
+		for (uint i = 0; i < N; i++) a.append(i);
+		double t1 = now();
+		logline("Array<uint32>: append %u: %.3f sec, peak rss +%.0f MB", N, t1 - t0, double(peak_rss() - rss0) / 1e6);
+	}
+	{
+		reset_peak_rss();
+		uint64		  rss0 = peak_rss();
+		double		  t0   = now();
+		Array<Uint32> a;
+		for (uint i = 0; i < N; i++) a.append(i);
+		double t1 = now();
+		logline("Array<Uint32>: append %u: %.3f sec, peak rss +%.0f MB", N, t1 - t0, double(peak_rss() - rss0) / 1e6);
+	}
+}
+
+
 /*
 
 
@@ -0,0 +1,390 @@
+#pragma once
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+#include "Templates/Array.h"
+#include "kio/kio.h"
+#include "kio/util/count1bits.h"
+#include "kio/util/msbit.h"
+#include "unix/FD.h"
+
+
+/*	BitArray is a dense array of bits, e.g. for large 'visited' sets.
+
+	the bits are stored in an Array<uint64>, bit i is bit i%64 in words[i/64].
+	unused bits in the last word are always 0.
+	all bulk operations work on whole words: range fill, AND, OR, XOR and count1bits().
+	count1bits() uses the hardware popcount if the compiler is allowed to use it. (e.g. -mpopcnt)
+	next1() and for_each1() find the set bits with lsbit() which counts the trailing zeros.
+
+	rank1(i) counts the set bits before bit i and select1(k) finds the k-th set bit.
+	they scan the words from the start or, after build_rank_index(), from the start of the 512 bit block.
+	any modification invalidates the rank index.
+
+	operator[] aborts on failed index check!
+*/
+
+
+class BitArray
+{
+	Array<uint64> words;
+	uint		  cnt = 0;			  // number of bits
+	Array<uint32> rank_index;		  // number of set bits before each block of BLOCKBITS bits
+	bool		  indexed = false;	  // rank_index[] is valid
+
+	static constexpr uint	BLOCKBITS = 512;
+	static constexpr uint	BLOCKWORDS = BLOCKBITS / 64;
+	static constexpr uint16 MAGIC	   = 0xB175;
+
+	static uint	  numwords(uint nbits) noexcept { return (nbits + 63) / 64; }
+	static uint64 mask(uint a, uint e) noexcept; // bits [a..[e in a word, 0 ≤ a < e ≤ 64
+	void		  clear_tail() noexcept;		 // clear unused bits in the last word
+	void		  fill(uint a, uint e, uint64 value) noexcept;
+
+public:
+	BitArray() noexcept = default;
+	explicit BitArray(uint nbits, bool value = false) throws;
+
+	// access data members:
+	uint		  count() const noexcept { return cnt; } // number of bits
+	const uint64* getData() const noexcept { return words.getData(); }
+
+	bool test(uint i) const noexcept
+	{
+		assert(i < cnt);
+		return (words[i / 64] >> (i % 64)) & 1;
+	}
+	bool operator[](uint i) const noexcept { return test(i); }
+	void set(uint i) noexcept
+	{
+		assert(i < cnt);
+		words[i / 64] |= uint64(1) << (i % 64);
+		indexed = false;
+	}
+	void clear(uint i) noexcept
+	{
+		assert(i < cnt);
+		words[i / 64] &= ~(uint64(1) << (i % 64));
+		indexed = false;
+	}
+	void set(uint i, bool f) noexcept
+	{
+		if (f) set(i);
+		else clear(i);
+	}
+	void toggle(uint i) noexcept
+	{
+		assert(i < cnt);
+		words[i / 64] ^= uint64(1) << (i % 64);
+		indexed = false;
+	}
+	bool test_and_set(uint i) noexcept // set bit and return old value
+	{
+		assert(i < cnt);
+		uint64& w = words[i / 64];
+		uint64	m = uint64(1) << (i % 64);
+		bool	f = w & m;
+		w |= m;
+		indexed = false;
+		return f;
+	}
+
+	// ranges [a..[e:
+	void set_range(uint a, uint e) noexcept { fill(a, e, ~uint64(0)); }
+	void clear_range(uint a, uint e) noexcept { fill(a, e, 0); }
+
+	// resize:
+	void grow(uint newcnt) throws; // new bits are 0
+	void shrink(uint newcnt) noexcept;
+	void resize(uint newcnt) throws
+	{
+		grow(newcnt);
+		shrink(newcnt);
+	}
+	void purge() noexcept
+	{
+		words.purge();
+		rank_index.purge();
+		cnt		= 0;
+		indexed = false;
+	}
+	void append(bool f) throws
+	{
+		grow(cnt + 1);
+		if (f) set(cnt - 1);
+	}
+	BitArray& operator<<(bool f) throws
+	{
+		append(f);
+		return *this;
+	}
+
+	// bulk operations:
+	uint	  count1bits() const noexcept; // number of set bits
+	BitArray& operator&=(const BitArray&) noexcept;
+	BitArray& operator|=(const BitArray&) noexcept;
+	BitArray& operator^=(const BitArray&) noexcept;
+	void	  invert() noexcept;
+	bool	  operator==(const BitArray& q) const noexcept { return cnt == q.cnt && words == q.words; }
+	bool	  operator!=(const BitArray& q) const noexcept { return !operator==(q); }
+
+	// iterate over set bits:
+	uint next1(uint i) const noexcept; // index of next set bit ≥ i or count()
+	uint first1() const noexcept { return next1(0); }
+	template<typename FN>
+	void for_each1(FN fn) const noexcept(noexcept(fn(0u))); // calls fn(uint i) for all set bits
+
+	// rank and select:
+	void build_rank_index() throws;
+	uint rank1(uint i) const noexcept;	 // number of set bits in [0..[i
+	uint select1(uint k) const noexcept; // index of set bit with rank k or count()
+
+	// read / write file:
+	void serialize(FD&, void* data = nullptr) const throws;
+	void deserialize(FD&, void* data = nullptr) throws;
+};
+
+
+// -----------------------------------------------------------------------
+//					  I M P L E M E N T A T I O N S
+// -----------------------------------------------------------------------
+
+inline str tostr(const BitArray& array)
+{
+	// return 1-line description of array for debugging and logging:
+	return usingstr("BitArray[%u]", array.count());
+}
+
+inline BitArray::BitArray(uint nbits, bool value) throws : words(numwords(nbits)), cnt(nbits)
+{
+	if (value) set_range(0, nbits);
+}
+
+inline uint64 BitArray::mask(uint a, uint e) noexcept
+{
+	// get mask for bits [a..[e in a word
+
+	assert(a < e && e <= 64);
+	uint64 m = e == 64 ? ~uint64(0) : (uint64(1) << e) - 1;
+	return m & ~((uint64(1) << a) - 1);
+}
+
+inline void BitArray::clear_tail() noexcept
+{
+	if (cnt % 64) words.last() &= mask(0, cnt % 64);
+}
+
+inline void BitArray::fill(uint a, uint e, uint64 value) noexcept
+{
+	// set bits in range [a..[e to value
+
+	if (e > cnt) e = cnt;
+	if (a >= e) return;
+	indexed = false;
+
+	uint wa = a / 64, we = (e - 1) / 64;
+	if (wa == we)
+	{
+		uint64 m  = mask(a % 64, (e - 1) % 64 + 1);
+		words[wa] = (words[wa] & ~m) | (value & m);
+		return;
+	}
+
+	uint64 m  = mask(a % 64, 64);
+	words[wa] = (words[wa] & ~m) | (value & m);
+	for (uint i = wa + 1; i < we; i++) words[i] = value;
+	m		  = mask(0, (e - 1) % 64 + 1);
+	words[we] = (words[we] & ~m) | (value & m);
+}
+
+inline void BitArray::grow(uint newcnt) throws
+{
+	// grow array
+	// new bits are cleared to 0 because unused bits are always 0
+
+	if (newcnt <= cnt) return;
+	words.grow(numwords(newcnt));
+	cnt		= newcnt;
+	indexed = false;
+}
+
+inline void BitArray::shrink(uint newcnt) noexcept
+{
+	if (newcnt >= cnt) return;
+	words.shrink(numwords(newcnt));
+	cnt = newcnt;
+	clear_tail();
+	indexed = false;
+}
+
+inline uint BitArray::count1bits() const noexcept
+{
+	return ::count1bits(words.getData(), words.count()); //
+}
+
+inline BitArray& BitArray::operator&=(const BitArray& q) noexcept
+{
+	assert(cnt == q.cnt);
+	uint64*		  z = words.getData();
+	const uint64* p = q.words.getData();
+	for (uint i = 0; i < words.count(); i++) z[i] &= p[i];
+	indexed = false;
+	return *this;
+}
+
+inline BitArray& BitArray::operator|=(const BitArray& q) noexcept
+{
+	assert(cnt == q.cnt);
+	uint64*		  z = words.getData();
+	const uint64* p = q.words.getData();
+	for (uint i = 0; i < words.count(); i++) z[i] |= p[i];
+	indexed = false;
+	return *this;
+}
+
+inline BitArray& BitArray::operator^=(const BitArray& q) noexcept
+{
+	assert(cnt == q.cnt);
+	uint64*		  z = words.getData();
+	const uint64* p = q.words.getData();
+	for (uint i = 0; i < words.count(); i++) z[i] ^= p[i];
+	indexed = false;
+	return *this;
+}
+
+inline void BitArray::invert() noexcept
+{
+	uint64* z = words.getData();
+	for (uint i = 0; i < words.count(); i++) z[i] = ~z[i];
+	clear_tail();
+	indexed = false;
+}
+
+inline uint BitArray::next1(uint i) const noexcept
+{
+	// find next set bit at or after index i
+	// returns count() if there is none
+
+	if (i >= cnt) return cnt;
+
+	uint   wi = i / 64;
+	uint64 w  = words[wi] & ~((uint64(1) << (i % 64)) - 1);
+	while (w == 0)
+	{
+		if (++wi == words.count()) return cnt;
+		w = words[wi];
+	}
+	return wi * 64 + uint(lsbit(w));
+}
+
+template<typename FN>
+void BitArray::for_each1(FN fn) const noexcept(noexcept(fn(0u)))
+{
+	// call fn(i) for all set bits in ascending order
+
+	for (uint wi = 0; wi < words.count(); wi++)
+	{
+		for (uint64 w = words[wi]; w; w &= w - 1) { fn(wi * 64 + uint(lsbit(w))); }
+	}
+}
+
+inline void BitArray::build_rank_index() throws
+{
+	// store the number of set bits before each block of BLOCKBITS bits
+
+	uint nblocks = (words.count() + BLOCKWORDS - 1) / BLOCKWORDS;
+	rank_index.purge();
+	rank_index.grow(0, nblocks);
+
+	uint32 n = 0;
+	for (uint b = 0; b < nblocks; b++)
+	{
+		rank_index.append(n);
+		uint a = b * BLOCKWORDS, e = min(a + BLOCKWORDS, words.count());
+		n += ::count1bits(words.getData() + a, e - a);
+	}
+	indexed = true;
+}
+
+inline uint BitArray::rank1(uint i) const noexcept
+{
+	// count set bits in [0..[i
+
+	if (i > cnt) i = cnt;
+	uint wi = i / 64;
+	uint n	= 0, a = 0;
+
+	if (indexed)
+	{
+		uint b = wi / BLOCKWORDS;
+		if (b < rank_index.count())
+		{
+			n = rank_index[b];
+			a = b * BLOCKWORDS;
+		}
+	}
+
+	n += ::count1bits(words.getData() + a, wi - a);
+	if (i % 64) n += ::count1bits(words[wi] & mask(0, i % 64));
+	return n;
+}
+
+inline uint BitArray::select1(uint k) const noexcept
+{
+	// find index of the set bit with rank k: k = 0 => first set bit
+	// returns count() if there are not so many bits set
+
+	uint wi = 0;
+
+	if (indexed && rank_index.count())
+	{
+		// binary search for the last block which starts with rank ≤ k:
+		uint a = 0, e = rank_index.count();
+		while (e - a > 1)
+		{
+			uint m = (a + e) / 2;
+			if (rank_index[m] <= k) a = m;
+			else e = m;
+		}
+		k -= rank_index[a];
+		wi = a * BLOCKWORDS;
+	}
+
+	for (; wi < words.count(); wi++)
+	{
+		uint64 w = words[wi];
+		uint   n = ::count1bits(w);
+		if (k >= n)
+		{
+			k -= n;
+			continue;
+		}
+		while (k--) w &= w - 1; // clear the lowest k bits
+		return wi * 64 + uint(lsbit(w));
+	}
+	return cnt;
+}
+
+inline void BitArray::serialize(FD& fd, void* data) const throws
+{
+	fd.write_uint16_z(MAGIC);
+	fd.write_uint32_z(cnt);
+	words.serialize(fd, data);
+}
+
+inline void BitArray::deserialize(FD& fd, void* data) throws
+{
+	// deserialize: supports reading back on byte swapped host.
+
+	if (fd.read_uint16_z() != MAGIC) throw DataError("BitArray: wrong magic");
+	uint		  n = fd.read_uint32_z();
+	Array<uint64> w;
+	w.deserialize(fd, data);
+	if (w.count() != numwords(n)) throw DataError("BitArray: size mismatch");
+
+	purge();
+	words = std::move(w);
+	cnt	  = n;
+	clear_tail();
+}
@@ -0,0 +1,218 @@
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+
+#include "Templates/BitArray.h"
+#include "doctest/doctest/doctest.h"
+#include "unix/FD.h"
+
+
+TEST_CASE("BitArray")
+{
+	SUBCASE("") { logline("●●● %s:", __FILE__); }
+
+	SUBCASE("set, clear, test")
+	{
+		BitArray a;
+		CHECK(a.count() == 0);
+		CHECK(a.count1bits() == 0);
+		CHECK(a.first1() == 0);
+
+		a.grow(200);
+		CHECK(a.count() == 200);
+		CHECK(a.count1bits() == 0);
+		a.set(0);
+		a.set(63);
+		a.set(64);
+		a.set(199);
+		CHECK(a[0]);
+		CHECK(!a[1]);
+		CHECK(a.test(63));
+		CHECK(a.test(64));
+		CHECK(a.test(199));
+		CHECK(a.count1bits() == 4);
+		a.clear(63);
+		a.toggle(64);
+		a.toggle(65);
+		a.set(66, true);
+		a.set(0, false);
+		CHECK(!a[63]);
+		CHECK(!a[64]);
+		CHECK(a[65]);
+		CHECK(a[66]);
+		CHECK(!a[0]);
+		CHECK(a.count1bits() == 3);
+		CHECK(a.test_and_set(100) == false);
+		CHECK(a.test_and_set(100) == true);
+
+		a << true << false << true;
+		CHECK(a.count() == 203);
+		CHECK(a[200] && !a[201] && a[202]);
+
+		a.shrink(66);
+		CHECK(a.count1bits() == 1);
+		a.grow(300); // the cleared bits must not come back
+		CHECK(a.count1bits() == 1);
+		a.purge();
+		CHECK(a.count() == 0);
+	}
+
+	SUBCASE("ranges")
+	{
+		uint errors = 0;
+		for (uint a = 0; a < 200; a += 7)
+		{
+			for (uint e = a; e <= 260; e += 5)
+			{
+				BitArray b(250);
+				b.set_range(a, e);
+				uint n = min(e, 250u) - min(a, 250u);
+				errors += b.count1bits() != n;
+				for (uint i = 0; i < 250; i++) errors += b[i] != (i >= a && i < e);
+
+				BitArray c(250, true);
+				c.clear_range(a, e);
+				errors += c.count1bits() != 250 - n;
+				c.invert();
+				errors += c != b;
+			}
+		}
+		CHECK(errors == 0);
+
+		BitArray d(100, true);
+		CHECK(d.count1bits() == 100);
+		d.invert();
+		CHECK(d.count1bits() == 0);
+	}
+
+	SUBCASE("bulk operations")
+	{
+		BitArray a(1000), b(1000);
+		for (uint i = 0; i < 1000; i += 2) a.set(i);
+		for (uint i = 0; i < 1000; i += 3) b.set(i);
+
+		BitArray c(a);
+		c &= b;
+		CHECK(c.count1bits() == 167); // multiples of 6
+		c = a;
+		c |= b;
+		CHECK(c.count1bits() == 500 + 334 - 167);
+		c = a;
+		c ^= b;
+		CHECK(c.count1bits() == 500 + 334 - 2 * 167);
+		CHECK(c != a);
+		c ^= b;
+		CHECK(c == a);
+	}
+
+	SUBCASE("iterate")
+	{
+		BitArray a(1000);
+		for (uint i = 3; i < 1000; i += 37) a.set(i);
+
+		Array<uint> z;
+		for (uint i = a.first1(); i < a.count(); i = a.next1(i + 1)) z << i;
+		Array<uint> z2;
+		a.for_each1([&](uint i) { z2 << i; });
+		CHECK(z == z2);
+		CHECK(z.count() == 27);
+		CHECK(z[0] == 3);
+		CHECK(z[1] == 40);
+		CHECK(z.last() == 965);
+		CHECK(a.next1(966) == 1000);
+	}
+
+	SUBCASE("rank and select")
+	{
+		BitArray a(5000);
+		for (uint i = 0; i < 5000; i++)
+		{
+			if (random() % 3 == 0) a.set(i);
+		}
+		Array<uint> ones;
+		a.for_each1([&](uint i) { ones << i; });
+
+		for (int indexed = 0; indexed <= 1; indexed++)
+		{
+			if (indexed) a.build_rank_index();
+			uint errors = 0;
+			for (uint i = 0, r = 0; i <= 5000; i++)
+			{
+				errors += a.rank1(i) != r;
+				if (i < 5000 && a[i]) r++;
+			}
+			for (uint k = 0; k < ones.count(); k++) errors += a.select1(k) != ones[k];
+			errors += a.select1(ones.count()) != 5000;
+			CHECK(errors == 0);
+		}
+
+		// modification invalidates the index:
+		a.set(0);
+		a.set(1);
+		a.set(2);
+		CHECK(a.rank1(5000) == a.count1bits());
+		CHECK(a.select1(2) == 2);
+	}
+
+	SUBCASE("serialize")
+	{
+		BitArray a(1234);
+		for (uint i = 0; i < 1234; i += 5) a.set(i);
+
+		FD fd;
+		fd.open_tempfile();
+		a.serialize(fd);
+		fd.write_char('X');
+
+		fd.rewind_file();
+		BitArray b(10, true);
+		b.deserialize(fd);
+		CHECK(a == b);
+		CHECK(fd.read_char() == 'X');
+	}
+}
+
+
+TEST_CASE("BitArray performance test" * doctest::skip(false))
+{
+	// visited set with 100M entries: BitArray vs. Array<bool>
+
+	static constexpr uint N = 100000000;
+	static constexpr uint M = 10000000;
+
+	Array<uint> idx(M);
+	for (uint i = 0; i < M; i++) idx[i] = uint(random()) % N;
+
+	double		t0 = now();
+	Array<bool> a(N);
+	uint		n1 = 0;
+	for (uint i = 0; i < M; i++)
+	{
+		bool& f = a[idx[i]];
+		n1 += f;
+		f = true;
+	}
+	double t1 = now();
+	uint   c1 = 0;
+	for (uint i = 0; i < N; i++) c1 += a[i];
+	double t2 = now();
+	a.purge();
+
+	double	 t3 = now();
+	BitArray b(N);
+	uint	 n2 = 0;
+	for (uint i = 0; i < M; i++) n2 += b.test_and_set(idx[i]);
+	double t4 = now();
+	uint   c2 = b.count1bits();
+	double t5 = now();
+
+	CHECK(n1 == n2);
+	CHECK(c1 == c2);
+	CHECK(c1 == M - n1);
+
+	logline("Array<bool>: 100M visited set: %3u MB, test_and_set %.1f ns, count %.3f sec", N >> 20,
+			(t1 - t0) * 1e9 / M, t2 - t1);
+	logline("BitArray:    100M visited set: %3u MB, test_and_set %.1f ns, count %.3f sec", N >> 23,
+			(t4 - t3) * 1e9 / M, t5 - t4);
+}
@@ -0,0 +1,207 @@
+#pragma once
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+#include "Templates/Array.h"
+#include "hash/hash.h"
+#include "kio/kio.h"
+#include "unix/FD.h"
+#include <math.h>
+
+
+/*	BloomFilter<KEY> tests whether a key may be in a set.
+
+	contains() returns false if the key was never added and true if it was added.
+	It may also return true for keys which were not added. (a 'false positive')
+	The false positive rate is set in the ctor for the expected number of keys.
+	Keys can't be removed. See CuckooFilter for a filter with remove().
+
+	This is a blocked Bloom filter: all bits for a key are in one block of 512 bits = one cache line.
+	The key is hashed with kio::hash() which is spread over 64 bits with fmix64().
+	The low 32 bits select the block and the bits in the block are selected with enhanced double hashing:
+	bit[i+1] = (bit[i] + b + i*(i+1)/2) % 512 with bit[0] and b taken from the high 32 bits.
+	For the same size and number of bits per key the false positive rate is higher than for a classic
+	Bloom filter, but a lookup costs only one cache miss. The ctor adds some bits to compensate for this.
+	For very low rates the real false positive rate is still a little bit higher, e.g. 0.0014 for 0.001.
+
+	Keys are hashed with kio::hash(). Keys which have the same hash are the same for the filter.
+*/
+
+
+template<typename KEY>
+class BloomFilter
+{
+	Array<uint64> words;	 // nblocks * BLOCKWORDS
+	uint		  nblocks = 0;
+	uint		  nbits	  = 0; // bits set per key
+	uint		  cnt	  = 0; // number of add()s
+
+	static constexpr uint	BLOCKBITS  = 512;
+	static constexpr uint	BLOCKWORDS = BLOCKBITS / 64;
+	static constexpr uint16 MAGIC	   = 0xB10F;
+
+	static uint64 hash64(KEY key) noexcept { return kio::fmix64(kio::hash(key)); }
+	const uint64* block(uint64 h) const noexcept
+	{
+		return words.getData() + uint((uint64(uint32(h)) * nblocks) >> 32) * BLOCKWORDS;
+	}
+
+public:
+	BloomFilter() noexcept = default;
+	explicit BloomFilter(uint max, double fp_rate = 0.01) throws;
+
+	// access data members:
+	uint count() const noexcept { return cnt; } // number of add()s
+	uint getBitCount() const noexcept { return nblocks * BLOCKBITS; }
+	uint getHashCount() const noexcept { return nbits; } // bits set per key
+	double estimateFpRate() const noexcept { return estimateFpRate(cnt, nblocks, nbits); }
+	static double estimateFpRate(uint n, uint nblocks, uint nbits) noexcept;
+
+	// add keys:
+	void add(KEY key) noexcept;
+	void add_all(const Array<KEY>& keys) noexcept;
+	void purge() noexcept; // remove all keys
+
+	// test keys:
+	bool contains(KEY key) const noexcept;
+
+	// read / write file:
+	void serialize(FD&, void* data = nullptr) const throws;
+	void deserialize(FD&, void* data = nullptr) throws;
+};
+
+
+// -----------------------------------------------------------------------
+//					  I M P L E M E N T A T I O N S
+// -----------------------------------------------------------------------
+
+template<typename KEY>
+inline str tostr(const BloomFilter<KEY>& filter)
+{
+	// return 1-line description of filter for debugging and logging:
+	return usingstr("BloomFilter[%u]", filter.count());
+}
+
+template<typename KEY>
+double BloomFilter<KEY>::estimateFpRate(uint n, uint nblocks, uint nbits) noexcept
+{
+	// false positive rate of a blocked Bloom filter:
+	// the number of keys per block has a Poisson distribution with lambda = n / nblocks
+	// and a block with j keys has the false positive rate of a classic Bloom filter with 512 bits
+
+	double lambda = double(n) / nblocks;
+	double p	  = exp(-lambda); // probability for j keys in a block
+	double rate	  = 0;
+	for (uint j = 1; j < lambda + 10 * sqrt(lambda) + 10; j++)
+	{
+		p *= lambda / j;
+		rate += p * pow(1 - pow(1 - 1.0 / BLOCKBITS, double(nbits) * j), nbits);
+	}
+	return rate;
+}
+
+template<typename KEY>
+BloomFilter<KEY>::BloomFilter(uint n, double fp_rate) throws
+{
+	// calculate size and number of bits per key for the desired false positive rate:
+	// classic Bloom filter: bits = -n * ln(p) / ln(2)², k = bits / n * ln(2)
+	// the blocked filter needs some more bits, the more the lower the false positive rate:
+	// add bits until the estimated rate is reached
+
+	assert(fp_rate > 0 && fp_rate < 1);
+	if (n == 0) n = 1;
+
+	static constexpr double maxblocks = Array<uint64>::maxCount / BLOCKWORDS;
+
+	for (double bits = -double(n) * log(fp_rate) / (M_LN2 * M_LN2);; bits *= 1.05)
+	{
+		nblocks = uint(min(ceil(bits / BLOCKBITS), maxblocks));
+		nbits	= uint(min(max(round(bits / n * M_LN2), 1.0), 16.0));
+		if (nblocks == maxblocks || estimateFpRate(n, nblocks, nbits) <= fp_rate) break;
+	}
+	words.grow(nblocks * BLOCKWORDS);
+}
+
+template<typename KEY>
+void BloomFilter<KEY>::add(KEY key) noexcept
+{
+	assert(nblocks);
+
+	uint64	h = hash64(key);
+	uint64* p = const_cast<uint64*>(block(h));
+	uint	a = uint(h >> 32) % BLOCKBITS;
+	uint	b = uint(h >> 41) % BLOCKBITS | 1;
+
+	for (uint i = 0; i < nbits; i++, a = (a + b) % BLOCKBITS, b += i) { p[a / 64] |= uint64(1) << (a % 64); }
+	cnt++;
+}
+
+template<typename KEY>
+void BloomFilter<KEY>::add_all(const Array<KEY>& keys) noexcept
+{
+	// add keys
+	// the block for a key a few keys ahead is prefetched
+
+	static constexpr uint AHEAD = 8;
+
+	uint n = keys.count();
+	for (uint i = 0; i < n; i++)
+	{
+		if (i + AHEAD < n) __builtin_prefetch(block(hash64(keys[i + AHEAD])), 1);
+		add(keys[i]);
+	}
+}
+
+template<typename KEY>
+void BloomFilter<KEY>::purge() noexcept
+{
+	memset(words.getData(), 0, words.count() * sizeof(uint64));
+	cnt = 0;
+}
+
+template<typename KEY>
+bool BloomFilter<KEY>::contains(KEY key) const noexcept
+{
+	if (nblocks == 0) return false;
+
+	uint64		  h = hash64(key);
+	const uint64* p = block(h);
+	uint		  a = uint(h >> 32) % BLOCKBITS;
+	uint		  b = uint(h >> 41) % BLOCKBITS | 1;
+
+	for (uint i = 0; i < nbits; i++, a = (a + b) % BLOCKBITS, b += i)
+	{
+		if ((p[a / 64] & (uint64(1) << (a % 64))) == 0) return false;
+	}
+	return true;
+}
+
+template<typename KEY>
+void BloomFilter<KEY>::serialize(FD& fd, void* data) const throws
+{
+	fd.write_uint16_z(MAGIC);
+	fd.write_uint8(uint8(nbits));
+	fd.write_uint32_z(nblocks);
+	fd.write_uint32_z(cnt);
+	words.serialize(fd, data);
+}
+
+template<typename KEY>
+void BloomFilter<KEY>::deserialize(FD& fd, void* data) throws
+{
+	// deserialize: supports reading back on byte swapped host.
+
+	if (fd.read_uint16_z() != MAGIC) throw DataError("BloomFilter: wrong magic");
+	uint		  k = fd.read_uint8();
+	uint		  n = fd.read_uint32_z();
+	uint		  c = fd.read_uint32_z();
+	Array<uint64> w;
+	w.deserialize(fd, data);
+	if (w.count() != n * BLOCKWORDS || k > 16) throw DataError("BloomFilter: size mismatch");
+
+	words	= std::move(w);
+	nblocks = n;
+	nbits	= k;
+	cnt		= c;
+}
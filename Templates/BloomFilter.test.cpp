@@ -0,0 +1,115 @@
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+
+#include "Templates/BloomFilter.h"
+#include "doctest/doctest/doctest.h"
+#include "unix/FD.h"
+
+
+TEST_CASE("BloomFilter")
+{
+	SUBCASE("") { logline("●●● %s:", __FILE__); }
+
+	SUBCASE("empty filter")
+	{
+		BloomFilter<uint> f;
+		CHECK(f.count() == 0);
+		CHECK(!f.contains(0));
+		CHECK(!f.contains(42));
+
+		BloomFilter<uint> g(100);
+		CHECK(g.getBitCount() >= 100 * 9);
+		CHECK(g.getHashCount() == 7);
+		CHECK(!g.contains(42));
+	}
+
+	SUBCASE("no false negatives, false positive rate")
+	{
+		static constexpr uint N = 100000;
+
+		for (double fp_rate : {0.1, 0.01, 0.001})
+		{
+			BloomFilter<uint> f(N, fp_rate);
+			for (uint i = 0; i < N; i++) f.add(i * 7);
+			CHECK(f.count() == N);
+
+			uint errors = 0;
+			for (uint i = 0; i < N; i++) errors += !f.contains(i * 7);
+			CHECK(errors == 0);
+
+			uint fp = 0;
+			for (uint i = 0; i < N; i++) fp += f.contains(i * 7 + 3);
+			CHECK(fp < N * fp_rate * 1.5);
+			CHECK(fp > N * fp_rate / 2);
+			CHECK(f.estimateFpRate() < fp_rate * 1.01);
+		}
+	}
+
+	SUBCASE("cstr keys, add_all, purge")
+	{
+		Array<cstr> keys;
+		for (uint i = 0; i < 1000; i++) keys << usingstr("key%u", i);
+
+		BloomFilter<cstr> f(1000, 0.001);
+		f.add_all(keys);
+		CHECK(f.count() == 1000);
+		uint errors = 0;
+		for (uint i = 0; i < 1000; i++) errors += !f.contains(usingstr("key%u", i)); // compared by value
+		CHECK(errors == 0);
+		CHECK(!f.contains("foo"));
+
+		f.purge();
+		CHECK(f.count() == 0);
+		CHECK(!f.contains("key0"));
+	}
+
+	SUBCASE("serialize")
+	{
+		BloomFilter<uint64> f(5000);
+		for (uint i = 0; i < 5000; i++) f.add(i * 1000003ull);
+
+		FD fd;
+		fd.open_tempfile();
+		f.serialize(fd);
+		fd.write_uint32_z(0x12345678); // garbage
+		fd.rewind_file();
+
+		BloomFilter<uint64> g;
+		g.deserialize(fd);
+		CHECK(g.count() == 5000);
+		CHECK(g.getBitCount() == f.getBitCount());
+		CHECK(g.getHashCount() == f.getHashCount());
+		uint errors = 0;
+		for (uint i = 0; i < 5000; i++) errors += !g.contains(i * 1000003ull);
+		for (uint i = 0; i < 5000; i++) errors += g.contains(i * 3 + 1) != f.contains(i * 3 + 1);
+		CHECK(errors == 0);
+
+		CHECK_THROWS_AS(g.deserialize(fd), DataError);
+	}
+}
+
+
+TEST_CASE("BloomFilter performance test" * doctest::skip(false))
+{
+	static constexpr uint N = 4000000;
+
+	Array<uint> keys;
+	for (uint i = 0; i < N; i++) keys << i * 2654435761u;
+
+	double			  t0 = now();
+	BloomFilter<uint> f(N, 0.01);
+	for (uint i = 0; i < N; i++) f.add(keys[i]);
+	double			  t1 = now();
+	BloomFilter<uint> g(N, 0.01);
+	g.add_all(keys);
+	double t2 = now();
+
+	uint n = 0;
+	for (uint i = 0; i < N; i++) n += f.contains(keys[i] + 1);
+	double t3 = now();
+
+	logline("BloomFilter: %u keys, %u bits per key, add %.1f ns, add_all %.1f ns, miss %.1f ns, fp rate %.3f %%", N,
+			f.getHashCount(), (t1 - t0) * 1e9 / N, (t2 - t1) * 1e9 / N, (t3 - t2) * 1e9 / N, n * 100.0 / N);
+}
@@ -0,0 +1,505 @@
+#pragma once
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+#include "Templates/Array.h"
+#include "kio/kio.h"
+#include "template_helpers.h"
+#include "unix/FD.h"
+
+
+/*	ChunkedArray<T> is an array of items which are stored in chunks of fixed size.
+
+	The chunks are listed in a directory, which is an Array<T*>.
+	When the array grows only a new chunk is allocated, the items are never moved:
+	- append() is O(1), not only amortized, and there is no temporary second copy of the data.
+	- references and pointers to items remain valid until the item is removed.
+	- operator[] is O(1) with one additional indirection through the directory.
+	Items can be iterated per chunk with for_each_chunk() or getChunk().
+
+	The chunk size is a power of 2 and by default ~16 kB.
+	shrink() keeps one spare chunk so that append() and drop() at a chunk boundary don't thrash.
+
+	ChunkedArray has the same core API as Array and the same assumptions about items:
+	new items are initialized with zero.
+	items are moved around in memory with memcpy(), e.g. in removeat().
+	serialize() writes the same format as Array<T>.
+
+	operator[] aborts on failed index check!
+*/
+
+
+namespace kio
+{
+constexpr uint chunked_array_bits(size_t itemsize) noexcept
+{
+	// number of bits for the index in a chunk: ~16 kB per chunk, but at least 16 items
+
+	uint bits = 14;
+	while (bits > 4 && (size_t(1) << bits) * itemsize > 16384) bits--;
+	return bits;
+}
+} // namespace kio
+
+
+template<typename T, uint CHUNKBITS = kio::chunked_array_bits(sizeof(T))>
+class ChunkedArray
+{
+public:
+	static constexpr uint CHUNKSIZE = 1u << CHUNKBITS; // items per chunk
+	static constexpr uint maxCount	= 0x80000000u;
+
+protected:
+	static constexpr uint MASK = CHUNKSIZE - 1;
+
+	Array<T*> chunks; // all chunks[] are allocated, plus one spare chunk maybe
+	uint	  cnt = 0;
+
+	static T*	new_chunk() throws { return reinterpret_cast<T*>(new char[CHUNKSIZE * sizeof(T)]); }
+	static void delete_chunk(T* p) noexcept { delete[] reinterpret_cast<char*>(p); }
+
+	T&		 at(uint i) noexcept { return chunks.getData()[i >> CHUNKBITS][i & MASK]; }
+	const T& at(uint i) const noexcept { return chunks.getData()[i >> CHUNKBITS][i & MASK]; }
+	void	 memclr(uint a, uint e) noexcept;  // clear items in range [a..[e
+	void	 destroy(uint a, uint e) noexcept; // destroy items in range [a..[e
+	void	 release_chunks(uint n) noexcept;  // keep n chunks
+
+public:
+	static void swap(ChunkedArray& a, ChunkedArray& b) noexcept
+	{
+		Array<T*>::swap(a.chunks, b.chunks);
+		std::swap(a.cnt, b.cnt);
+	}
+
+	~ChunkedArray() noexcept { purge(); }
+	ChunkedArray() noexcept = default;
+	ChunkedArray(ChunkedArray&& q) noexcept : chunks(std::move(q.chunks)), cnt(q.cnt) { q.cnt = 0; }
+	ChunkedArray(const ChunkedArray& q) throws;
+	ChunkedArray& operator=(ChunkedArray&& q) noexcept
+	{
+		swap(*this, q);
+		return *this;
+	}
+	ChunkedArray& operator=(const ChunkedArray& q) throws { return operator=(ChunkedArray(q)); }
+	explicit ChunkedArray(uint cnt, uint max = 0) throws;
+	ChunkedArray(const T* q, uint n) throws : ChunkedArray(0u, n) { append(q, n); }
+
+	// access data members:
+	uint	 count() const noexcept { return cnt; }
+	uint	 capacity() const noexcept { return chunks.count() * CHUNKSIZE; }
+	uint	 chunkCount() const noexcept { return (cnt + MASK) >> CHUNKBITS; } // chunks in use
+	T*		 getChunk(uint ci) noexcept { return chunks[ci]; }
+	const T* getChunk(uint ci) const noexcept { return chunks[ci]; }
+	uint	 chunkItems(uint ci) const noexcept { return min(cnt - (ci << CHUNKBITS), CHUNKSIZE); }
+
+	const T& operator[](uint i) const noexcept
+	{
+		assert(i < cnt);
+		return at(i);
+	}
+	T& operator[](uint i) noexcept
+	{
+		assert(i < cnt);
+		return at(i);
+	}
+	const T& operator[](int i) const noexcept
+	{
+		assert(uint(i) < cnt);
+		return at(uint(i));
+	}
+	T& operator[](int i) noexcept
+	{
+		assert(uint(i) < cnt);
+		return at(uint(i));
+	}
+	const T& first() const noexcept
+	{
+		assert(cnt);
+		return at(0);
+	}
+	T& first() noexcept
+	{
+		assert(cnt);
+		return at(0);
+	}
+	const T& last() const noexcept
+	{
+		assert(cnt);
+		return at(cnt - 1);
+	}
+	T& last() noexcept
+	{
+		assert(cnt);
+		return at(cnt - 1);
+	}
+
+	// iterate per chunk: calls fn(T* items, uint n) for all chunks in use
+	template<typename FN>
+	void for_each_chunk(FN fn) noexcept(noexcept(fn(static_cast<T*>(nullptr), 0u)));
+	template<typename FN>
+	void for_each_chunk(FN fn) const noexcept(noexcept(fn(static_cast<const T*>(nullptr), 0u)));
+
+	bool operator==(const ChunkedArray& q) const noexcept; // uses ne()
+	bool operator!=(const ChunkedArray& q) const noexcept { return !operator==(q); }
+
+	uint indexof(REForVALUE(T) item) const noexcept; // compare using '==' except str/cstr: 'eq'
+	bool contains(REForVALUE(T) item) const noexcept { return indexof(item) != ~0u; } // uses indexof()
+
+	// resize:
+	void growmax(uint newmax) throws;
+	T&	 grow() throws
+	{
+		growmax(cnt + 1);
+		return *new (&at(cnt++)) T();
+	}
+	void grow(uint cnt, uint max) throws;
+	void grow(uint newcnt) throws { grow(newcnt, newcnt); }
+	void shrink(uint newcnt) noexcept;
+	void resize(uint newcnt) throws
+	{
+		grow(newcnt);
+		shrink(newcnt);
+	}
+	void drop() noexcept
+	{
+		assert(cnt);
+		at(--cnt).~T();
+	}
+	T pop() noexcept
+	{
+		assert(cnt);
+		return std::move(at(--cnt));
+	}
+	void purge() noexcept
+	{
+		destroy(0, cnt);
+		cnt = 0;
+		release_chunks(0);
+	}
+	T& append(T q) throws
+	{
+		growmax(cnt + 1);
+		return *new (&at(cnt++)) T(std::move(q));
+	}
+	void append(const T* q, uint n) throws;
+	void appendifnew(T q) throws
+	{
+		if (!contains(q)) append(std::move(q));
+	} // uses indexof()
+	ChunkedArray& operator<<(T q) throws
+	{
+		append(std::move(q));
+		return *this;
+	}
+
+	void removeat(uint idx, bool fast = 0) noexcept; // fast: move last item into the gap
+	void swap(uint i, uint j) noexcept
+	{
+		assert(i < cnt && j < cnt);
+		std::swap(at(i), at(j));
+	}
+
+	static const uint16 MAGIC			  = Array<T>::MAGIC;
+	static const uint16 BYTESWAPPED_MAGIC = Array<T>::BYTESWAPPED_MAGIC;
+
+	void serialize(FD&, void* data = nullptr) const throws;
+	void deserialize(FD&, void* data = nullptr) throws;
+};
+
+
+// -----------------------------------------------------------------------
+//					  I M P L E M E N T A T I O N S
+// -----------------------------------------------------------------------
+
+template<typename T, uint B>
+inline str tostr(const ChunkedArray<T, B>& array)
+{
+	// return 1-line description of array for debugging and logging:
+	return usingstr("ChunkedArray<T>[%u]", array.count());
+}
+
+template<typename T, uint B>
+void ChunkedArray<T, B>::memclr(uint a, uint e) noexcept
+{
+	while (a < e)
+	{
+		uint n = min(e, (a | MASK) + 1) - a; // up to the end of the chunk
+		::memset(ptr(&at(a)), 0, n * sizeof(T));
+		a += n;
+	}
+}
+
+template<typename T, uint B>
+void ChunkedArray<T, B>::destroy(uint a, uint e) noexcept
+{
+	if (std::is_trivially_destructible<T>::value) return;
+	for (uint i = a; i < e; i++) at(i).~T();
+}
+
+template<typename T, uint B>
+void ChunkedArray<T, B>::release_chunks(uint n) noexcept
+{
+	// release all chunks after the first n chunks
+
+	while (chunks.count() > n) delete_chunk(chunks.pop());
+	if (n == 0) chunks.purge();
+}
+
+template<typename T, uint B>
+ChunkedArray<T, B>::ChunkedArray(const ChunkedArray& q) throws
+{
+	// the dtor is not called if the ctor throws: destroy the copied items and release the chunks
+
+	try
+	{
+		growmax(q.cnt);
+		for (uint i = 0; i < q.cnt; i++) { new (&at(i)) T(q.at(i)), cnt++; }
+	}
+	catch (...)
+	{
+		purge();
+		throw;
+	}
+}
+
+template<typename T, uint B>
+ChunkedArray<T, B>::ChunkedArray(uint cnt, uint max) throws
+{
+	grow(cnt, max);
+}
+
+template<typename T, uint B>
+template<typename FN>
+void ChunkedArray<T, B>::for_each_chunk(FN fn) noexcept(noexcept(fn(static_cast<T*>(nullptr), 0u)))
+{
+	for (uint ci = 0; ci < chunkCount(); ci++) fn(chunks[ci], chunkItems(ci));
+}
+
+template<typename T, uint B>
+template<typename FN>
+void ChunkedArray<T, B>::for_each_chunk(FN fn) const noexcept(noexcept(fn(static_cast<const T*>(nullptr), 0u)))
+{
+	for (uint ci = 0; ci < chunkCount(); ci++) fn(static_cast<const T*>(chunks[ci]), chunkItems(ci));
+}
+
+template<typename T, uint B>
+bool ChunkedArray<T, B>::operator==(const ChunkedArray& q) const noexcept
+{
+	if (cnt != q.cnt) return false;
+	for (uint i = cnt; i--;)
+	{
+		if (ne(at(i), q.at(i))) return false;
+	}
+	return true;
+}
+
+template<typename T, uint B>
+uint ChunkedArray<T, B>::indexof(REForVALUE(T) item) const noexcept
+{
+	// find item in array
+	// returns ~0u if not found
+
+	for (uint ci = 0; ci < chunkCount(); ci++)
+	{
+		const T* p = chunks[ci];
+		for (uint i = 0, n = chunkItems(ci); i < n; i++)
+		{
+			if (eq(p[i], item)) return (ci << B) + i;
+		}
+	}
+	return ~0u;
+}
+
+template<typename T, uint B>
+void ChunkedArray<T, B>::growmax(uint newmax) throws
+{
+	// allocate chunks for at least newmax items
+	// never moves the items
+
+	if (newmax > maxCount)
+		throw std::length_error(
+			usingstr("ChunkedArray::growmax(): new count = %u exceeds maximum of %u", newmax, maxCount));
+
+	uint n = (newmax + MASK) >> B;
+	if (n <= chunks.count()) return;
+
+	chunks.growmax(n);
+	while (chunks.count() < n) chunks.append(new_chunk());
+}
+
+template<typename T, uint B>
+void ChunkedArray<T, B>::grow(uint newcnt, uint newmax) throws
+{
+	// grow array
+	// only grows, never shrinks
+	// new items are cleared with 0
+
+	if (newmax < newcnt) newmax = newcnt;
+	growmax(newmax);
+
+	if (newcnt > cnt)
+	{
+		memclr(cnt, newcnt);
+		cnt = newcnt;
+	}
+}
+
+template<typename T, uint B>
+void ChunkedArray<T, B>::shrink(uint newcnt) noexcept
+{
+	// shrink array
+	// does nothing if new count ≥ current count
+	// releases unused chunks except one spare chunk
+
+	if (newcnt >= cnt) return;
+
+	destroy(newcnt, cnt);
+	cnt = newcnt;
+	release_chunks(chunkCount() + 1);
+}
+
+template<typename T, uint B>
+void ChunkedArray<T, B>::append(const T* q, uint n) throws
+{
+	growmax(cnt + n);
+	for (uint i = 0; i < n; i++) { new (&at(cnt)) T(q[i]), cnt++; }
+}
+
+template<typename T, uint B>
+void ChunkedArray<T, B>::removeat(uint idx, bool fast) noexcept
+{
+	// remove item at index
+	// idx < cnt
+	// the following items are moved down, across chunk boundaries
+
+	assert(idx < cnt);
+
+	at(idx).~T();
+	if (--cnt == idx) return;
+
+	if (fast) { ::memcpy(ptr(&at(idx)), cptr(&at(cnt)), sizeof(T)); }
+	else
+	{
+		while (idx < cnt)
+		{
+			uint e = min(cnt, idx | MASK); // last target index in this chunk
+			::memmove(ptr(&at(idx)), cptr(&at(idx) + 1), (e - idx) * sizeof(T));
+			idx = e;
+			if (idx == cnt) break;
+			::memcpy(ptr(&at(idx)), cptr(&at(idx + 1)), sizeof(T)); // first item of the next chunk
+			idx++;
+		}
+	}
+}
+
+
+// ____ serialize() ____
+// same format as Array<T>
+
+template<typename T, uint B>
+typename std::enable_if<std::is_fundamental<T>::value, void>::type
+/*void*/
+serialize(FD& fd, const ChunkedArray<T, B>& array, void*) throws
+{
+	// used if type T is plain integer or float
+
+	fd.write_uint16(array.MAGIC); // saved in host byte order for byte order test
+	fd.write_uint32_z(array.count());
+	array.for_each_chunk([&fd](const T* p, uint n) { fd.write_data(p, n); });
+}
+
+template<typename T, uint B>
+typename std::enable_if<kio::has_serialize<T>::value && !kio::has_serialize_w_data<T, void*>::value, void>::type
+/*void*/
+serialize(FD& fd, const ChunkedArray<T, B>& array, void*) throws
+{
+	// used if type T has member function T::serialize(FD&)
+
+	fd.write_uint16_z(array.MAGIC);
+	fd.write_uint32_z(array.count());
+	for (uint i = 0; i < array.count(); i++) { array[i].serialize(fd); }
+}
+
+template<typename T, uint B>
+typename std::enable_if<kio::has_serialize_w_data<T, void*>::value, void>::type
+/*void*/
+serialize(FD& fd, const ChunkedArray<T, B>& array, void* data) throws
+{
+	// used if type T has member function T::serialize(FD&,void*)
+
+	fd.write_uint16_z(array.MAGIC);
+	fd.write_uint32_z(array.count());
+	for (uint i = 0; i < array.count(); i++) { array[i].serialize(fd, data); }
+}
+
+template<typename T, uint B>
+inline void ChunkedArray<T, B>::serialize(FD& fd, void* data) const throws
+{
+	::serialize(fd, *this, data);
+}
+
+// ____ deserialize() ____
+
+template<typename T, uint B>
+typename std::enable_if<std::is_fundamental<T>::value, void>::type
+/*void*/
+deserialize(FD& fd, ChunkedArray<T, B>& array, void*) throws
+{
+	// used if type T is plain integer or float
+
+	array.purge();
+
+	uint m = fd.read_uint16();
+	if (m != array.MAGIC && m != array.BYTESWAPPED_MAGIC) throw DataError("ChunkedArray<T>: wrong magic");
+
+	uint n = fd.read_uint32_z();
+	array.grow(n, n);
+	array.for_each_chunk([&fd, m, &array](T* p, uint k) {
+		fd.read_data(p, k);
+		if (sizeof(T) > 1 && m == array.BYTESWAPPED_MAGIC)
+		{
+			while (k--) { revert_bytes(p++, sizeof(T)); }
+		}
+	});
+}
+
+template<typename T, uint B>
+typename std::enable_if<kio::has_deserialize<T>::value && !kio::has_deserialize_w_data<T, void*>::value, void>::type
+/*void*/
+deserialize(FD& fd, ChunkedArray<T, B>& array, void*) throws
+{
+	// used if type T has member function T::deserialize(FD&)
+
+	array.purge();
+
+	uint m = fd.read_uint16_z();
+	if (m != array.MAGIC) throw DataError("ChunkedArray<T>: wrong magic");
+
+	uint n = fd.read_uint32_z();
+	array.grow(n, n);
+	for (uint i = 0; i < n; i++) { array[i].deserialize(fd); }
+}
+
+template<typename T, uint B>
+typename std::enable_if<kio::has_deserialize_w_data<T, void*>::value, void>::type
+/*void*/
+deserialize(FD& fd, ChunkedArray<T, B>& array, void* data) throws
+{
+	// used if type T has member function T::deserialize(FD&,void*)
+
+	array.purge();
+
+	uint m = fd.read_uint16_z();
+	if (m != array.MAGIC) throw DataError("ChunkedArray<T>: wrong magic");
+
+	uint n = fd.read_uint32_z();
+	array.grow(n, n);
+	for (uint i = 0; i < n; i++) { array[i].deserialize(fd, data); }
+}
+
+template<typename T, uint B>
+inline void ChunkedArray<T, B>::deserialize(FD& fd, void* data) throws
+{
+	::deserialize(fd, *this, data);
+}
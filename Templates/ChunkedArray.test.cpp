@@ -0,0 +1,253 @@
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+
+#include "Templates/ChunkedArray.h"
+#include "doctest/doctest/doctest.h"
+#include "unix/FD.h"
+
+
+static_assert(ChunkedArray<char>::CHUNKSIZE == 16384, "");
+static_assert(ChunkedArray<uint32>::CHUNKSIZE == 4096, "");
+struct BigItem
+{
+	char data[5000];
+};
+static_assert(ChunkedArray<BigItem>::CHUNKSIZE == 16, "");
+
+static int throwing_items	   = 0; // existing items
+static int throwing_copies_left = 0; // copy ctor throws when this is 0
+struct ThrowingItem
+{
+	ThrowingItem() noexcept { throwing_items++; }
+	ThrowingItem(const ThrowingItem&)
+	{
+		if (throwing_copies_left-- == 0) throw std::runtime_error("ThrowingItem");
+		throwing_items++;
+	}
+	~ThrowingItem() noexcept { throwing_items--; }
+};
+
+
+TEST_CASE("ChunkedArray")
+{
+	SUBCASE("") { logline("●●● %s:", __FILE__); }
+
+	SUBCASE("append, index, stable addresses")
+	{
+		ChunkedArray<uint, 4> a; // 16 items per chunk
+		CHECK(a.count() == 0);
+		CHECK(a.chunkCount() == 0);
+		CHECK(a.indexof(0) == ~0u);
+
+		Array<uint*> ptrs;
+		for (uint i = 0; i < 1000; i++) ptrs << &a.append(i * 3);
+		CHECK(a.count() == 1000);
+		CHECK(a.chunkCount() == 63);
+		CHECK(a.chunkItems(62) == 1000 - 62 * 16);
+		CHECK(a.first() == 0);
+		CHECK(a.last() == 999 * 3);
+
+		uint errors = 0;
+		for (uint i = 0; i < 1000; i++)
+		{
+			errors += a[i] != i * 3;
+			errors += &a[i] != ptrs[i]; // items never moved
+		}
+		CHECK(errors == 0);
+		CHECK(a.indexof(300) == 100);
+		CHECK(a.contains(2997));
+		CHECK(!a.contains(1));
+
+		uint sum = 0, n = 0;
+		a.for_each_chunk([&](uint* p, uint cnt) {
+			n += cnt;
+			for (uint i = 0; i < cnt; i++) sum += p[i];
+		});
+		CHECK(n == 1000);
+		CHECK(sum == 3 * 999 * 1000 / 2);
+
+		CHECK(a.pop() == 2997);
+		a.drop();
+		CHECK(a.count() == 998);
+		a << 7 << 8;
+		CHECK(a[998] == 7);
+		CHECK(a[999] == 8);
+	}
+
+	SUBCASE("grow, shrink, purge")
+	{
+		ChunkedArray<uint16, 4> a(20);
+		CHECK(a.count() == 20);
+		CHECK(a.capacity() == 32);
+		for (uint i = 0; i < 20; i++) a[i] = 0xffff;
+
+		a.shrink(5);
+		CHECK(a.count() == 5);
+		CHECK(a.capacity() == 32); // 1 spare chunk
+		a.grow(40);
+		uint errors = 0;
+		for (uint i = 5; i < 40; i++) errors += a[i] != 0; // new items are cleared
+		CHECK(errors == 0);
+
+		a.grow(0, 1000);
+		CHECK(a.count() == 40);
+		CHECK(a.capacity() >= 1000);
+		a.shrink(0);
+		CHECK(a.capacity() == 16);
+		a.purge();
+		CHECK(a.count() == 0);
+		CHECK(a.capacity() == 0);
+
+		a.resize(17);
+		CHECK(a.count() == 17);
+		a.resize(3);
+		CHECK(a.count() == 3);
+	}
+
+	SUBCASE("removeat")
+	{
+		// compare with Array:
+		ChunkedArray<uint, 4> a;
+		Array<uint>			  b;
+		for (uint i = 0; i < 200; i++)
+		{
+			a << i;
+			b << i;
+		}
+
+		uint errors = 0;
+		for (uint i = 0; i < 150; i++)
+		{
+			uint idx  = uint(random()) % a.count();
+			bool fast = random() & 1;
+			a.removeat(idx, fast);
+			b.removeat(idx, fast);
+			errors += a.count() != b.count();
+			for (uint j = 0; j < b.count(); j++) errors += a[j] != b[j];
+		}
+		CHECK(errors == 0);
+
+		a.swap(0, 49);
+		b.swap(0, 49);
+		CHECK(a[0] == b[0]);
+		CHECK(a[49] == b[49]);
+	}
+
+	SUBCASE("copy, move, compare")
+	{
+		ChunkedArray<cstr, 4> a;
+		for (uint i = 0; i < 50; i++) a << (i & 1 ? "foo" : "bar");
+		ChunkedArray<cstr, 4> b(a);
+		CHECK(a == b);
+		CHECK(b.count() == 50);
+		CHECK(b.indexof(usingstr("%s", "foo")) == 1); // compared by value
+		b[7] = "baz";
+		CHECK(a != b);
+
+		ChunkedArray<cstr, 4> c(std::move(b));
+		CHECK(b.count() == 0);
+		CHECK(c.count() == 50);
+		b = c;
+		CHECK(b == c);
+		c = std::move(a);
+		CHECK(c != b);
+		CHECK(eq(c[7], "foo"));
+	}
+
+	SUBCASE("copy ctor throws")
+	{
+		{
+			using Array = ChunkedArray<ThrowingItem, 4>;
+			Array a;
+			for (uint i = 0; i < 50; i++) a.grow();
+			CHECK(throwing_items == 50);
+			throwing_copies_left = 30;
+			CHECK_THROWS_AS(Array {a}, std::runtime_error);
+			CHECK(throwing_items == 50);
+		}
+		CHECK(throwing_items == 0);
+	}
+
+	SUBCASE("serialize")
+	{
+		ChunkedArray<uint32, 5> a;
+		for (uint i = 0; i < 100; i++) a << i * 0x01010101u;
+
+		FD fd;
+		fd.open_tempfile();
+		a.serialize(fd);
+		a.serialize(fd);
+
+		// same format as Array:
+		fd.rewind_file();
+		Array<uint32> b;
+		b.deserialize(fd);
+		CHECK(b.count() == 100);
+		CHECK(b[99] == a[99]);
+		ChunkedArray<uint32, 5> c(123);
+		c.deserialize(fd);
+		CHECK(c == a);
+	}
+}
+
+
+TEST_CASE("ChunkedArray performance test" * doctest::skip(false))
+{
+	// append N items and keep a pointer to the first item
+	// Array may move the items on every reallocation
+
+	static constexpr uint N = 20000000;
+
+	struct Item
+	{
+		uint32 a, b, c, d;
+	};
+
+	double		t0 = now();
+	Array<Item> a;
+	const Item* p1 = nullptr;
+	uint		moved = 0;
+	for (uint i = 0; i < N; i++)
+	{
+		a.append(Item {i, i, i, i});
+		moved += p1 != &a.first();
+		p1 = &a.first();
+	}
+	double t1 = now();
+
+	ChunkedArray<Item> b;
+	const Item*		   p2 = nullptr;
+	for (uint i = 0; i < N; i++)
+	{
+		b.append(Item {i, i, i, i});
+		if (i == 0) p2 = &b.first();
+	}
+	double t2 = now();
+	CHECK(p2 == &b.first());
+
+	// random access:
+	uint32 sum1 = 0, sum2 = 0;
+	uint   k	= 12345;
+	for (uint i = 0; i < N; i++) sum1 += a[(k = k * 1103515245u + 12345u) % N].a;
+	double t3 = now();
+	k		  = 12345;
+	for (uint i = 0; i < N; i++) sum2 += b[(k = k * 1103515245u + 12345u) % N].a;
+	double t4 = now();
+	CHECK(sum1 == sum2);
+
+	// sequential access:
+	for (uint i = 0; i < N; i++) sum1 += a[i].b;
+	double t5 = now();
+	b.for_each_chunk([&](const Item* p, uint n) {
+		for (uint i = 0; i < n; i++) sum2 += p[i].b;
+	});
+	double t6 = now();
+	CHECK(sum1 == sum2);
+
+	logline("Array<16 bytes>:        append %.1f ns (data moved %u times), random read %.1f ns, sequential %.2f ns",
+			(t1 - t0) * 1e9 / N, moved, (t3 - t2) * 1e9 / N, (t5 - t4) * 1e9 / N);
+	logline("ChunkedArray<16 bytes>: append %.1f ns, random read %.1f ns, sequential %.2f ns (per chunk)",
+			(t2 - t1) * 1e9 / N, (t4 - t3) * 1e9 / N, (t6 - t5) * 1e9 / N);
+}
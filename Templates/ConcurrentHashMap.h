@@ -0,0 +1,249 @@
+#pragma once
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+#include "Templates/HashMap.h"
+#include "cpp/cppthreads.h"
+#include "hash/hash.h"
+#include "kio/kio.h"
+#include "kio/util/msbit.h"
+
+
+/*	Template class ConcurrentHashMap stores Objects with Keys
+	and can be accessed by multiple threads concurrently.
+
+	The map is split into a fixed number of shards. Each shard is a HashMap with it's own PRWLock.
+	The shard for a key is selected by the high bits of kio::hash(key)
+	while the HashMap of the shard uses the low bits.
+	Any number of threads can read from a shard at the same time,
+	threads which modify a shard lock only this shard.
+	Therefore threads working on different shards never wait for each other.
+
+	Items are returned by value, because a reference into a shard would be invalid
+	as soon as the shard's lock is released.
+
+	snapshot() locks all shards at once and returns a consistent copy of all keys and items in a HashMap.
+	It can be used to iterate over the contents of the ConcurrentHashMap.
+
+	Same as for HashMap the keys are stored as flat copy and must remain valid throughout the lifetime of the map.
+
+
+	template arguments:
+
+		class KEY		must be a flat type. Keys are compared with same().
+		class ITEM		must be a flat type and copyable.
+*/
+
+
+template<class KEY, class ITEM>
+class ConcurrentHashMap
+{
+	NO_COPY_MOVE(ConcurrentHashMap);
+
+	struct alignas(64) Shard // one cache line per lock
+	{
+		mutable PRWLock	  lock;
+		HashMap<KEY, ITEM> map;
+
+		explicit Shard(uint max) : map(max) {}
+	};
+
+	using Shard_Locker = PLocker<PRWLock>;
+	using Read_Locker  = PSharedLocker<PRWLock>;
+
+	char*  memory; // allocated memory for shards[]
+	Shard* shards; // memory aligned to cache line size
+	uint   shift;  // 32 - log2(number of shards)
+
+	Shard& shard(KEY key) const noexcept
+	{
+		// the HashMap uses the low bits of the hash => use the high bits of a spread hash:
+		return shards[uint64(kio::hash(key) * 0x9E3779B1u) >> shift];
+	}
+
+public:
+	explicit ConcurrentHashMap(uint max = 1 << 10, uint num_shards = 32) throws;
+	~ConcurrentHashMap() noexcept;
+
+	uint numShards() const noexcept { return uint(1ull << (32 - shift)); }
+
+	// get items:
+	uint count() const noexcept; // not exact if other threads modify the map
+	bool contains(KEY key) const noexcept;
+	ITEM get(KEY key, ITEM dflt) const noexcept;
+	bool find(KEY key, ITEM& item) const noexcept; // returns false if key not found
+
+	// add / remove items:
+	void purge() noexcept;
+	void add(KEY, ITEM) throws;				// overwrites if key already exists
+	ITEM get_or_add(KEY, ITEM item) throws; // add if key not found; returns the item in the map
+	bool remove(KEY) noexcept;				// returns false if key did not exist
+
+	// consistent copy of all keys and items:
+	HashMap<KEY, ITEM> snapshot() const throws;
+};
+
+
+// -----------------------------------------------------------------------
+//				   	I M P L E M E N T A T I O N S
+// -----------------------------------------------------------------------
+
+
+template<class KEY, class ITEM>
+ConcurrentHashMap<KEY, ITEM>::ConcurrentHashMap(uint max, uint num_shards) throws
+{
+	// create ConcurrentHashMap for about max items in num_shards shards
+	// num_shards is rounded up to the next power of 2
+
+	assert(max > 0);
+	assert(num_shards > 0 && num_shards <= 1 << 16);
+
+	uint bits = num_shards <= 1 ? 0 : msbit(num_shards - 1) + 1;
+	uint n	  = 1u << bits;
+	shift	  = 32 - bits;
+
+	// c++14: new[] does not respect alignas > 16:
+	memory = new char[n * sizeof(Shard) + 63];
+	shards = reinterpret_cast<Shard*>((size_t(memory) + 63) & ~size_t(63));
+	uint i = 0;
+	try
+	{
+		for (; i < n; i++) { new (&shards[i]) Shard(max / n + 1); }
+	}
+	catch (...)
+	{
+		while (i--) { shards[i].~Shard(); }
+		delete[] memory;
+		throw;
+	}
+}
+
+template<class KEY, class ITEM>
+ConcurrentHashMap<KEY, ITEM>::~ConcurrentHashMap() noexcept
+{
+	for (uint i = numShards(); i--;) { shards[i].~Shard(); }
+	delete[] memory;
+}
+
+template<class KEY, class ITEM>
+uint ConcurrentHashMap<KEY, ITEM>::count() const noexcept
+{
+	uint cnt = 0;
+	for (uint i = 0; i < numShards(); i++)
+	{
+		Read_Locker _(shards[i].lock);
+		cnt += shards[i].map.count();
+	}
+	return cnt;
+}
+
+template<class KEY, class ITEM>
+bool ConcurrentHashMap<KEY, ITEM>::contains(KEY key) const noexcept
+{
+	Shard&		s = shard(key);
+	Read_Locker _(s.lock);
+	return s.map.contains(key);
+}
+
+template<class KEY, class ITEM>
+ITEM ConcurrentHashMap<KEY, ITEM>::get(KEY key, ITEM dflt) const noexcept
+{
+	Shard&		s = shard(key);
+	Read_Locker _(s.lock);
+	return s.map.get(key, std::move(dflt));
+}
+
+template<class KEY, class ITEM>
+bool ConcurrentHashMap<KEY, ITEM>::find(KEY key, ITEM& item) const noexcept
+{
+	Shard&		s = shard(key);
+	Read_Locker _(s.lock);
+	const ITEM* p = s.map.find(key);
+	if (p) item = *p;
+	return p != nullptr;
+}
+
+template<class KEY, class ITEM>
+void ConcurrentHashMap<KEY, ITEM>::purge() noexcept
+{
+	for (uint i = 0; i < numShards(); i++)
+	{
+		Shard_Locker _(shards[i].lock);
+		shards[i].map.purge();
+	}
+}
+
+template<class KEY, class ITEM>
+void ConcurrentHashMap<KEY, ITEM>::add(KEY key, ITEM item) throws
+{
+	Shard&		 s = shard(key);
+	Shard_Locker _(s.lock);
+	s.map.add(key, std::move(item));
+}
+
+template<class KEY, class ITEM>
+ITEM ConcurrentHashMap<KEY, ITEM>::get_or_add(KEY key, ITEM item) throws
+{
+	// add item for key if key does not yet exist
+	// returns the item stored in the map, which is the new item or the item found
+	// this is atomic: if multiple threads call get_or_add() for the same key
+	// then all of them get the same item
+
+	Shard& s = shard(key);
+	{
+		Read_Locker _(s.lock);
+		const ITEM* p = s.map.find(key);
+		if (p) return *p;
+	}
+
+	// not found => retry with write lock
+	// another thread may have added the key in the meantime:
+	Shard_Locker _(s.lock);
+	ITEM*		 p = s.map.find(key);
+	if (p) return *p;
+	s.map.add_new(key, item);
+	return item;
+}
+
+template<class KEY, class ITEM>
+bool ConcurrentHashMap<KEY, ITEM>::remove(KEY key) noexcept
+{
+	Shard&		 s = shard(key);
+	Shard_Locker _(s.lock);
+	uint		 cnt = s.map.count();
+	s.map.remove(key);
+	return s.map.count() != cnt;
+}
+
+template<class KEY, class ITEM>
+HashMap<KEY, ITEM> ConcurrentHashMap<KEY, ITEM>::snapshot() const throws
+{
+	// get a consistent copy of all keys and items
+	// all shards are locked for reading while the copy is made
+	// the locks are acquired in ascending order so that two snapshots can't deadlock
+
+	uint n = numShards();
+	for (uint i = 0; i < n; i++) { shards[i].lock.lock_shared(); }
+
+	try
+	{
+		uint cnt = 0;
+		for (uint i = 0; i < n; i++) { cnt += shards[i].map.count(); }
+
+		HashMap<KEY, ITEM> map(cnt ? cnt : 1);
+		for (uint i = 0; i < n; i++)
+		{
+			const HashMap<KEY, ITEM>& m = shards[i].map;
+			for (uint j = 0; j < m.count(); j++) { map.add_new(m.getKeys()[j], m.getItems()[j]); }
+		}
+
+		for (uint i = n; i--;) { shards[i].lock.unlock_shared(); }
+		return map;
+	}
+	catch (...)
+	{
+		for (uint i = n; i--;) { shards[i].lock.unlock_shared(); }
+		throw;
+	}
+}
@@ -0,0 +1,229 @@
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+
+#include "Templates/ConcurrentHashMap.h"
+#include "Templates/Array.h"
+#include "doctest/doctest/doctest.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+
+TEST_CASE("ConcurrentHashMap")
+{
+	SUBCASE("") { logline("●●● %s:", __FILE__); }
+
+	SUBCASE("")
+	{
+		ConcurrentHashMap<int, int> map(8, 4);
+		CHECK(map.numShards() == 4);
+		CHECK(map.count() == 0);
+		CHECK(!map.contains(0));
+		CHECK(map.get(0, -1) == -1);
+
+		ConcurrentHashMap<int, int> map1(8, 5);
+		CHECK(map1.numShards() == 8);
+		ConcurrentHashMap<int, int> map2(8, 1);
+		CHECK(map2.numShards() == 1);
+		map2.add(1, 11);
+		CHECK(map2.get(1, 0) == 11);
+	}
+
+	SUBCASE("")
+	{
+		ConcurrentHashMap<int, int> map;
+		for (int i = 0; i < 999; i++) map.add(i * 7, i * 77);
+		CHECK(map.count() == 999);
+		for (int i = 0; i < 999 * 7; i++) CHECK(map.get(i, -1) == (i % 7 ? -1 : i * 11));
+
+		int item = 0;
+		CHECK(map.find(14, item));
+		CHECK(item == 14 * 11);
+		CHECK(!map.find(15, item));
+		CHECK(item == 14 * 11);
+
+		map.add(14, 1);
+		CHECK(map.get(14, 0) == 1);
+		CHECK(map.count() == 999);
+
+		CHECK(map.get_or_add(14, 2) == 1);
+		CHECK(map.get_or_add(15, 2) == 2);
+		CHECK(map.get(15, 0) == 2);
+		CHECK(map.count() == 1000);
+
+		CHECK(map.remove(15));
+		CHECK(!map.remove(15));
+		CHECK(!map.contains(15));
+		CHECK(map.count() == 999);
+
+		HashMap<int, int> snapshot = map.snapshot();
+		CHECK(snapshot.count() == 999);
+		for (uint i = 0; i < snapshot.count(); i++)
+		{
+			CHECK(map.get(snapshot.getKeys()[i], -1) == snapshot.getItems()[i]);
+		}
+
+		map.purge();
+		CHECK(map.count() == 0);
+		CHECK(!map.contains(0));
+		CHECK(map.snapshot().count() == 0);
+	}
+
+	SUBCASE("cstr keys")
+	{
+		TempMemPool zz;
+
+		ConcurrentHashMap<cstr, uint> map(8);
+		for (uint i = 0; i < 1000; i++) map.add(usingstr("key_%u", i), i);
+		CHECK(map.count() == 1000);
+		for (uint i = 0; i < 1000; i++) CHECK(map.get(usingstr("key_%u", i), ~0u) == i);
+		for (uint i = 1000; i < 1100; i++) CHECK(!map.contains(usingstr("key_%u", i)));
+	}
+
+	SUBCASE("concurrent get_or_add")
+	{
+		// all threads try to add the same keys with their own id
+		// every thread must see the same item for every key
+
+		static constexpr uint N = 10000, T = 4;
+
+		ConcurrentHashMap<uint, uint> map(8);
+		Array<uint>					  seen[T];
+		std::vector<std::thread>	  threads;
+		for (uint t = 0; t < T; t++)
+		{
+			threads.emplace_back([&map, &seen, t] {
+				for (uint i = 0; i < N; i++) seen[t].append(map.get_or_add(i, t));
+			});
+		}
+		for (std::thread& thread : threads) thread.join();
+
+		CHECK(map.count() == N);
+		uint errors = 0;
+		for (uint t = 0; t < T; t++)
+		{
+			for (uint i = 0; i < N; i++) errors += seen[t][i] != map.get(i, ~0u);
+		}
+		CHECK(errors == 0);
+	}
+
+	SUBCASE("concurrent add, remove and snapshot")
+	{
+		// writers add and remove disjoint ranges of keys
+		// snapshots taken meanwhile must be consistent: every key has it's item
+
+		static constexpr uint N = 5000, T = 4;
+
+		ConcurrentHashMap<uint, uint> map;
+		std::atomic<uint>			  running {T};
+		std::vector<std::thread>	  threads;
+		for (uint t = 0; t < T; t++)
+		{
+			threads.emplace_back([&map, &running, t] {
+				for (uint n = 0; n < 3; n++)
+				{
+					for (uint i = t * N; i < t * N + N; i++) map.add(i, i * 3);
+					for (uint i = t * N; i < t * N + N; i += 2) map.remove(i);
+				}
+				running--;
+			});
+		}
+
+		uint snapshots = 0, errors = 0;
+		while (running || snapshots == 0)
+		{
+			HashMap<uint, uint> snapshot = map.snapshot();
+			for (uint i = 0; i < snapshot.count(); i++) errors += snapshot.getItems()[i] != snapshot.getKeys()[i] * 3;
+			snapshots++;
+		}
+		for (std::thread& thread : threads) thread.join();
+
+		CHECK(errors == 0);
+		CHECK(map.count() == T * N / 2);
+		for (uint i = 0; i < T * N; i++) CHECK(map.get(i, ~0u) == (i & 1 ? i * 3 : ~0u));
+	}
+}
+
+
+template<typename MAP>
+static double time_threads(MAP& map, uint num_threads, uint num_keys, uint ops_per_thread, uint writes_per_1000)
+{
+	// run num_threads threads doing ops_per_thread lookups and writes each on map
+	// returns million operations per second
+
+	std::atomic<uint>		 ready {0};
+	std::atomic<bool>		 go {false};
+	std::atomic<uint>		 found {0};
+	std::vector<std::thread> threads;
+
+	for (uint t = 0; t < num_threads; t++)
+	{
+		threads.emplace_back([&, t] {
+			uint32 r = t * 0x9E3779B1u + 1;
+			uint   f = 0;
+			ready++;
+			while (!go) { std::this_thread::yield(); }
+			for (uint i = 0; i < ops_per_thread; i++)
+			{
+				r		 = r * 1103515245u + 12345u;
+				uint key = (r >> 8) % num_keys;
+				if ((r >> 1) % 1000 < writes_per_1000) map.add(key, i);
+				else f += map.contains(key);
+			}
+			found += f;
+		});
+	}
+
+	while (ready < num_threads) { std::this_thread::yield(); }
+	double t0 = now();
+	go		  = true;
+	for (std::thread& thread : threads) thread.join();
+	double t1 = now();
+
+	return num_threads * ops_per_thread / (t1 - t0) / 1e6;
+}
+
+template<class KEY, class ITEM>
+class LockedHashMap // a HashMap with a single PLock for comparison
+{
+	mutable PLock	   lock;
+	HashMap<KEY, ITEM> map;
+
+public:
+	explicit LockedHashMap(uint max) : map(max) {}
+	bool contains(KEY key) const
+	{
+		PLocker<PLock> _(lock);
+		return map.contains(key);
+	}
+	void add(KEY key, ITEM item)
+	{
+		PLocker<PLock> _(lock);
+		map.add(key, item);
+	}
+};
+
+TEST_CASE("ConcurrentHashMap performance test" * doctest::skip(false))
+{
+	static constexpr uint N = 100000, OPS = 200000;
+
+	logline("hardware threads = %u", std::thread::hardware_concurrency());
+
+	for (uint writes : {0u, 50u})
+	{
+		ConcurrentHashMap<uint, uint> map1(N);
+		LockedHashMap<uint, uint>	  map2(N);
+		for (uint i = 0; i < N; i += 2) map1.add(i, i);
+		for (uint i = 0; i < N; i += 2) map2.add(i, i);
+
+		for (uint num_threads : {1u, 2u, 4u, 8u, 16u})
+		{
+			double mops1 = time_threads(map1, num_threads, N, OPS, writes);
+			double mops2 = time_threads(map2, num_threads, N, OPS, writes);
+			logline("%2u threads, %2u‰ writes: ConcurrentHashMap %6.2f Mops/s, HashMap+PLock %6.2f Mops/s", num_threads,
+					writes, mops1, mops2);
+		}
+	}
+}
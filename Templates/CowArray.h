@@ -0,0 +1,360 @@
+#pragma once
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+#include "Templates/Array.h"
+#include "Templates/ChunkedArray.h"
+#include "Templates/RCPtr.h"
+#include "kio/kio.h"
+
+
+/*	CowArray<T> is an array with copy-on-write chunks for cheap snapshots.
+
+	The items are stored in chunks of fixed size, same as in ChunkedArray.
+	The chunks are reference counted with RCPtr and shared between copies of the array:
+	copying a CowArray only copies the directory and increments the refcount of each chunk,
+	which is O(number of chunks), not O(number of items).
+	The first modification of an item in a shared chunk copies this chunk only.
+
+	Only the non-const accessors unshare a chunk: T& operator[], first(), last(), set(), append() etc.
+	Use get() or a const reference to read items without copying a chunk.
+	References to items remain valid until the chunk is unshared, the item removed or the CowArray destroyed.
+
+	The chunks are owned by the CowArray and its copies, which may be used in different threads.
+	But the same CowArray must not be accessed by multiple threads without locking, as with Array.
+
+	CowArray has the same core API as Array and the same assumptions about items:
+	new items are initialized with zero.
+
+	operator[] aborts on failed index check!
+*/
+
+
+template<typename T, uint CHUNKBITS = kio::chunked_array_bits(sizeof(T))>
+class CowArray
+{
+public:
+	static constexpr uint CHUNKSIZE = 1u << CHUNKBITS; // items per chunk
+	static constexpr uint maxCount	= 0x80000000u;
+
+protected:
+	static constexpr uint MASK = CHUNKSIZE - 1;
+
+	struct Chunk
+	{
+		RCDATA_NOWEAK
+		uint n = 0; // constructed items
+		alignas(T) char data[CHUNKSIZE * sizeof(T)];
+
+		T*		 items() noexcept { return reinterpret_cast<T*>(data); }
+		const T* items() const noexcept { return reinterpret_cast<const T*>(data); }
+		~Chunk() noexcept
+		{
+			if (!std::is_trivially_destructible<T>::value)
+				for (uint i = 0; i < n; i++) items()[i].~T();
+		}
+	};
+
+	Array<RCPtr<Chunk>> chunks; // chunks in use
+	uint				cnt = 0;
+
+	static RCPtr<Chunk> clone(const Chunk&, uint n) throws; // copy the first n items
+
+	const T& at(uint i) const noexcept { return chunks.getData()[i >> CHUNKBITS]->items()[i & MASK]; }
+	T&		 mut(uint i) throws { return unshare(i >> CHUNKBITS)->items()[i & MASK]; }
+	Chunk*	 unshare(uint ci) throws; // make chunk exclusively owned
+
+public:
+	static void swap(CowArray& a, CowArray& b) noexcept
+	{
+		Array<RCPtr<Chunk>>::swap(a.chunks, b.chunks);
+		std::swap(a.cnt, b.cnt);
+	}
+
+	CowArray() noexcept = default;
+	CowArray(CowArray&& q) noexcept : chunks(std::move(q.chunks)), cnt(q.cnt) { q.cnt = 0; }
+	CowArray(const CowArray& q) throws : chunks(q.chunks), cnt(q.cnt) {} // shares all chunks
+	CowArray& operator=(CowArray&& q) noexcept
+	{
+		swap(*this, q);
+		return *this;
+	}
+	CowArray& operator=(const CowArray& q) throws { return operator=(CowArray(q)); }
+	explicit CowArray(uint cnt) throws { grow(cnt); }
+	CowArray(const T* q, uint n) throws { append(q, n); }
+	explicit CowArray(const Array<T>& q) throws : CowArray(q.getData(), q.count()) {}
+	~CowArray() noexcept = default;
+
+	// access data members:
+	uint	 count() const noexcept { return cnt; }
+	uint	 chunkCount() const noexcept { return chunks.count(); }
+	uint	 chunkItems(uint ci) const noexcept { return chunks[ci]->n; }
+	const T* getChunk(uint ci) const noexcept { return chunks[ci]->items(); }
+	T*		 getChunk(uint ci) throws { return unshare(ci)->items(); }
+	bool	 isShared(uint ci) const noexcept { return chunks[ci]->refcnt() > 1; }
+	uint	 sharedChunks() const noexcept; // number of shared chunks
+
+	const T& get(uint i) const noexcept
+	{
+		assert(i < cnt);
+		return at(i);
+	}
+	void set(uint i, T item) throws
+	{
+		assert(i < cnt);
+		mut(i) = std::move(item);
+	}
+	const T& operator[](uint i) const noexcept
+	{
+		assert(i < cnt);
+		return at(i);
+	}
+	T& operator[](uint i) throws
+	{
+		assert(i < cnt);
+		return mut(i);
+	}
+	const T& operator[](int i) const noexcept
+	{
+		assert(uint(i) < cnt);
+		return at(uint(i));
+	}
+	T& operator[](int i) throws
+	{
+		assert(uint(i) < cnt);
+		return mut(uint(i));
+	}
+	const T& first() const noexcept
+	{
+		assert(cnt);
+		return at(0);
+	}
+	T& first() throws
+	{
+		assert(cnt);
+		return mut(0);
+	}
+	const T& last() const noexcept
+	{
+		assert(cnt);
+		return at(cnt - 1);
+	}
+	T& last() throws
+	{
+		assert(cnt);
+		return mut(cnt - 1);
+	}
+
+	// iterate per chunk: calls fn(const T* items, uint n) for all chunks
+	template<typename FN>
+	void for_each_chunk(FN fn) const noexcept(noexcept(fn(static_cast<const T*>(nullptr), 0u)));
+
+	bool operator==(const CowArray& q) const noexcept; // uses ne()
+	bool operator!=(const CowArray& q) const noexcept { return !operator==(q); }
+
+	uint indexof(REForVALUE(T) item) const noexcept; // compare using '==' except str/cstr: 'eq'
+	bool contains(REForVALUE(T) item) const noexcept { return indexof(item) != ~0u; } // uses indexof()
+
+	// resize:
+	void grow(uint newcnt) throws; // new items are cleared with 0
+	void shrink(uint newcnt) throws;
+	void resize(uint newcnt) throws
+	{
+		grow(newcnt);
+		shrink(newcnt);
+	}
+	void drop() throws { shrink(cnt - 1); }
+	T	 pop() throws
+	{
+		assert(cnt);
+		T item = std::move(mut(cnt - 1));
+		drop();
+		return item;
+	}
+	void purge() noexcept
+	{
+		chunks.purge();
+		cnt = 0;
+	}
+	T&		  append(T q) throws;
+	void	  append(const T* q, uint n) throws;
+	CowArray& operator<<(T q) throws
+	{
+		append(std::move(q));
+		return *this;
+	}
+
+	Array<T> copyToArray() const throws;
+};
+
+
+// -----------------------------------------------------------------------
+//					  I M P L E M E N T A T I O N S
+// -----------------------------------------------------------------------
+
+template<typename T, uint B>
+inline str tostr(const CowArray<T, B>& array)
+{
+	// return 1-line description of array for debugging and logging:
+	return usingstr("CowArray<T>[%u]", array.count());
+}
+
+template<typename T, uint B>
+RCPtr<typename CowArray<T, B>::Chunk> CowArray<T, B>::clone(const Chunk& q, uint n) throws
+{
+	// copy the first n items of a chunk into a new chunk
+	// the new chunk is held in a RCPtr so that it is released if a copy ctor throws
+
+	assert(n <= q.n);
+
+	RCPtr<Chunk> z = new Chunk;
+	if (std::is_trivially_copyable<T>::value)
+	{
+		::memcpy(ptr(z->items()), cptr(q.items()), n * sizeof(T));
+		z->n = n;
+	}
+	else
+		for (T* p = z->items(); z->n < n; z->n++) { new (p + z->n) T(q.items()[z->n]); }
+	return z;
+}
+
+template<typename T, uint B>
+typename CowArray<T, B>::Chunk* CowArray<T, B>::unshare(uint ci) throws
+{
+	// make chunk exclusively owned by this array before it is modified:
+	// if the chunk is shared with another array then it is copied.
+	// if the refcnt is 1 then no other array can increment it, because only this array has a reference.
+
+	RCPtr<Chunk>& c = chunks[ci];
+	if (c->refcnt() > 1) c = clone(*c, c->n);
+	return c.ptr();
+}
+
+template<typename T, uint B>
+uint CowArray<T, B>::sharedChunks() const noexcept
+{
+	uint n = 0;
+	for (uint ci = 0; ci < chunks.count(); ci++) n += isShared(ci);
+	return n;
+}
+
+template<typename T, uint B>
+template<typename FN>
+void CowArray<T, B>::for_each_chunk(FN fn) const noexcept(noexcept(fn(static_cast<const T*>(nullptr), 0u)))
+{
+	for (uint ci = 0; ci < chunks.count(); ci++) fn(getChunk(ci), chunkItems(ci));
+}
+
+template<typename T, uint B>
+bool CowArray<T, B>::operator==(const CowArray& q) const noexcept
+{
+	// shared chunks are equal and need not be compared
+
+	if (cnt != q.cnt) return false;
+	for (uint ci = 0; ci < chunks.count(); ci++)
+	{
+		const Chunk* a = chunks[ci].ptr();
+		const Chunk* b = q.chunks[ci].ptr();
+		if (a == b) continue;
+		for (uint i = 0; i < a->n; i++)
+		{
+			if (ne(a->items()[i], b->items()[i])) return false;
+		}
+	}
+	return true;
+}
+
+template<typename T, uint B>
+uint CowArray<T, B>::indexof(REForVALUE(T) item) const noexcept
+{
+	// find item in array
+	// returns ~0u if not found
+
+	for (uint ci = 0; ci < chunks.count(); ci++)
+	{
+		const Chunk* c = chunks[ci].ptr();
+		for (uint i = 0; i < c->n; i++)
+		{
+			if (eq(c->items()[i], item)) return (ci << B) + i;
+		}
+	}
+	return ~0u;
+}
+
+template<typename T, uint B>
+void CowArray<T, B>::grow(uint newcnt) throws
+{
+	// grow array
+	// only grows, never shrinks
+	// new items are cleared with 0
+
+	if (newcnt > maxCount)
+		throw std::length_error(
+			usingstr("CowArray::grow(): new count = %u exceeds maximum of %u", newcnt, maxCount));
+	if (newcnt <= cnt) return;
+
+	chunks.growmax((newcnt + MASK) >> B);
+	while (cnt < newcnt)
+	{
+		Chunk* c = cnt & MASK ? unshare(cnt >> B) : chunks.append(new Chunk).ptr();
+		uint   n = min(newcnt - cnt, CHUNKSIZE - c->n);
+		::memset(ptr(c->items() + c->n), 0, n * sizeof(T));
+		c->n += n;
+		cnt += n;
+	}
+}
+
+template<typename T, uint B>
+void CowArray<T, B>::shrink(uint newcnt) throws
+{
+	// shrink array
+	// does nothing if new count ≥ current count
+	// chunks which become unused are released, which does not copy shared chunks
+	// may throw if the last used chunk is shared and must be copied
+
+	if (newcnt >= cnt) return;
+
+	chunks.shrink((newcnt + MASK) >> B);
+	cnt = newcnt;
+
+	if (cnt & MASK)
+	{
+		Chunk* c = chunks.last().ptr();
+		uint   n = cnt & MASK;
+		if (c->refcnt() > 1) { chunks.last() = clone(*c, n); } // copy only the remaining items
+		else
+		{
+			if (!std::is_trivially_destructible<T>::value)
+				for (uint i = n; i < c->n; i++) c->items()[i].~T();
+			c->n = n;
+		}
+	}
+}
+
+template<typename T, uint B>
+T& CowArray<T, B>::append(T q) throws
+{
+	if (cnt == maxCount) throw std::length_error("CowArray::append(): maximum count exceeded");
+
+	Chunk* c = cnt & MASK ? unshare(cnt >> B) : chunks.append(new Chunk).ptr();
+	T*	   p = new (c->items() + c->n) T(std::move(q));
+	c->n++;
+	cnt++;
+	return *p;
+}
+
+template<typename T, uint B>
+void CowArray<T, B>::append(const T* q, uint n) throws
+{
+	chunks.growmax((cnt + n + MASK) >> B);
+	for (uint i = 0; i < n; i++) append(q[i]);
+}
+
+template<typename T, uint B>
+Array<T> CowArray<T, B>::copyToArray() const throws
+{
+	Array<T> z(0u, cnt);
+	for_each_chunk([&z](const T* p, uint n) { z.append(p, n); });
+	return z;
+}
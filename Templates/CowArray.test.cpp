@@ -0,0 +1,185 @@
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+
+#include "Templates/CowArray.h"
+#include "doctest/doctest/doctest.h"
+
+
+static_assert(CowArray<uint32>::CHUNKSIZE == 4096, "");
+
+static int num_items = 0;
+
+struct Item
+{
+	int value;
+	Item(int v = 0) noexcept : value(v) { num_items++; }
+	Item(const Item& q) noexcept : value(q.value) { num_items++; }
+	~Item() noexcept { num_items--; }
+	Item& operator=(const Item&) noexcept = default;
+};
+static inline bool ne(const Item& a, const Item& b) noexcept { return a.value != b.value; }
+
+
+TEST_CASE("CowArray")
+{
+	SUBCASE("") { logline("●●● %s:", __FILE__); }
+
+	SUBCASE("append, index")
+	{
+		CowArray<uint, 4> a; // 16 items per chunk
+		CHECK(a.count() == 0);
+		CHECK(a.chunkCount() == 0);
+		CHECK(a.indexof(0) == ~0u);
+
+		for (uint i = 0; i < 1000; i++) a.append(i * 3);
+		CHECK(a.count() == 1000);
+		CHECK(a.chunkCount() == 63);
+		CHECK(a.chunkItems(62) == 1000 - 62 * 16);
+		CHECK(a.first() == 0);
+		CHECK(a.last() == 999 * 3);
+
+		uint errors = 0;
+		for (uint i = 0; i < 1000; i++) errors += a.get(i) != i * 3;
+		CHECK(errors == 0);
+		CHECK(a.indexof(300) == 100);
+		CHECK(a.contains(2997));
+		CHECK(!a.contains(1));
+
+		CHECK(a.pop() == 2997);
+		a.drop();
+		CHECK(a.count() == 998);
+		a << 7 << 8;
+		CHECK(a[998] == 7);
+		CHECK(a[999] == 8);
+		a.set(5, 55);
+		CHECK(a.get(5) == 55);
+	}
+
+	SUBCASE("grow, shrink")
+	{
+		CowArray<uint16, 4> a(20);
+		CHECK(a.count() == 20);
+		CHECK(a.chunkCount() == 2);
+		for (uint i = 0; i < 20; i++) a[i] = 0xffff;
+
+		a.shrink(5);
+		CHECK(a.count() == 5);
+		CHECK(a.chunkCount() == 1);
+		a.grow(40);
+		uint errors = 0;
+		for (uint i = 5; i < 40; i++) errors += a[i] != 0; // new items are cleared
+		CHECK(errors == 0);
+		a.resize(17);
+		CHECK(a.count() == 17);
+		a.purge();
+		CHECK(a.count() == 0);
+		CHECK(a.chunkCount() == 0);
+	}
+
+	SUBCASE("copy on write")
+	{
+		CowArray<uint, 4> a;
+		for (uint i = 0; i < 100; i++) a << i;
+		CHECK(a.sharedChunks() == 0);
+
+		CowArray<uint, 4> b(a);
+		CHECK(a.sharedChunks() == 7);
+		CHECK(b.sharedChunks() == 7);
+		const CowArray<uint, 4>& ca = a;
+		const CowArray<uint, 4>& cb = b;
+		CHECK(ca.getChunk(0) == cb.getChunk(0));
+		CHECK(a == b);
+
+		b[20] = 0;
+		CHECK(a[20] == 20);
+		CHECK(b[20] == 0);
+		CHECK(!a.isShared(1));
+		CHECK(!b.isShared(1));
+		CHECK(a.sharedChunks() == 6);
+		CHECK(a != b);
+
+		// reading does not unshare:
+		uint sum = 0;
+		for (uint i = 0; i < 100; i++) sum += ca[i] + a.get(i);
+		CHECK(sum == 2 * 99 * 100 / 2);
+		CHECK(a.sharedChunks() == 6);
+
+		// append to a shared chunk:
+		a << 100;
+		CHECK(a.count() == 101);
+		CHECK(b.count() == 100);
+		CHECK(a.sharedChunks() == 5);
+		CHECK(b.last() == 99);
+
+		// shrink a shared chunk:
+		CowArray<uint, 4> d(b);
+		d.shrink(40);
+		CHECK(d.count() == 40);
+		CHECK(d.sharedChunks() == 2); // chunk 1 was unshared in b
+		CHECK(b.count() == 100);
+		CHECK(b[45] == 45);
+
+		b = a;
+		CHECK(b == a);
+		CHECK(b.copyToArray() == a.copyToArray());
+		CHECK(b.copyToArray().count() == 101);
+	}
+
+	SUBCASE("items with ctor and dtor")
+	{
+		{
+			CowArray<Item, 4> a;
+			for (int i = 0; i < 50; i++) a << Item(i);
+			CHECK(num_items == 50);
+
+			CowArray<Item, 4> b(a);
+			CHECK(num_items == 50);
+			b[17].value = 0;
+			CHECK(num_items == 66);
+			CHECK(a[17].value == 17);
+
+			b.shrink(35);
+			CHECK(num_items == 66 + 3); // chunk 2 copied with 3 items, chunk 3 still used by a
+			a.purge();
+			CHECK(num_items == 35);
+		}
+		CHECK(num_items == 0);
+	}
+}
+
+
+TEST_CASE("CowArray performance test" * doctest::skip(false))
+{
+	// take snapshots of an array with 10M items and modify 100 items between snapshots
+	// Array must copy all items for each snapshot
+
+	static constexpr uint N = 10000000, M = 1000, W = 100;
+
+	uint k	 = 12345;
+	auto rnd = [&k] { return (k = k * 1103515245u + 12345u) >> 4; };
+
+	Array<uint32> a(N);
+	Array<uint32> a_snapshot;
+	double		  t0 = now();
+	for (uint m = 0; m < 20; m++)
+	{
+		for (uint i = 0; i < W; i++) a[rnd() % N] = m;
+		a_snapshot = a;
+	}
+	double t1 = now();
+
+	CowArray<uint32> b(N);
+	CowArray<uint32> b_snapshots[10];
+	for (uint m = 0; m < M; m++)
+	{
+		for (uint i = 0; i < W; i++) b[rnd() % N] = m;
+		b_snapshots[m % 10] = b;
+	}
+	double t2 = now();
+	CHECK(b_snapshots[9] == b);
+
+	logline("snapshot of 10M uint32 + %u writes: Array %.1f µs, CowArray %.1f µs (%u chunks)", W,
+			(t1 - t0) * 1e6 / 20, (t2 - t1) * 1e6 / M, b.chunkCount());
+}
@@ -0,0 +1,283 @@
+#pragma once
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+#include "Templates/Array.h"
+#include "hash/hash.h"
+#include "kio/kio.h"
+#include "kio/util/msbit.h"
+#include "unix/FD.h"
+
+
+/*	CuckooFilter<KEY,FP> tests whether a key may be in a set, same as BloomFilter, but keys can be removed.
+
+	The filter stores a fingerprint of type FP for each key in one of 2 buckets of 4 slots.
+	The fingerprint and the first bucket i1 are taken from the hash of the key.
+	The second bucket is i2 = i1 ^ hash(fingerprint), so i1 = i2 ^ hash(fingerprint) as well
+	and a fingerprint can be moved to its other bucket without knowing the key.
+	If both buckets are full then a random fingerprint is kicked out and moved to its other bucket, and so on.
+	If this fails after MAX_KICKS moves then the last homeless fingerprint is stored in 'victim'
+	and the filter is full: add() returns false until a key is removed.
+	The filter is sized for the max. number of keys in the ctor at a load of ≤ 95%.
+
+	The false positive rate depends on the size of the fingerprint: ~ 8 / 2^bits
+	  FP = uint8:  ~3 %
+	  FP = uint16: ~0.012 %
+	  FP = uint32: ~2e-9
+
+	remove() must only be called for keys which were added: else it may remove the fingerprint of another key.
+	A key may be added multiple times and must then be removed the same number of times.
+
+	Keys are hashed with kio::hash(). Keys which have the same hash are the same for the filter.
+*/
+
+
+template<typename KEY, typename FP = uint16>
+class CuckooFilter
+{
+	static_assert(std::is_unsigned<FP>::value, "FP must be an unsigned integer");
+	static_assert(sizeof(FP) <= 4, "FP must not be larger than 32 bits"); // fingerprint() and serialize()
+
+	static constexpr uint	SLOTS	  = 4; // per bucket
+	static constexpr uint	MAX_KICKS = 500;
+	static constexpr uint16 MAGIC	  = 0xC0CF;
+
+	Array<FP> table;		 // nbuckets * SLOTS, 0 = empty
+	uint	  mask = 0;		 // nbuckets - 1
+	uint	  cnt  = 0;		 // stored fingerprints incl. victim
+	FP		  victim	= 0; // homeless fingerprint or 0
+	uint	  victim_i	= 0; // and one of its buckets
+	uint	  rng_state = 1; // for the kicks
+
+	static uint64 hash64(KEY key) noexcept { return kio::fmix64(kio::hash(key)); }
+	static FP	  fingerprint(uint64 h) noexcept
+	{
+		FP fp = FP(h >> 32);
+		return fp ? fp : 1; // 0 = empty slot
+	}
+	uint bucket(uint64 h) const noexcept { return uint(h) & mask; }
+	uint other_bucket(uint i, FP fp) const noexcept { return (i ^ uint(kio::fmix64(fp))) & mask; }
+
+	FP*	 slots(uint i) noexcept { return table.getData() + i * SLOTS; }
+	void add_fp(uint i, FP fp) noexcept;		  // into bucket i or its other bucket
+	bool insert(uint i, FP fp) noexcept;		  // into a free slot
+	bool remove(uint i, FP fp) noexcept;		  // from bucket i
+	bool contains(uint i, FP fp) const noexcept; // in bucket i
+
+public:
+	CuckooFilter() noexcept = default;
+	explicit CuckooFilter(uint max) throws;
+
+	// access data members:
+	uint count() const noexcept { return cnt; }
+	uint capacity() const noexcept { return table.count(); } // slots
+	bool isFull() const noexcept { return victim != 0; }
+
+	// add and remove keys:
+	bool add(KEY key) noexcept;						// false if the filter is full
+	uint add_all(const Array<KEY>& keys) noexcept; // returns number of keys added
+	bool remove(KEY key) noexcept;					// false if not found
+	void purge() noexcept;							// remove all keys
+
+	// test keys:
+	bool contains(KEY key) const noexcept;
+
+	// read / write file:
+	void serialize(FD&, void* data = nullptr) const throws;
+	void deserialize(FD&, void* data = nullptr) throws;
+};
+
+
+// -----------------------------------------------------------------------
+//					  I M P L E M E N T A T I O N S
+// -----------------------------------------------------------------------
+
+template<typename KEY, typename FP>
+inline str tostr(const CuckooFilter<KEY, FP>& filter)
+{
+	// return 1-line description of filter for debugging and logging:
+	return usingstr("CuckooFilter[%u]", filter.count());
+}
+
+template<typename KEY, typename FP>
+CuckooFilter<KEY, FP>::CuckooFilter(uint max) throws
+{
+	// nbuckets must be a power of 2 for other_bucket()
+
+	uint n		  = max / SLOTS + max / SLOTS / 19 + 1; // load ≤ 95%
+	uint nbuckets = n <= 2 ? 2 : 2u << msbit(n - 1);
+	mask		  = nbuckets - 1;
+	table.grow(nbuckets * SLOTS);
+}
+
+template<typename KEY, typename FP>
+bool CuckooFilter<KEY, FP>::insert(uint i, FP fp) noexcept
+{
+	FP* p = slots(i);
+	for (uint j = 0; j < SLOTS; j++)
+	{
+		if (p[j] == 0)
+		{
+			p[j] = fp;
+			return true;
+		}
+	}
+	return false;
+}
+
+template<typename KEY, typename FP>
+bool CuckooFilter<KEY, FP>::remove(uint i, FP fp) noexcept
+{
+	FP* p = slots(i);
+	for (uint j = 0; j < SLOTS; j++)
+	{
+		if (p[j] == fp)
+		{
+			p[j] = 0;
+			return true;
+		}
+	}
+	return false;
+}
+
+template<typename KEY, typename FP>
+bool CuckooFilter<KEY, FP>::contains(uint i, FP fp) const noexcept
+{
+	const FP* p = table.getData() + i * SLOTS;
+	for (uint j = 0; j < SLOTS; j++)
+	{
+		if (p[j] == fp) return true;
+	}
+	return false;
+}
+
+template<typename KEY, typename FP>
+void CuckooFilter<KEY, FP>::add_fp(uint i, FP fp) noexcept
+{
+	// store fingerprint in bucket i or in its other bucket
+	// if both buckets are full then kick out other fingerprints
+
+	if (insert(i, fp)) return;
+	i = other_bucket(i, fp);
+	if (insert(i, fp)) return;
+
+	for (uint n = 0; n < MAX_KICKS; n++)
+	{
+		rng_state = rng_state * 1103515245u + 12345u;
+		std::swap(fp, slots(i)[(rng_state >> 16) % SLOTS]);
+		i = other_bucket(i, fp);
+		if (insert(i, fp)) return;
+	}
+
+	// the filter is full: keep the homeless fingerprint
+	victim	 = fp;
+	victim_i = i;
+}
+
+template<typename KEY, typename FP>
+bool CuckooFilter<KEY, FP>::add(KEY key) noexcept
+{
+	// add key
+	// returns false if the filter is full and the key was not added
+
+	assert(mask);
+	if (victim) return false;
+
+	uint64 h = hash64(key);
+	add_fp(bucket(h), fingerprint(h));
+	cnt++;
+	return true;
+}
+
+template<typename KEY, typename FP>
+uint CuckooFilter<KEY, FP>::add_all(const Array<KEY>& keys) noexcept
+{
+	uint n = 0;
+	while (n < keys.count() && add(keys[n])) { n++; }
+	return n;
+}
+
+template<typename KEY, typename FP>
+bool CuckooFilter<KEY, FP>::remove(KEY key) noexcept
+{
+	// remove key
+	// the key must have been added, else the fingerprint of another key may be removed
+	// returns false if the fingerprint was not found
+
+	if (cnt == 0) return false;
+
+	uint64 h  = hash64(key);
+	FP	   fp = fingerprint(h);
+	uint   i1 = bucket(h);
+	uint   i2 = other_bucket(i1, fp);
+
+	if (victim == fp && (victim_i == i1 || victim_i == i2)) victim = 0;
+	else if (!remove(i1, fp) && !remove(i2, fp)) return false;
+	cnt--;
+
+	if (victim)
+	{
+		// there is a free slot now: store the victim again
+		fp	   = victim;
+		victim = 0;
+		add_fp(victim_i, fp);
+	}
+	return true;
+}
+
+template<typename KEY, typename FP>
+void CuckooFilter<KEY, FP>::purge() noexcept
+{
+	memset(table.getData(), 0, table.count() * sizeof(FP));
+	cnt	   = 0;
+	victim = 0;
+}
+
+template<typename KEY, typename FP>
+bool CuckooFilter<KEY, FP>::contains(KEY key) const noexcept
+{
+	if (cnt == 0) return false;
+
+	uint64 h  = hash64(key);
+	FP	   fp = fingerprint(h);
+	uint   i1 = bucket(h);
+	uint   i2 = other_bucket(i1, fp);
+
+	return contains(i1, fp) || contains(i2, fp) || (victim == fp && (victim_i == i1 || victim_i == i2));
+}
+
+template<typename KEY, typename FP>
+void CuckooFilter<KEY, FP>::serialize(FD& fd, void* data) const throws
+{
+	fd.write_uint16_z(MAGIC);
+	fd.write_uint8(sizeof(FP));
+	fd.write_uint32_z(cnt);
+	fd.write_uint32_z(victim);
+	fd.write_uint32_z(victim_i);
+	table.serialize(fd, data);
+}
+
+template<typename KEY, typename FP>
+void CuckooFilter<KEY, FP>::deserialize(FD& fd, void* data) throws
+{
+	// deserialize: supports reading back on byte swapped host.
+
+	if (fd.read_uint16_z() != MAGIC) throw DataError("CuckooFilter: wrong magic");
+	if (fd.read_uint8() != sizeof(FP)) throw DataError("CuckooFilter: wrong fingerprint size");
+	uint	  c	 = fd.read_uint32_z();
+	FP		  v	 = FP(fd.read_uint32_z());
+	uint	  vi = fd.read_uint32_z();
+	Array<FP> t;
+	t.deserialize(fd, data);
+
+	uint nbuckets = t.count() / SLOTS;
+	if (nbuckets < 2 || nbuckets & (nbuckets - 1) || t.count() % SLOTS || vi >= nbuckets)
+		throw DataError("CuckooFilter: size mismatch");
+
+	table	 = std::move(t);
+	mask	 = nbuckets - 1;
+	cnt		 = c;
+	victim	 = v;
+	victim_i = vi;
+}
@@ -0,0 +1,147 @@
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+
+#include "Templates/CuckooFilter.h"
+#include "doctest/doctest/doctest.h"
+#include "unix/FD.h"
+
+
+TEST_CASE("CuckooFilter")
+{
+	SUBCASE("") { logline("●●● %s:", __FILE__); }
+
+	SUBCASE("empty filter")
+	{
+		CuckooFilter<uint> f;
+		CHECK(f.count() == 0);
+		CHECK(!f.contains(42));
+		CHECK(!f.remove(42));
+
+		CuckooFilter<uint> g(1000);
+		CHECK(g.capacity() >= 1000);
+		CHECK(g.capacity() == 2048); // load ≤ 95%
+		CHECK(!g.contains(42));
+	}
+
+	SUBCASE("add, contains, remove")
+	{
+		static constexpr uint N = 100000;
+
+		CuckooFilter<uint> f(N);
+		uint			   errors = 0;
+		for (uint i = 0; i < N; i++) errors += !f.add(i * 7);
+		CHECK(errors == 0);
+		CHECK(f.count() == N);
+		CHECK(!f.isFull());
+
+		for (uint i = 0; i < N; i++) errors += !f.contains(i * 7);
+		CHECK(errors == 0);
+
+		uint fp = 0;
+		for (uint i = 0; i < N; i++) fp += f.contains(i * 7 + 3);
+		CHECK(fp < N / 1000); // ~0.012%
+
+		// remove every 2nd key:
+		for (uint i = 0; i < N; i += 2) errors += !f.remove(i * 7);
+		CHECK(errors == 0);
+		CHECK(f.count() == N / 2);
+		for (uint i = 1; i < N; i += 2) errors += !f.contains(i * 7);
+		CHECK(errors == 0);
+
+		uint found = 0;
+		for (uint i = 0; i < N; i += 2) found += f.contains(i * 7);
+		CHECK(found < N / 1000);
+
+		f.purge();
+		CHECK(f.count() == 0);
+		CHECK(!f.contains(7));
+	}
+
+	SUBCASE("full filter")
+	{
+		CuckooFilter<uint, uint8> f(100);
+		uint					  n = 0;
+		while (f.add(n * 13)) n++;
+		CHECK(f.isFull());
+		CHECK(n >= 100);
+		CHECK(n <= f.capacity() + 1);
+		CHECK(f.count() == n); // incl. victim
+
+		uint errors = 0;
+		for (uint i = 0; i < n; i++) errors += !f.contains(i * 13);
+		CHECK(errors == 0);
+
+		// after remove() there is room again:
+		CHECK(f.remove(0));
+		CHECK(!f.isFull());
+		CHECK(f.count() == n - 1);
+		for (uint i = 1; i < n; i++) errors += !f.contains(i * 13);
+		CHECK(errors == 0);
+		CHECK(f.add(0));
+	}
+
+	SUBCASE("add_all, duplicates")
+	{
+		Array<cstr> keys;
+		for (uint i = 0; i < 1000; i++) keys << usingstr("key%u", i);
+
+		CuckooFilter<cstr> f(2000);
+		CHECK(f.add_all(keys) == 1000);
+		CHECK(f.add("key7"));
+		CHECK(f.count() == 1001);
+		CHECK(f.remove("key7"));
+		CHECK(f.contains("key7"));
+		CHECK(f.remove("key7"));
+		CHECK(!f.contains("key7"));
+	}
+
+	SUBCASE("serialize")
+	{
+		CuckooFilter<uint64, uint32> f(5000);
+		for (uint i = 0; i < 5000; i++) f.add(i * 1000003ull);
+
+		FD fd;
+		fd.open_tempfile();
+		f.serialize(fd);
+		fd.write_uint32_z(0x12345678); // garbage
+		fd.rewind_file();
+
+		CuckooFilter<uint64, uint32> g;
+		g.deserialize(fd);
+		CHECK(g.count() == 5000);
+		CHECK(g.capacity() == f.capacity());
+		uint errors = 0;
+		for (uint i = 0; i < 5000; i++) errors += !g.contains(i * 1000003ull);
+		CHECK(errors == 0);
+		CHECK(g.remove(0));
+		CHECK(g.count() == 4999);
+
+		CHECK_THROWS_AS(g.deserialize(fd), DataError);
+
+		fd.rewind_file();
+		CuckooFilter<uint64, uint16> h;
+		CHECK_THROWS_AS(h.deserialize(fd), DataError); // wrong fingerprint size
+	}
+}
+
+
+TEST_CASE("CuckooFilter performance test" * doctest::skip(false))
+{
+	static constexpr uint N = 4000000;
+
+	CuckooFilter<uint> f(N);
+	double			   t0 = now();
+	for (uint i = 0; i < N; i++) f.add(i * 2654435761u);
+	double t1 = now();
+	uint   n  = 0;
+	for (uint i = 0; i < N; i++) n += f.contains(i * 2654435761u + 1);
+	double t2 = now();
+	for (uint i = 0; i < N; i++) f.remove(i * 2654435761u);
+	double t3 = now();
+	CHECK(f.count() == 0);
+
+	logline("CuckooFilter<uint16>: %u keys, add %.1f ns, miss %.1f ns, remove %.1f ns, fp rate %.4f %%", N,
+			(t1 - t0) * 1e9 / N, (t2 - t1) * 1e9 / N, (t3 - t2) * 1e9 / N, n * 100.0 / N);
+}
@@ -0,0 +1,189 @@
+#pragma once
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+#include "Templates/BloomFilter.h"
+#include "Templates/HashMap.h"
+
+
+/*	FilteredHashMap<KEY,ITEM> is a HashMap with a BloomFilter in front of the lookups.
+
+	Lookups for keys which are not in the map are rejected by the filter with one cache miss
+	while the HashMap needs one for map[] and then one for hashes[] for every probed index.
+	This is useful if most lookups are misses, e.g. a map of exceptions or a negative cache.
+	Lookups for keys which are in the map cost one cache miss more.
+
+	The filter can't remove keys: removed keys become false positives until the filter is rebuilt.
+	The filter is rebuilt when more keys were added than it was sized for or when it contains
+	more removed keys than keys in the map.
+
+	The API is the same as for HashMap, except that items can't be modified with getItems().
+*/
+
+
+template<class KEY, class ITEM>
+class FilteredHashMap
+{
+	HashMap<KEY, ITEM> map;
+	BloomFilter<KEY>   filter;
+	uint			   filter_max;	 // number of keys the filter was sized for
+	uint			   removed = 0;	 // removed keys which are still in the filter
+	double			   fp_rate;
+
+	void rebuild_filter(uint max) throws;
+	void make_room(KEY) throws; // before adding key to the map
+
+public:
+	explicit FilteredHashMap(uint max = 1 << 10, double fp_rate = 0.01) throws;
+	FilteredHashMap(const FilteredHashMap&) throws = default;
+	FilteredHashMap(FilteredHashMap&&) noexcept	   = default;
+	FilteredHashMap& operator=(const FilteredHashMap&) throws = default;
+	FilteredHashMap& operator=(FilteredHashMap&&) noexcept	  = default;
+
+	// get internal data:
+	const HashMap<KEY, ITEM>& getMap() const noexcept { return map; }
+	const BloomFilter<KEY>&	  getFilter() const noexcept { return filter; }
+	const Array<KEY>&		  getKeys() const noexcept { return map.getKeys(); }
+	const Array<ITEM>&		  getItems() const noexcept { return map.getItems(); }
+
+	// get items:
+	uint  count() const noexcept { return map.count(); }
+	bool  contains(KEY key) const noexcept { return filter.contains(key) && map.contains(key); }
+	ITEM  get(KEY key, ITEM dflt) const noexcept { return filter.contains(key) ? map.get(key, dflt) : dflt; }
+	ITEM& get(KEY key) noexcept { return map.get(key); }
+	ITEM const& get(KEY key) const noexcept { return map.get(key); }
+	ITEM&		operator[](KEY key) noexcept { return map[key]; }
+	ITEM const& operator[](KEY key) const noexcept { return map[key]; }
+	ITEM*		find(KEY key) noexcept { return filter.contains(key) ? map.find(key) : nullptr; }
+	ITEM const* find(KEY key) const noexcept { return filter.contains(key) ? map.find(key) : nullptr; }
+
+	// add / remove items:
+	void			 purge() noexcept;
+	FilteredHashMap& add(KEY, ITEM) throws;		// overwrites if key already exists
+	FilteredHashMap& add_new(KEY, ITEM) throws; // key must be new
+	void			 remove(KEY) noexcept;		// silently does nothing if key does not exist
+
+	// misc:
+	bool operator==(const FilteredHashMap& q) const noexcept { return map == q.map; }
+	bool operator!=(const FilteredHashMap& q) const noexcept { return map != q.map; }
+
+	// read / write file:
+	void print(FD& fd, cstr indent) const throws { map.print(fd, indent); }
+	void serialize(FD& fd, void* data = nullptr) const throws { map.serialize(fd, data); }
+	void deserialize(FD&, void* data = nullptr) throws;
+};
+
+
+// -----------------------------------------------------------------------
+//				   	I M P L E M E N T A T I O N S
+// -----------------------------------------------------------------------
+
+
+template<class KEY, class ITEM>
+inline str tostr(const FilteredHashMap<KEY, ITEM>& hashmap)
+{
+	// return 1-line description of hashmap for debugging and logging:
+	return usingstr("FilteredHashMap[%u]", hashmap.count());
+}
+
+template<class KEY, class ITEM>
+FilteredHashMap<KEY, ITEM>::FilteredHashMap(uint max, double fp_rate) throws :
+	map(max),
+	filter(max, fp_rate),
+	filter_max(max),
+	fp_rate(fp_rate)
+{}
+
+template<class KEY, class ITEM>
+void FilteredHashMap<KEY, ITEM>::rebuild_filter(uint max) throws
+{
+	// create a new filter for up to max keys and add all keys from the map
+
+	BloomFilter<KEY> f(max, fp_rate);
+	f.add_all(map.getKeys());
+	filter	   = std::move(f);
+	filter_max = max;
+	removed	   = 0;
+}
+
+template<class KEY, class ITEM>
+void FilteredHashMap<KEY, ITEM>::make_room(KEY key) throws
+{
+	// make room in the filter before a key is added to the map
+	// so that the map is unchanged if rebuilding the filter throws.
+	// if the filter is full and the key is new then it is rebuilt for twice the number of keys incl. this key.
+
+	if (filter.count() >= filter_max && !map.contains(key)) rebuild_filter((map.count() + 1) * 2);
+}
+
+template<class KEY, class ITEM>
+void FilteredHashMap<KEY, ITEM>::purge() noexcept
+{
+	map.purge();
+	filter.purge();
+	removed = 0;
+}
+
+template<class KEY, class ITEM>
+FilteredHashMap<KEY, ITEM>& FilteredHashMap<KEY, ITEM>::add(KEY key, ITEM item) throws
+{
+	// add or overwrite item
+	// an overwritten key is already in the filter
+
+	make_room(key);
+	uint n = map.count();
+	map.add(key, item);
+	if (map.count() != n) filter.add(key);
+	return *this;
+}
+
+template<class KEY, class ITEM>
+FilteredHashMap<KEY, ITEM>& FilteredHashMap<KEY, ITEM>::add_new(KEY key, ITEM item) throws
+{
+	make_room(key);
+	map.add_new(key, item);
+	filter.add(key);
+	return *this;
+}
+
+template<class KEY, class ITEM>
+void FilteredHashMap<KEY, ITEM>::remove(KEY key) noexcept
+{
+	// remove item
+	// the key remains in the filter until it is rebuilt
+
+	if (!filter.contains(key)) return;
+	uint n = map.count();
+	map.remove(key);
+	if (map.count() == n) return;
+
+	if (++removed > map.count() && removed >= 64)
+	{
+		try
+		{
+			rebuild_filter(filter_max);
+		}
+		catch (std::bad_alloc&)
+		{} // keep the old filter
+	}
+}
+
+template<class KEY, class ITEM>
+void FilteredHashMap<KEY, ITEM>::deserialize(FD& fd, void* data) throws
+{
+	// deserialize map: same format as HashMap
+	// the filter is not stored in the file but rebuilt
+	// if this throws then the map is purged, because the filter does not match it
+
+	try
+	{
+		map.deserialize(fd, data);
+		rebuild_filter(max(filter_max, map.count()));
+	}
+	catch (...)
+	{
+		purge();
+		throw;
+	}
+}
@@ -0,0 +1,150 @@
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+
+#include "Templates/FilteredHashMap.h"
+#include "doctest/doctest/doctest.h"
+#include "unix/FD.h"
+
+
+TEST_CASE("FilteredHashMap")
+{
+	SUBCASE("") { logline("●●● %s:", __FILE__); }
+
+	SUBCASE("add, get, remove")
+	{
+		FilteredHashMap<cstr, int> m(16);
+		CHECK(m.count() == 0);
+		CHECK(!m.contains("foo"));
+		CHECK(m.find("foo") == nullptr);
+		CHECK(m.get("foo", -1) == -1);
+
+		m.add("foo", 1).add("bar", 2);
+		m.add_new("baz", 3);
+		CHECK(m.count() == 3);
+		CHECK(m.contains(usingstr("%s", "foo")));
+		CHECK(m["bar"] == 2);
+		CHECK(*m.find("baz") == 3);
+		m.add("foo", 11);
+		CHECK(m.get("foo") == 11);
+		CHECK(m.count() == 3);
+
+		m.remove("foo");
+		m.remove("xxx");
+		CHECK(m.count() == 2);
+		CHECK(!m.contains("foo"));
+		CHECK(m.find("foo") == nullptr);
+
+		m.purge();
+		CHECK(m.count() == 0);
+		CHECK(!m.contains("bar"));
+	}
+
+	SUBCASE("grow and shrink")
+	{
+		// the filter is rebuilt when it is too small or has many removed keys
+
+		FilteredHashMap<uint, uint> m(100);
+		for (uint i = 0; i < 10000; i++) m.add(i, i * 3);
+		CHECK(m.count() == 10000);
+		uint errors = 0;
+		for (uint i = 0; i < 10000; i++) errors += m.get(i, 0) != i * 3;
+		CHECK(errors == 0);
+
+		uint fp = 0;
+		for (uint i = 10000; i < 20000; i++) fp += m.getFilter().contains(i);
+		CHECK(fp < 200);
+
+		for (uint i = 0; i < 9900; i++) m.remove(i);
+		CHECK(m.count() == 100);
+		for (uint i = 9900; i < 10000; i++) errors += m.get(i, 0) != i * 3;
+		for (uint i = 0; i < 9900; i++) errors += m.contains(i);
+		CHECK(errors == 0);
+
+		fp = 0;
+		for (uint i = 0; i < 9900; i++) fp += m.getFilter().contains(i);
+		CHECK(fp < 9900 / 2);
+	}
+
+	SUBCASE("overwrite")
+	{
+		// overwriting existing keys must not grow the filter
+
+		FilteredHashMap<uint, uint> m(1000);
+		for (uint i = 0; i < 1000; i++) m.add(i, i);
+		uint bits = m.getFilter().getBitCount();
+		uint cnt  = m.getFilter().count();
+
+		for (uint j = 0; j < 1000; j++)
+			for (uint i = 0; i < 1000; i++) m.add(i, i + j);
+		CHECK(m.count() == 1000);
+		CHECK(m.getFilter().getBitCount() == bits);
+		CHECK(m.getFilter().count() == cnt);
+		CHECK(m.get(999, 0) == 999 + 999);
+	}
+
+	SUBCASE("copy, serialize")
+	{
+		FilteredHashMap<uint, uint> m;
+		for (uint i = 0; i < 1000; i++) m.add(i * 5, i);
+		FilteredHashMap<uint, uint> m2(m);
+		CHECK(m2 == m);
+		CHECK(m2.get(500) == 100);
+
+		FD fd;
+		fd.open_tempfile();
+		m.serialize(fd);
+		fd.rewind_file();
+
+		// same format as HashMap:
+		HashMap<uint, uint> h;
+		h.deserialize(fd);
+		CHECK(h == m.getMap());
+
+		fd.rewind_file();
+		FilteredHashMap<uint, uint> m3(10);
+		m3.deserialize(fd);
+		CHECK(m3 == m);
+		CHECK(m3.contains(4995));
+		CHECK(!m3.contains(4996));
+
+		// failed deserialize() purges the map:
+		CHECK_THROWS(m3.deserialize(fd)); // at end of file
+		CHECK(m3.count() == 0);
+		CHECK(!m3.contains(4995));
+		m3.add(4995, 1);
+		CHECK(m3.get(4995, 0) == 1);
+	}
+}
+
+
+TEST_CASE("FilteredHashMap performance test" * doctest::skip(false))
+{
+	// lookup of keys which are not in the map:
+
+	static constexpr uint N = 4000000;
+
+	HashMap<uint, uint>			h(N);
+	FilteredHashMap<uint, uint> f(N);
+	for (uint i = 0; i < N; i++)
+	{
+		h.add(i * 2654435761u, i);
+		f.add(i * 2654435761u, i);
+	}
+
+	uint   n1 = 0, n2 = 0;
+	double t0 = now();
+	for (uint i = 0; i < N; i++) n1 += h.contains(i * 2654435761u + 1);
+	double t1 = now();
+	for (uint i = 0; i < N; i++) n2 += f.contains(i * 2654435761u + 1);
+	double t2 = now();
+	for (uint i = 0; i < N; i++) n1 += h.contains(i * 2654435761u);
+	double t3 = now();
+	for (uint i = 0; i < N; i++) n2 += f.contains(i * 2654435761u);
+	double t4 = now();
+	CHECK(n1 == n2);
+
+	logline("HashMap<uint>:         %u keys, miss %.1f ns, hit %.1f ns", N, (t1 - t0) * 1e9 / N, (t3 - t2) * 1e9 / N);
+	logline("FilteredHashMap<uint>: %u keys, miss %.1f ns, hit %.1f ns", N, (t2 - t1) * 1e9 / N, (t4 - t3) * 1e9 / N);
+}
@@ -0,0 +1,601 @@
+#pragma once
+// Copyright (c) 2014 - 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+#include "Templates/Array.h"
+#include "hash/hash.h"
+#include "kio/kio.h"
+#include "kio/util/msbit.h"
+#if defined(__SSE2__)
+  #include <emmintrin.h>
+#endif
+
+
+/*	Template class FlatHashMap stores Objects with Keys.
+
+	Same interface and same semantics as HashMap:
+	Keys (Names) must be unique.
+	The FlatHashMap retains ownership of the Objects.
+	Keys are stored as flat copy. (e.g. c-strings or objects are not cloned.)
+	Keys and Items are stored in Arrays keys[] and items[] in order of insertion,
+	removing an item moves the last item into the gap.
+
+	Difference to HashMap:
+	The index in keys[] / items[] is not found by walking a thread of indexes in map[]
+	which must compare the key for every step, but by a search in groups of 16 control bytes.
+	For every slot the control byte holds a 7 bit fragment of the key's hash or EMPTY or DELETED.
+	All 16 control bytes of a group are compared at once (SSE2 if available)
+	so that a miss is rejected with a high probability without looking at any key at all,
+	and a hit needs only one key compare in almost all cases.
+	The slots hold a copy of the key next to the index so that a hit does not need to read keys[].
+
+	The fixed costs are 1 + sizeof(Slot) bytes per slot and there are at least 8/7 slots per item.
+
+	buckets[]	groups of 16 control bytes followed by their 16 slots:
+	ctrl[]		EMPTY = slot never used, DELETED = tombstone, 0..127 = used, holds h2 of the key.
+	slot[]		for all used slots: the key and the index of the key and item in keys[] and items[].
+
+	the hash value of a key is split in h1 and h2:
+	h1 selects the first group to probe, h2 is stored in the control byte.
+	groups are probed in a triangular sequence which visits all groups.
+	the probing stops at the first group which has an EMPTY control byte.
+
+
+	template arguments:
+
+		class KEY		must be a flat type for FlatHashMap. Keys are compared with same().
+		class ITEM		must be a flat type for FlatHashMap.
+*/
+
+
+#ifndef ArrayMAX
+  #define ArrayMAX 0x40000000u /* max size  ((not count)) */
+#endif
+
+
+template<class KEY, class ITEM>
+class FlatHashMap
+{
+private:
+	struct Slot
+	{
+		KEY	   key;
+		uint32 idx;
+	};
+	struct Bucket
+	{
+		int8 ctrl[16]; // control bytes: EMPTY, DELETED or h2
+		Slot slot[16]; // key and index
+	};
+
+	Array<ITEM> items;		 // stored items
+	Array<KEY>	keys;		 // their keys
+	Bucket*		buckets;	 // control bytes and slots
+	uint		gmask;		 // number of buckets -1; must be 1<<N -1
+	uint		growth_left; // number of EMPTY slots which may be used before the map must be resized
+
+	static constexpr uint	GROUPSIZE		  = 16;
+	static constexpr int8	EMPTY			  = -128; // 0x80: slot was never used since last resize
+	static constexpr int8	DELETED			  = -2;	  // 0xFE: slot was used and must not stop the probing
+	static constexpr uint16 MAGIC			  = 0x9C1A;
+	static constexpr uint16 BYTESWAPPED_MAGIC = 0x1A9C;
+
+	struct Group;
+
+private:
+	static uint32 mixhash(KEY key) noexcept
+	{
+		// spread the bits of kio::hash() because h1 uses the high and h2 the low bits:
+		uint32 h = kio::hash(key) * 0x9E3779B1u;
+		return h ^ (h >> 15);
+	}
+	static int8 h2(uint32 h) noexcept { return int8(h & 0x7F); }
+	static uint h1(uint32 h) noexcept { return h >> 7; }
+
+	uint  capacity() const noexcept { return (gmask + 1) * GROUPSIZE; }
+	int8& ctrl(uint i) const noexcept { return buckets[i / GROUPSIZE].ctrl[i % GROUPSIZE]; }
+	Slot& slot(uint i) const noexcept { return buckets[i / GROUPSIZE].slot[i % GROUPSIZE]; }
+	void  clearmap() noexcept;
+	uint  findslot(KEY, uint32 hash) const noexcept;		// find slot in buckets[]; ~0u if not found
+	uint  findfreeslot(uint32 hash) const noexcept;			// find EMPTY or DELETED slot for new key
+	int	  indexof(KEY key) const noexcept;					// find index in items[]; -1 if not found
+	void  resizemap(uint newgroups) throws;					// reallocate buckets[] and rehash
+	void  insertat(uint slot, uint32 hash, KEY, ITEM) throws; // store key & item in free slot
+
+public:
+	static constexpr uint maxCount1 = Array<ITEM>::maxCount;
+	static constexpr uint maxCount2 = Array<KEY>::maxCount;
+	static constexpr uint maxCount	= maxCount1 < maxCount2 ? maxCount1 : maxCount2;
+
+	// see https://stackoverflow.com/questions/11562/how-to-overload-stdswap
+	static void swap(FlatHashMap& a, FlatHashMap& b) noexcept;
+
+	explicit FlatHashMap(uint max = 1 << 10) throws; // default: for up to 1024 items without resizing
+	explicit FlatHashMap(const FlatHashMap&) throws;
+	FlatHashMap(FlatHashMap&&) noexcept;
+	~FlatHashMap() noexcept { delete[] buckets; }
+	FlatHashMap& operator=(FlatHashMap&&) noexcept;
+	FlatHashMap& operator=(const FlatHashMap&) throws;
+
+	// get internal data:
+	uint getMapSize() const noexcept { return capacity(); }
+
+	const Array<KEY>&  getKeys() const noexcept { return keys; }
+	Array<ITEM>&	   getItems() noexcept { return items; }
+	const Array<ITEM>& getItems() const noexcept { return items; }
+
+	// get items:
+	uint  count() const noexcept { return items.count(); }
+	bool  contains(KEY key) const noexcept { return indexof(key) != -1; } // uses same(KEY,KEY)
+	ITEM  get(KEY key, ITEM dflt) const noexcept;						  // uses same(KEY,KEY)
+	ITEM& get(KEY key) noexcept
+	{
+		int i = indexof(key);
+		assert(i != -1);
+		return items[i];
+	}
+	ITEM const& get(KEY key) const noexcept
+	{
+		int i = indexof(key);
+		assert(i != -1);
+		return items[i];
+	}
+	ITEM& operator[](KEY key) noexcept
+	{
+		int i = indexof(key);
+		assert(i != -1);
+		return items[i];
+	}
+	ITEM const& operator[](KEY key) const noexcept
+	{
+		int i = indexof(key);
+		assert(i != -1);
+		return items[i];
+	}
+	ITEM* find(KEY key) noexcept
+	{
+		int i = indexof(key);
+		return i >= 0 ? &items[i] : nullptr;
+	}
+	ITEM const* find(KEY key) const noexcept
+	{
+		int i = indexof(key);
+		return i >= 0 ? &items[i] : nullptr;
+	}
+
+	// add / remove items:
+	void		 purge() noexcept;
+	FlatHashMap& add(KEY, ITEM) throws;		// overwrites if key already exists
+	FlatHashMap& add_new(KEY, ITEM) throws; // key must be new
+	void		 remove(KEY) noexcept;		// silently does nothing if key does not exist
+
+	// misc:
+	bool operator==(const FlatHashMap& q) const noexcept;							// uses same(KEY,KEY) and ITEM::ne()
+	bool operator!=(const FlatHashMap& q) const noexcept { return !operator==(q); } // uses same(KEY,KEY) and ITEM::ne()
+
+	// read / write file:
+	void print(FD&, cstr indent) const throws;
+	void serialize(FD&, void* data = nullptr) const throws;
+	void deserialize(FD&, void* data = nullptr) throws;
+};
+
+
+// -----------------------------------------------------------------------
+//				   	I M P L E M E N T A T I O N S
+// -----------------------------------------------------------------------
+
+
+template<class KEY, class ITEM>
+struct FlatHashMap<KEY, ITEM>::Group
+{
+	// a group of 16 control bytes
+	// the match functions return a bit mask with one bit per matching control byte
+
+#if defined(__SSE2__)
+	__m128i ctrl;
+
+	explicit Group(const int8* p) noexcept : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) {}
+	uint match(int8 h2) const noexcept { return uint(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl))); }
+	uint match_empty() const noexcept { return match(EMPTY); }
+	uint match_free() const noexcept { return uint(_mm_movemask_epi8(ctrl)); } // EMPTY or DELETED: bit 7 set
+#else
+	const int8* ctrl;
+
+	explicit Group(const int8* p) noexcept : ctrl(p) {}
+	uint match(int8 h2) const noexcept
+	{
+		uint bits = 0;
+		for (uint i = 0; i < GROUPSIZE; i++) { bits |= uint(ctrl[i] == h2) << i; }
+		return bits;
+	}
+	uint match_empty() const noexcept { return match(EMPTY); }
+	uint match_free() const noexcept
+	{
+		uint bits = 0;
+		for (uint i = 0; i < GROUPSIZE; i++) { bits |= uint(ctrl[i] < 0) << i; }
+		return bits;
+	}
+#endif
+};
+
+
+template<class KEY, class ITEM>
+inline str tostr(const FlatHashMap<KEY, ITEM>& hashmap)
+{
+	// return 1-line description of hashmap for debugging and logging:
+	return usingstr("FlatHashMap[%u]", hashmap.count());
+}
+
+
+template<class KEY, class ITEM>
+inline void FlatHashMap<KEY, ITEM>::swap(FlatHashMap<KEY, ITEM>& a, FlatHashMap<KEY, ITEM>& b) noexcept
+{
+	std::swap(a.items, b.items);
+	std::swap(a.keys, b.keys);
+	std::swap(a.buckets, b.buckets);
+	std::swap(a.gmask, b.gmask);
+	std::swap(a.growth_left, b.growth_left);
+}
+
+template<class KEY, class ITEM>
+FlatHashMap<KEY, ITEM>::FlatHashMap(uint max) throws :
+	items(),
+	keys(),
+	buckets(nullptr),
+	gmask(0),
+	growth_left(0)
+{
+	// create FlatHashMap with preallocated items[] and initial buckets[] size
+	// there will be no reallocation of items[] and no rehashing up to max items
+	// the load factor of the map is kept below 7/8
+
+	assert(max > 0);
+	assert(max <= maxCount);
+
+	uint groups = max / 14 + 1; // 14 = GROUPSIZE * 7/8
+	resizemap(groups <= 1 ? 1 : 2u << msbit(groups - 1));
+
+	items.grow(0, max);
+	keys.grow(0, max);
+}
+
+template<class KEY, class ITEM>
+FlatHashMap<KEY, ITEM>::FlatHashMap(FlatHashMap&& q) noexcept :
+	items(std::move(q.items)),
+	keys(std::move(q.keys)),
+	buckets(q.buckets),
+	gmask(q.gmask),
+	growth_left(q.growth_left)
+{
+	q.gmask		  = 0;
+	q.buckets	  = new Bucket[1]; // size = gmask+1 => can't be = 0
+	q.growth_left = GROUPSIZE * 7 / 8;
+	q.clearmap();
+}
+
+template<class KEY, class ITEM>
+FlatHashMap<KEY, ITEM>::FlatHashMap(const FlatHashMap& q) throws :
+	items(),
+	keys(),
+	buckets(nullptr),
+	gmask(0),
+	growth_left(0)
+{
+	items		= q.items;
+	keys		= q.keys;
+	buckets		= new Bucket[q.gmask + 1];
+	gmask		= q.gmask;
+	growth_left = q.growth_left;
+	memcpy(buckets, q.buckets, (gmask + 1) * sizeof(*buckets));
+}
+
+template<class KEY, class ITEM>
+FlatHashMap<KEY, ITEM>& FlatHashMap<KEY, ITEM>::operator=(FlatHashMap&& q) noexcept
+{
+	swap(*this, q);
+	return *this;
+}
+
+template<class KEY, class ITEM>
+FlatHashMap<KEY, ITEM>& FlatHashMap<KEY, ITEM>::operator=(const FlatHashMap& q) throws
+{
+	if (this != &q)
+	{
+		this->~FlatHashMap();
+		new (this) FlatHashMap(q);
+	}
+	return *this;
+}
+
+template<class KEY, class ITEM>
+void FlatHashMap<KEY, ITEM>::clearmap() noexcept
+{
+	for (uint i = 0; i <= gmask; i++) { memset(buckets[i].ctrl, EMPTY, GROUPSIZE); }
+}
+
+template<class KEY, class ITEM>
+inline ITEM FlatHashMap<KEY, ITEM>::get(KEY key, ITEM dflt) const noexcept
+{
+	int idx = indexof(key);
+	return idx == -1 ? std::move(dflt) : items[idx];
+}
+
+template<class KEY, class ITEM>
+void FlatHashMap<KEY, ITEM>::purge() noexcept
+{
+	// clear FlatHashMap
+	// the buckets[] are not resized
+	// but all entries are cleared to EMPTY
+
+	items.purge();
+	keys.purge();
+	clearmap();
+	growth_left = capacity() * 7 / 8;
+}
+
+template<class KEY, class ITEM>
+void FlatHashMap<KEY, ITEM>::resizemap(uint newgroups) throws
+{
+	xlogline("FlatHashMap: resize map to %u groups", newgroups);
+
+	assert(newgroups == 1u << msbit(newgroups)); // also catches size=0
+	assert(newgroups <= ArrayMAX / sizeof(Bucket));
+	assert(newgroups * GROUPSIZE * 7 / 8 >= items.count());
+
+	// allocate and clear buckets[]:
+	Bucket* newbuckets = new Bucket[newgroups];
+	delete[] buckets;
+	buckets = newbuckets;
+	gmask	= newgroups - 1;
+	clearmap();
+	growth_left = capacity() * 7 / 8 - items.count();
+
+	// put all items back into map:
+	for (uint idx = 0, e = items.count(); idx < e; idx++)
+	{
+		uint32 h = mixhash(keys[idx]);
+		uint   i = findfreeslot(h);
+		ctrl(i)  = h2(h);
+		slot(i)  = Slot {keys[idx], idx};
+	}
+}
+
+template<class KEY, class ITEM>
+uint FlatHashMap<KEY, ITEM>::findslot(KEY key, uint32 h) const noexcept
+{
+	// search for key
+	// returns slot index in buckets[] or ~0u
+
+	int8 c = h2(h);
+	for (uint g = h1(h) & gmask, step = 0;; g = (g + ++step) & gmask)
+	{
+		const Bucket& bucket = buckets[g];
+		Group		  group(bucket.ctrl);
+		for (uint bits = group.match(c); bits; bits &= bits - 1)
+		{
+			uint i = uint(__builtin_ctz(bits));
+			if (kio::same(bucket.slot[i].key, key)) return g * GROUPSIZE + i; // found
+		}
+		if (group.match_empty()) return ~0u; // the key would have been stored in this group
+		assert(step <= gmask);
+	}
+}
+
+template<class KEY, class ITEM>
+uint FlatHashMap<KEY, ITEM>::findfreeslot(uint32 h) const noexcept
+{
+	// find first EMPTY or DELETED slot in the probing sequence for hash
+	// there must be at least one free slot in buckets[]
+
+	for (uint g = h1(h) & gmask, step = 0;; g = (g + ++step) & gmask)
+	{
+		uint bits = Group(buckets[g].ctrl).match_free();
+		if (bits) return g * GROUPSIZE + uint(__builtin_ctz(bits));
+		assert(step <= gmask);
+	}
+}
+
+template<class KEY, class ITEM>
+inline int FlatHashMap<KEY, ITEM>::indexof(KEY key) const noexcept
+{
+	// search for key
+	// returns index in items[] or -1
+
+	uint i = findslot(key, mixhash(key));
+	return i == ~0u ? -1 : int(slot(i).idx);
+}
+
+template<class KEY, class ITEM>
+void FlatHashMap<KEY, ITEM>::insertat(uint i, uint32 h, KEY key, ITEM item) throws
+{
+	// store key and item in free slot i
+	// if the slot is EMPTY and there are no more EMPTY slots to spend then rehash
+
+	if (ctrl(i) == EMPTY && growth_left == 0)
+	{
+		// remove all tombstones or grow the map:
+		uint groups = gmask + 1;
+		resizemap(items.count() >= capacity() * 7 / 16 ? groups * 2 : groups);
+		i = findfreeslot(h);
+	}
+
+	items.append(std::move(item)); // may throw
+	keys.append(key);			   // may throw
+
+	growth_left -= ctrl(i) == EMPTY;
+	ctrl(i) = h2(h);
+	slot(i) = Slot {key, items.count() - 1};
+}
+
+template<class KEY, class ITEM>
+FlatHashMap<KEY, ITEM>& FlatHashMap<KEY, ITEM>::add(KEY key, ITEM item) throws
+{
+	// add item for key
+	// if key alredy exists, then overwrite
+
+	uint32 h = mixhash(key);
+	uint   i = findslot(key, h);
+
+	if (i != ~0u) // key exists => overwrite & exit:
+	{
+		uint idx	= slot(i).idx;
+		items[idx]	= std::move(item); // overwrite item at idx
+		keys[idx]	= key; // also overwrite key, if KEY==cstr then the key may be kept alive by it's item
+		slot(i).key = key;
+	}
+	else insertat(findfreeslot(h), h, key, std::move(item));
+
+	return *this;
+}
+
+template<class KEY, class ITEM>
+FlatHashMap<KEY, ITEM>& FlatHashMap<KEY, ITEM>::add_new(KEY key, ITEM item) throws
+{
+	// add item for key
+	// key must be new
+
+	assert(!contains(key));
+
+	uint32 h = mixhash(key);
+	insertat(findfreeslot(h), h, key, std::move(item));
+	return *this;
+}
+
+template<class KEY, class ITEM>
+void FlatHashMap<KEY, ITEM>::remove(KEY key) noexcept
+{
+	// remove key
+	// silently ignores if key does not exist
+
+	uint i = findslot(key, mixhash(key));
+	if (i == ~0u) return; // not found
+
+	uint idx = slot(i).idx;
+
+	// if the slot's group has an EMPTY slot then the probing never continued beyond this group
+	// and the slot can be set to EMPTY, else it must become a tombstone:
+	if (Group(buckets[i / GROUPSIZE].ctrl).match_empty())
+	{
+		ctrl(i) = EMPTY;
+		growth_left++;
+	}
+	else ctrl(i) = DELETED;
+
+	// move items.last() into gap:
+	uint idx2 = items.count() - 1;
+	if (idx != idx2)
+	{
+		// find slot for moved item:
+		uint32 h = mixhash(keys[idx2]);
+		int8   c = h2(h);
+		for (uint g = h1(h) & gmask, step = 0;; g = (g + ++step) & gmask)
+		{
+			Slot* p = buckets[g].slot;
+			uint  bits;
+			for (bits = Group(buckets[g].ctrl).match(c); bits; bits &= bits - 1)
+			{
+				uint j = uint(__builtin_ctz(bits));
+				if (p[j].idx == idx2)
+				{
+					p[j].idx = idx;
+					break;
+				}
+			}
+			if (bits) break;
+			assert(step <= gmask); // must exist
+		}
+
+		// move item:
+		items[idx] = std::move(items[idx2]);
+		keys[idx]  = keys[idx2];
+	}
+	items.drop();
+	keys.drop();
+}
+
+template<class KEY, class TYPE>
+bool FlatHashMap<KEY, TYPE>::operator==(const FlatHashMap& q) const noexcept
+{
+	if (keys.count() != q.keys.count()) return false;
+	for (uint i = keys.count(); i--;)
+	{
+		int qi = q.indexof(keys[i]);
+		if (qi == -1 || ne(items[i], q.items[qi])) return false;
+	}
+	return true;
+}
+
+template<class KEY, class TYPE>
+void FlatHashMap<KEY, TYPE>::serialize(FD& fd, void* data) const throws
+{
+	fd.write_uint16_z(MAGIC);
+	items.serialize(fd, data);
+	keys.serialize(fd, data);
+}
+
+template<class KEY, class TYPE>
+void FlatHashMap<KEY, TYPE>::deserialize(FD& fd, void* data) throws
+{
+	// deserialize: supports reading back on byte swapped host. (if items support this.)
+	uint m = fd.read_uint16_z();
+	if (m != MAGIC && m != BYTESWAPPED_MAGIC) throw DataError("FlatHashMap<T,U>: wrong magic");
+
+	items.deserialize(fd, data);
+	keys.deserialize(fd, data);
+	if (items.count() != keys.count()) throw DataError("FlatHashMap<T,U>: key/item mismatch");
+
+	uint groups = items.count() / 14 + 1;
+	resizemap(groups <= 1 ? 1 : 2u << msbit(groups - 1));
+}
+
+
+// ____ print() ____
+
+template<typename KEY, typename ITEM>
+inline typename std::enable_if<kio::has_print<ITEM>::value, void>::type
+/*void*/
+print(FD& fd, const FlatHashMap<KEY, ITEM>& hashmap, cstr indent) throws
+{
+	// pretty print with indentation
+	// this function is called by FlatHashMap<K,T>::print() for classes T which implement T::print()
+
+	KEY const*	keys  = hashmap.getKeys().getData();
+	ITEM const* items = hashmap.getItems().getData();
+
+	fd.write_fmt("%sFlatHashMap[%u]\n", indent, hashmap.count());
+	indent = catstr("  ", indent);
+	for (uint i = 0; i < hashmap.count(); i++)
+	{
+		fd.write_fmt("%s[%2u] [#%8x] %s = ", indent, i, kio::hash(keys[i]), tostr(keys[i]));
+		items[i].print(fd, "");
+	}
+}
+
+template<typename KEY, typename ITEM>
+inline typename std::enable_if<!kio::has_print<ITEM>::value, void>::type
+/*void*/
+print(FD& fd, const FlatHashMap<KEY, ITEM>& hashmap, cstr indent) throws
+{
+	// pretty print with indentation
+	// this function is called by FlatHashMap<K,T>::print() for classes T which don't implement T::print()
+
+	KEY const*	keys  = hashmap.getKeys().getData();
+	ITEM const* items = hashmap.getItems().getData();
+
+	fd.write_fmt("%sFlatHashMap[%u]\n", indent, hashmap.count());
+	indent = catstr("  ", indent);
+	for (uint i = 0; i < hashmap.count(); i++)
+	{
+		fd.write_fmt("%s[%2u] [#%8x] %s = %s\n", indent, i, kio::hash(keys[i]), tostr(keys[i]), tostr(items[i]));
+	}
+}
+
+template<typename KEY, typename ITEM>
+void FlatHashMap<KEY, ITEM>::print(FD& fd, cstr indent) const throws
+{
+	// pretty print with indentation
+	// this template will find the above print(FD&,FlatHashMap<T,U>const&,cstr)
+
+	::print(fd, *this, indent);
+}
@@ -0,0 +1,215 @@
+// Copyright (c) 2014 - 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+
+#include "Templates/FlatHashMap.h"
+#include "Templates/Array.h"
+#include "doctest/doctest/doctest.h"
+#include "unix/FD.h"
+
+
+TEST_CASE("FlatHashMap")
+{
+	SUBCASE("") { logline("●●● %s:", __FILE__); }
+
+	SUBCASE("")
+	{
+		FlatHashMap<int, int> map(8);
+		CHECK(map.count() == 0);
+		CHECK(map.getMapSize() == 16); // expected, not required
+		CHECK(map.getKeys().count() == 0);
+		CHECK(map.getItems().count() == 0);
+		CHECK(!map.contains(0));
+	}
+
+	SUBCASE("")
+	{
+		FlatHashMap<int, int> map1;
+		for (int i = 0; i < 999; i++) map1.add(i * 7, i * 77);
+		for (int i = 0; i < 999 * 7; i++) CHECK_UNARY(i % 7 ? map1.get(i, -1) == -1 : map1[i] == i * 11);
+
+		const FlatHashMap<int, int> map2(map1);
+		CHECK(map1.getItems() == map2.getItems());
+		CHECK(map1.getKeys() == map2.getKeys());
+		CHECK(map1.getMapSize() == map2.getMapSize());
+		for (int i = 0; i < 999 * 7; i++) CHECK_UNARY(i % 7 ? map2.get(i, -1) == -1 : map2[i] == i * 11);
+	}
+
+	SUBCASE("")
+	{
+		FlatHashMap<int, int> map1(8);
+		map1.add(1, 10).add(5, 19).add(0, 27);
+		FlatHashMap<int, int> map2(std::move(map1));
+		CHECK(map1.count() == 0);
+		CHECK(!map1.contains(1));
+		CHECK(!map1.contains(5));
+		CHECK(!map1.contains(0));
+		map1.add(3, 33);
+		CHECK(map1[3] == 33);
+		CHECK(map2.count() == 3);
+		map2.add(4, 88);
+		CHECK(map2[1] == 10);
+		CHECK(map2[5] == 19);
+		CHECK(map2[0] == 27);
+		CHECK(map2[4] == 88);
+	}
+
+	SUBCASE("")
+	{
+		FlatHashMap<int, int> map1(8);
+		FlatHashMap<int, int> map2;
+		map1.add(1, 10).add(5, 19).add(0, 27);
+
+		map2 = map1;
+		CHECK(map1 == map2);
+
+		map1.remove(1);
+		map2.add(4, 88);
+		CHECK(map1 == (FlatHashMap<int, int>().add(5, 19).add(0, 27)));
+		CHECK(map2 == (FlatHashMap<int, int>().add(5, 19).add(0, 27).add(4, 88).add(1, 10)));
+	}
+
+	SUBCASE("")
+	{
+		FlatHashMap<int, int> map(8);
+
+		map.add(1, 10);
+		map.add(2, 19);
+		map.add(0, 0);
+		CHECK_UNARY(map.count() == 3 && map[0] == 0 && map[1] == 10 && map[2] == 19);
+		map.add(2, 20);
+		CHECK_UNARY(map.count() == 3 && map[0] == 0 && map[1] == 10 && map[2] == 20);
+		CHECK_UNARY(map.contains(1) && map.contains(2) && map.contains(0));
+		CHECK_UNARY_FALSE(map.contains(3) || map.contains(4) || map.contains(5));
+
+		for (int i = 3; i < 100; i++) map.add_new(i, i * 10); // note: this grows the map
+		CHECK(map.count() == 100);
+		CHECK(map.getMapSize() >= 100 * 8 / 7);
+		for (int i = 0; i < 100; i++) CHECK(map[i] == i * 10);
+		for (int i = 0; i < 100; i++) CHECK(*map.find(i) == i * 10);
+		CHECK(map.find(100) == nullptr);
+
+		map.remove(13);
+		CHECK(map.count() == 99);
+		for (int i = 0; i < 100; i++) CHECK(map.contains(i) == (i != 13));
+		map.remove(13);
+		CHECK(map.count() == 99);
+
+		map.purge();
+		CHECK_UNARY(map.count() == 0 && !map.contains(0));
+		map.add(0, 0);
+		CHECK(map.count() == 1);
+		CHECK(map[0] == 0);
+	}
+
+	SUBCASE("")
+	{
+		FlatHashMap<cstr, uint> a;
+		FlatHashMap<cstr, uint> b;
+
+		a.add("A", 2).add("Ccc", 22).add("Bb", 44);
+		FD fd;
+		fd.open_tempfile();
+		a.serialize(fd);
+		fd.write_char('X');
+
+		fd.rewind_file();
+		b.deserialize(fd);
+		CHECK(a == b);
+		CHECK(fd.read_char() == 'X');
+	}
+
+	SUBCASE("")
+	{
+		FlatHashMap<cstr, uint> a;
+		a.add("Aaa", 33).add("Ccc", 22).add("Bbb", 44);
+
+		FD fd;
+		fd.open_tempfile();
+		a.print(fd, "•");
+		fd.write_char('X');
+
+		fd.rewind_file();
+		CHECK(eq(fd.read_str(), "•FlatHashMap[3]"));
+		CHECK(eq(fd.read_str(), usingstr("  •[ 0] [#%8x] \"Aaa\" = 33", kio::sdbm_hash("Aaa"))));
+		CHECK(eq(fd.read_str(), usingstr("  •[ 1] [#%8x] \"Ccc\" = 22", kio::sdbm_hash("Ccc"))));
+		CHECK(eq(fd.read_str(), usingstr("  •[ 2] [#%8x] \"Bbb\" = 44", kio::sdbm_hash("Bbb"))));
+		CHECK(fd.read_char() == 'X');
+	}
+}
+
+TEST_CASE("FlatHashMap stress test")
+{
+	static const uint N = 10000;
+
+	Array<uint> a(N);
+	for (uint i = 0; i < N; i++) { a[i] = i; }
+	a.shuffle();
+
+	FlatHashMap<uint, uint> map(8);
+	for (uint i = 0; i < N; i++) { map.add(a[i], a[i] ^ 1); }
+	CHECK(map.count() == N);
+	for (uint i = 0; i < N; i += 9) { map.add(a[i], a[i] ^ 1); }
+	CHECK(map.count() == N);
+	for (uint i = 0; i < N; i++) CHECK(map[i] == (i ^ 1));
+
+	a.shuffle();
+	Array<uint> r(&a[0], N / 2);
+	a.removerange(0, N / 2);
+	for (uint i = 0; i < r.count(); i++) map.remove(r[i]);
+	CHECK(map.count() == a.count());
+	for (uint i = 0; i < r.count(); i++) map.remove(r[i]);
+	CHECK(map.count() == a.count());
+
+	for (uint i = 0; i < a.count(); i++) CHECK(map.contains(a[i]));
+	for (uint i = 0; i < r.count(); i++) CHECK(!map.contains(r[i]));
+
+	// many add/remove cycles: tombstones must not fill up the map
+	uint mapsize = map.getMapSize();
+	for (uint i = 0; i < 100000; i++)
+	{
+		if (random() & 1)
+		{
+			if (a.count() == 0) continue;
+			uint ai = uint(random() % a.count());
+			map.remove(a[ai]);
+			r.append(a[ai]);
+			a.removeat(ai, true);
+		}
+		else
+		{
+			if (r.count() == 0) continue;
+			uint ri = uint(random() % r.count());
+			map.add(r[ri], r[ri] ^ 1);
+			a.append(r[ri]);
+			r.removeat(ri, true);
+		}
+	}
+	CHECK(map.count() == a.count());
+	CHECK(map.getMapSize() <= mapsize * 2);
+
+	for (uint i = 0; i < a.count(); i++) CHECK(map.contains(a[i]));
+	for (uint i = 0; i < r.count(); i++) CHECK(!map.contains(r[i]));
+	for (uint i = 0; i < a.count(); i++) CHECK(map[a[i]] == (a[i] ^ 1));
+}
+
+TEST_CASE("FlatHashMap cstr key test:")
+{
+	TempMemPool zz;
+
+	FlatHashMap<cstr, uint> map(8);
+	Array<cstr>				a;
+	for (uint i = 0; i < 5000; i++)
+	{
+		a.append(usingstr("key_%u", i));
+		map.add(a.last(), i);
+	}
+	CHECK(map.count() == 5000);
+	for (uint i = 0; i < 5000; i++) CHECK(map.get(usingstr("key_%u", i), ~0u) == i);
+	for (uint i = 5000; i < 6000; i++) CHECK(!map.contains(usingstr("key_%u", i)));
+
+	for (uint i = 0; i < 5000; i += 2) map.remove(a[i]);
+	CHECK(map.count() == 2500);
+	for (uint i = 0; i < 5000; i++) CHECK(map.contains(usingstr("key_%u", i)) == bool(i & 1));
+}
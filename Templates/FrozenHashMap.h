@@ -0,0 +1,339 @@
+#pragma once
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+#include "Templates/HashMap.h"
+#include "unix/FD.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <type_traits>
+
+
+/*	FrozenHashMap<KEY,ITEM> is a read-only view of a HashMap which was written with FrozenHashMap::write().
+
+	HashMap::deserialize() reads the keys and items and rebuilds the hashes and the map[].
+	This is slow for large maps. A frozen image instead contains the HashMap as it is in memory:
+	map[], hashes[], keys[] and items[], and for cstr keys a blob with all strings.
+	open() maps the file and is ready: there is no parsing, the pages are loaded on demand by the OS.
+
+	The image is position independent: the header stores the file offsets of all sections
+	and cstr keys are stored as offsets into the string blob.
+	The image is written in host byte order. Opening it on a host with different byte order
+	is detected by the MAGIC (same as HashMap) and throws a DataError.
+
+	file layout:
+
+		Header		magic, version, sizes of KEY and ITEM, count, mask and the offsets of the sections
+		map[]		int32[mask+1]  as in HashMap
+		hashes[]	uint32[count]  as in HashMap
+		keys[]		KEY[count]	   cstr: uint32 offsets into strings[]
+		items[]		ITEM[count]
+		strings[]	only for cstr keys: all keys with a 0 terminator
+
+	all sections are 16 byte aligned.
+
+	template arguments:
+
+		class KEY		must be a flat type or cstr. Keys are compared with same(). No other pointers.
+		class ITEM		must be trivially copyable and must not contain pointers.
+*/
+
+
+namespace kio
+{
+template<class KEY>
+struct frozen_key // how keys are stored in the image
+{
+	static_assert(!std::is_pointer<KEY>::value, "pointers can't be frozen");
+	static_assert(std::is_trivially_copyable<KEY>::value, "KEY must be trivially copyable");
+
+	using type = KEY;
+	static KEY	get(const type& k, cstr) noexcept { return k; }
+	static void freeze(const Array<KEY>& keys, Array<type>& fkeys, Array<char>&) throws { fkeys = keys; }
+};
+
+template<>
+struct frozen_key<cstr>
+{
+	using type = uint32; // offset in strings[]
+	static cstr get(type k, cstr strings) noexcept { return strings + k; }
+	static void freeze(const Array<cstr>& keys, Array<type>& fkeys, Array<char>& strings) throws
+	{
+		fkeys.grow(0, keys.count());
+		for (uint i = 0; i < keys.count(); i++)
+		{
+			fkeys.append(strings.count());
+			strings.append(keys[i], uint(strlen(keys[i]) + 1));
+		}
+	}
+};
+} // namespace kio
+
+
+template<class KEY, class ITEM>
+class FrozenHashMap
+{
+	static_assert(std::is_trivially_copyable<ITEM>::value, "ITEM must be trivially copyable");
+	static_assert(!std::is_pointer<ITEM>::value, "pointers can't be frozen");
+	static_assert(alignof(ITEM) <= 16, "");
+
+	using Traits = kio::frozen_key<KEY>;
+	using FKEY	 = typename Traits::type;
+
+	struct Header
+	{
+		uint16 magic;	 // HashMap::MAGIC
+		uint16 version;	 // VERSION
+		uint16 keysize;	 // sizeof(FKEY)
+		uint16 itemsize; // sizeof(ITEM)
+		uint32 count;
+		uint32 mask;
+		uint64 map, hashes, keys, items, strings; // file offsets of the sections
+		uint64 size;							  // file size
+	};
+	static_assert(sizeof(Header) == 64, "");
+
+	static constexpr int	BIT31			  = INT_MIN; // end-of-thread marker as in HashMap
+	static constexpr int	FREE			  = -1;		 // free slot as in HashMap
+	static constexpr uint16 MAGIC			  = 0x9C0A;	 // same as HashMap
+	static constexpr uint16 BYTESWAPPED_MAGIC = 0x0A9C;
+	static constexpr uint16 VERSION			  = 1;
+
+	static uint64 align(uint64 n) noexcept { return (n + 15) & ~uint64(15); }
+
+	cptr		  image	  = nullptr; // the mapped file
+	size_t		  size	  = 0;
+	const int*	  map	  = &free_slot;
+	const uint32* hashes  = nullptr;
+	const FKEY*	  keys	  = nullptr;
+	const ITEM*	  items	  = nullptr;
+	cstr		  strings = nullptr;
+	uint		  cnt	  = 0;
+	uint		  mask	  = 0;
+
+	static const int free_slot; // map[] of an empty FrozenHashMap
+
+	int indexof(KEY) const noexcept; // find index in items[]; -1 if not found
+
+public:
+	FrozenHashMap() noexcept = default;
+	explicit FrozenHashMap(cstr path) throws { open(path); }
+	~FrozenHashMap() noexcept { close(); }
+	FrozenHashMap(FrozenHashMap&& q) noexcept { swap(q); }
+	FrozenHashMap& operator=(FrozenHashMap&& q) noexcept
+	{
+		swap(q);
+		return *this;
+	}
+	FrozenHashMap(const FrozenHashMap&)			   = delete;
+	FrozenHashMap& operator=(const FrozenHashMap&) = delete;
+	void		   swap(FrozenHashMap& q) noexcept;
+
+	// write frozen image of a HashMap:
+	static void write(FD&, const HashMap<KEY, ITEM>&) throws;
+	static void write(cstr path, const HashMap<KEY, ITEM>& q) throws
+	{
+		FD fd(path, 'w');
+		write(fd, q);
+	}
+
+	// map a frozen image:
+	void open(cstr path) throws;
+	void close() noexcept;
+	bool is_open() const noexcept { return image != nullptr; }
+
+	// get items:
+	uint		count() const noexcept { return cnt; }
+	bool		contains(KEY key) const noexcept { return indexof(key) != -1; } // uses same(KEY,KEY)
+	ITEM		get(KEY key, ITEM dflt) const noexcept;							// uses same(KEY,KEY)
+	ITEM const& get(KEY key) const noexcept
+	{
+		int i = indexof(key);
+		assert(i != -1);
+		return items[i];
+	}
+	ITEM const& operator[](KEY key) const noexcept { return get(key); }
+	ITEM const* find(KEY key) const noexcept
+	{
+		int i = indexof(key);
+		return i >= 0 ? &items[i] : nullptr;
+	}
+
+	// iterate over all items:
+	KEY getKey(uint i) const noexcept
+	{
+		assert(i < cnt);
+		return Traits::get(keys[i], strings);
+	}
+	ITEM const& getItem(uint i) const noexcept
+	{
+		assert(i < cnt);
+		return items[i];
+	}
+};
+
+
+// -----------------------------------------------------------------------
+//				   	I M P L E M E N T A T I O N S
+// -----------------------------------------------------------------------
+
+
+template<class KEY, class ITEM>
+const int FrozenHashMap<KEY, ITEM>::free_slot = FREE;
+
+template<class KEY, class ITEM>
+inline str tostr(const FrozenHashMap<KEY, ITEM>& hashmap)
+{
+	// return 1-line description of hashmap for debugging and logging:
+	return usingstr("FrozenHashMap[%u]", hashmap.count());
+}
+
+template<class KEY, class ITEM>
+void FrozenHashMap<KEY, ITEM>::swap(FrozenHashMap& q) noexcept
+{
+	std::swap(image, q.image);
+	std::swap(size, q.size);
+	std::swap(map, q.map);
+	std::swap(hashes, q.hashes);
+	std::swap(keys, q.keys);
+	std::swap(items, q.items);
+	std::swap(strings, q.strings);
+	std::swap(cnt, q.cnt);
+	std::swap(mask, q.mask);
+}
+
+template<class KEY, class ITEM>
+void FrozenHashMap<KEY, ITEM>::write(FD& fd, const HashMap<KEY, ITEM>& q) throws
+{
+	// write frozen image of HashMap q
+	// map[], hashes[] and items[] are written as they are
+	// keys[] are converted to FKEYs, cstr keys are collected in strings[]
+
+	Array<FKEY> fkeys;
+	Array<char> strs;
+	Traits::freeze(q.keys, fkeys, strs);
+
+	uint cnt = q.count();
+	uint32 n = q.mask + 1;
+
+	Header h;
+	memset(&h, 0, sizeof(h));
+	h.magic	   = MAGIC;
+	h.version  = VERSION;
+	h.keysize  = sizeof(FKEY);
+	h.itemsize = sizeof(ITEM);
+	h.count	   = cnt;
+	h.mask	   = q.mask;
+	h.map	   = sizeof(Header);
+	h.hashes   = align(h.map + n * sizeof(int));
+	h.keys	   = align(h.hashes + cnt * sizeof(uint32));
+	h.items	   = align(h.keys + cnt * sizeof(FKEY));
+	h.strings  = align(h.items + cnt * sizeof(ITEM));
+	h.size	   = h.strings + strs.count();
+
+	static const char zero[16] = {0};
+	auto pad = [&fd](uint64 offset) { fd.write_bytes(zero, uint32(align(offset) - offset)); };
+
+	fd.write(h);
+	fd.write_data(q.map, n);
+	pad(h.map + n * sizeof(int));
+	fd.write_data(q.hashes.getData(), cnt);
+	pad(h.hashes + cnt * sizeof(uint32));
+	fd.write_data(fkeys.getData(), cnt);
+	pad(h.keys + cnt * sizeof(FKEY));
+	fd.write_data(q.items.getData(), cnt);
+	pad(h.items + cnt * sizeof(ITEM));
+	fd.write_data(strs.getData(), strs.count());
+}
+
+template<class KEY, class ITEM>
+void FrozenHashMap<KEY, ITEM>::open(cstr path) throws
+{
+	// map the frozen image and check the header
+	// the contents of the sections are not verified
+
+	close();
+
+	FD	   fd(path, 'r');
+	size_t fsize = size_t(fd.file_size());
+	if (fsize < sizeof(Header)) throw DataError("%s: not a FrozenHashMap file", fd.filename());
+
+	void* p = mmap(nullptr, fsize, PROT_READ, MAP_SHARED, fd.file_id(), 0);
+	if (p == MAP_FAILED) throw FileError(fd, errno);
+	image = cptr(p);
+	size  = fsize;
+
+	const Header& h		= *reinterpret_cast<const Header*>(image);
+	uint64		  mapsize = (h.mask + uint64(1)) * sizeof(int);
+	cstr		  error	  = nullptr;
+
+	if (h.magic == BYTESWAPPED_MAGIC) error = "wrong byte order";
+	else if (h.magic != MAGIC || h.version != VERSION) error = "not a FrozenHashMap file";
+	else if (h.keysize != sizeof(FKEY) || h.itemsize != sizeof(ITEM)) error = "wrong key or item size";
+	else if (h.size != fsize) error = "file truncated";
+	else if ((h.mask & (h.mask + 1)) != 0 || h.count > h.mask || h.map != sizeof(Header) ||
+			 h.hashes < h.map + mapsize || h.keys < h.hashes + h.count * sizeof(uint32) ||
+			 h.items < h.keys + h.count * sizeof(FKEY) || h.strings < h.items + h.count * sizeof(ITEM) ||
+			 h.strings > h.size)
+		error = "corrupted header";
+
+	if (error)
+	{
+		close();
+		throw DataError("%s: %s", fd.filename(), error);
+	}
+
+	map		= reinterpret_cast<const int*>(image + h.map);
+	hashes	= reinterpret_cast<const uint32*>(image + h.hashes);
+	keys	= reinterpret_cast<const FKEY*>(image + h.keys);
+	items	= reinterpret_cast<const ITEM*>(image + h.items);
+	strings = image + h.strings;
+	cnt		= h.count;
+	mask	= h.mask;
+}
+
+template<class KEY, class ITEM>
+void FrozenHashMap<KEY, ITEM>::close() noexcept
+{
+	if (image) munmap(ptr(image), size);
+	image	= nullptr;
+	size	= 0;
+	map		= &free_slot;
+	hashes	= nullptr;
+	keys	= nullptr;
+	items	= nullptr;
+	strings = nullptr;
+	cnt		= 0;
+	mask	= 0;
+}
+
+template<class KEY, class ITEM>
+int FrozenHashMap<KEY, ITEM>::indexof(KEY key) const noexcept
+{
+	// search for key
+	// same as HashMap::indexof()
+	// returns index in items[] or -1
+
+	uint32 h   = kio::hash(key);
+	uint   i   = h;
+	int	   idx = map[i & mask];
+	if (idx == FREE) return -1;
+
+	for (;;)
+	{
+		bool fin = idx < 0;
+		idx &= ~BIT31;
+		if (hashes[idx] == h && kio::same(Traits::get(keys[idx], strings), key)) return idx; // found
+		if (fin) return -1; // end of thread => not found
+		idx = map[++i & mask];
+		assert(idx != FREE);
+	}
+}
+
+template<class KEY, class ITEM>
+inline ITEM FrozenHashMap<KEY, ITEM>::get(KEY key, ITEM dflt) const noexcept
+{
+	int idx = indexof(key);
+	return idx == -1 ? dflt : items[idx];
+}
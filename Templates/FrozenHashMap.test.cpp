@@ -0,0 +1,178 @@
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+
+#include "Templates/FrozenHashMap.h"
+#include "doctest/doctest/doctest.h"
+#include "unix/FD.h"
+
+
+static cstr test_path(cstr name) { return usingstr("/tmp/%s_%u", name, uint(getpid())); }
+
+TEST_CASE("FrozenHashMap")
+{
+	SUBCASE("") { logline("●●● %s:", __FILE__); }
+
+	cstr path = test_path("FrozenHashMap.test");
+
+	SUBCASE("uint32 keys")
+	{
+		HashMap<uint32, double> a(8);
+		for (uint32 i = 0; i < 10000; i++) a.add(i * 7, i * 0.5);
+		for (uint32 i = 0; i < 10000; i += 3) a.remove(i * 7); // remove() rearranges the map[]
+		FrozenHashMap<uint32, double>::write(path, a);
+
+		FrozenHashMap<uint32, double> b(path);
+		CHECK(b.is_open());
+		CHECK(b.count() == a.count());
+		uint errors = 0;
+		for (uint32 i = 0; i < 10000; i++)
+		{
+			if (i % 3 == 0) errors += b.contains(i * 7) || b.find(i * 7) != nullptr;
+			else errors += b.get(i * 7) != i * 0.5 || *b.find(i * 7) != i * 0.5;
+		}
+		CHECK(errors == 0);
+		CHECK(b.get(1, -1.0) == -1.0);
+		CHECK(b.get(14, -1.0) == 1.0);
+		CHECK(b[28] == 2.0);
+		for (uint i = 0; i < b.count(); i++) errors += a.get(b.getKey(i)) != b.getItem(i);
+		CHECK(errors == 0);
+	}
+
+	SUBCASE("cstr keys")
+	{
+		HashMap<cstr, uint> a;
+		a.add("A", 2).add("Ccc", 22).add("Bb", 44).add("", 55);
+		FrozenHashMap<cstr, uint>::write(path, a);
+
+		FrozenHashMap<cstr, uint> b(path);
+		CHECK(b.count() == 4);
+		CHECK(b.get("A") == 2);
+		CHECK(b.get("Ccc") == 22);
+		CHECK(b.get(usingstr("%s", "Bb")) == 44); // compared by value
+		CHECK(b.get("") == 55);
+		CHECK(!b.contains("B"));
+		CHECK(b.get("D", 0) == 0);
+		CHECK(eq(b.getKey(1), "Ccc"));
+	}
+
+	SUBCASE("empty map and move")
+	{
+		FrozenHashMap<cstr, uint> a;
+		CHECK(!a.is_open());
+		CHECK(a.count() == 0);
+		CHECK(!a.contains("A"));
+
+		FrozenHashMap<cstr, uint>::write(path, HashMap<cstr, uint>());
+		a.open(path);
+		CHECK(a.is_open());
+		CHECK(a.count() == 0);
+		CHECK(!a.contains("A"));
+
+		HashMap<cstr, uint> h;
+		h.add("A", 1);
+		unlink(path); // a keeps the old file
+		FrozenHashMap<cstr, uint>::write(path, h);
+		FrozenHashMap<cstr, uint> b(path);
+		a = std::move(b);
+		CHECK(a.get("A") == 1);
+		b.close();
+		CHECK(a.get("A") == 1);
+		a.close();
+		CHECK(!a.is_open());
+		CHECK(!a.contains("A"));
+	}
+
+	SUBCASE("wrong files")
+	{
+		using Frozen32_32 = FrozenHashMap<uint32, uint32>;
+		using Frozen32_64 = FrozenHashMap<uint32, uint64>;
+		using Frozen64_32 = FrozenHashMap<uint64, uint32>;
+
+		HashMap<uint32, uint32> a;
+		a.add(1, 2);
+		Frozen32_32::write(path, a);
+
+		CHECK_THROWS_AS(Frozen32_64 {path}, DataError);
+		CHECK_THROWS_AS(Frozen64_32 {path}, DataError);
+
+		{
+			FD fd(path, 'm');
+			fd.write_uint16(0x0A9C); // BYTESWAPPED_MAGIC
+		}
+		CHECK_THROWS_AS(Frozen32_32 {path}, DataError);
+
+		{
+			FD fd(path, 'w');
+			a.serialize(fd); // the stream format is not a frozen image
+			fd.write_bytes(tempstr(100), 100);
+		}
+		CHECK_THROWS_AS(Frozen32_32 {path}, DataError);
+
+		Frozen32_32::write(path, a);
+		{
+			FD fd(path, 'm');
+			fd.resize_file(fd.file_size() - 4);
+		}
+		CHECK_THROWS_AS(Frozen32_32 {path}, DataError);
+		CHECK_THROWS_AS(Frozen32_32 {"/tmp/does/not/exist"}, FileError);
+	}
+
+	unlink(path);
+}
+
+
+TEST_CASE("FrozenHashMap performance test" * doctest::skip(false))
+{
+	// write a HashMap<cstr,uint32> with 1M entries with serialize() and as a frozen image
+	// compare the time until the first lookup and the lookup speed
+
+	static constexpr uint N = 1000000;
+
+	cstr path1 = test_path("FrozenHashMap.serialized");
+	cstr path2 = test_path("FrozenHashMap.frozen");
+
+	TempMemPool tmp;
+	Array<cstr> keys(0u, N);
+	for (uint i = 0; i < N; i++) keys.append(usingstr("%08x/some/path/file_%u.so", uint(random()), i));
+
+	{
+		HashMap<cstr, uint32> map(N);
+		for (uint i = 0; i < N; i++) map.add(keys[i], i);
+		FD fd(path1, 'w');
+		map.serialize(fd);
+		FrozenHashMap<cstr, uint32>::write(path2, map);
+	}
+	keys.shuffle();
+
+	double				  t0 = now();
+	HashMap<cstr, uint32> map1;
+	{
+		FD fd(path1, 'r');
+		map1.deserialize(fd);
+	}
+	double t1 = now();
+	uint32 v1 = map1.get(keys[0]);
+	double t2		= now();
+	uint   errors	= 0;
+	for (uint i = 0; i < N; i++) errors += !map1.contains(keys[i]);
+	double t3 = now();
+
+	FrozenHashMap<cstr, uint32> map2(path2);
+	double						t4 = now();
+	uint32 v2 = map2.get(keys[0]);
+	double t5 = now();
+	CHECK(v1 == v2);
+	for (uint i = 0; i < N; i++) errors += !map2.contains(keys[i]);
+	double t6 = now();
+	CHECK(errors == 0);
+
+	logline("HashMap::deserialize():  load %.3f sec, first lookup %.1f µs, lookup %.1f ns", t1 - t0, (t2 - t1) * 1e6,
+			(t3 - t2) * 1e9 / N);
+	logline("FrozenHashMap::open():   load %.3f sec, first lookup %.1f µs, lookup %.1f ns", t4 - t3, (t5 - t4) * 1e6,
+			(t6 - t5) * 1e9 / N);
+
+	unlink(path1);
+	unlink(path2);
+}
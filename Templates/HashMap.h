@@ -21,7 +21,15 @@
 	The HashMap creator should be passed the expected size of the final map.
 	If the map grows larger then it will be resized on the fly which will take some time.
 	Better be generous because a larger hashmap results in less collisions and therefore faster access;
-	the fixed costs are hashmap.count() * sizeof(int).
+	the fixed costs are hashmap.count() * sizeof(int) plus sizeof(uint32) per item for the cached hash.
+
+	The hash of every key is cached in hashes[] parallel to keys[] and items[]:
+	resizing the map does not need to rehash the keys and
+	a key is only compared with same() if the hashes are equal.
+
+	find_many() and add_many() process an array of keys in a software pipeline to overlap the memory latency:
+	the slot in map[] is prefetched for key i, the entries in keys[] and hashes[] for key i-DIST
+	and key i-2*DIST is resolved. This pays off if the map is larger than the cache.
 
 
 	in map[] sind die indizes der zugehörigen daten in keys/items gespeichert.
@@ -47,23 +55,36 @@
 #endif
 
 
+template<class KEY, class ITEM>
+class FrozenHashMap;
+
+
 template<class KEY, class ITEM>
 class HashMap
 {
+	template<class, class>
+	friend class FrozenHashMap; // writes a frozen image
+
 private:
 	Array<ITEM> items; // stored items
-	Array<KEY>	keys;  // their keys
-	int*		map;   // hash -> index conversion array
-	uint		mask;  // map size -1; map size must be 1<<N
+	Array<KEY>	  keys;	  // their keys
+	Array<uint32> hashes; // their hashes
+	int*		  map;	  // hash -> index conversion array
+	uint		  mask;	  // map size -1; map size must be 1<<N
 
 	static constexpr int	BIT31			  = INT_MIN; // 0x80000000 mask for 'end-of-thread' marker bit
 	static constexpr int	FREE			  = -1;		 // 			  value for free slots in map[] (BIT31 set)
 	static constexpr uint16 MAGIC			  = 0x9C0A;
 	static constexpr uint16 BYTESWAPPED_MAGIC = 0x0A9C;
+	static constexpr uint	DIST			  = 8; // find_many(), add_many(): prefetch distance
 
 private:
 	void clearmap() noexcept { memset(&map[0], -1, (mask + 1) * sizeof(map[0])); }
-	int	 indexof(KEY) const noexcept; // find index in items[]; -1 if not found
+	int	 indexof(KEY key) const noexcept { return indexof(key, kio::hash(key)); } // find index in items[]; -1 if not found
+	int	 indexof(KEY, uint32 hash) const noexcept;
+	void add(KEY, ITEM, uint32 hash) throws;
+	template<typename FN>
+	void prefetch_many(const KEY*, uint n, FN fn) const noexcept(noexcept(fn(0u, 0u))); // calls fn(i,hash)
 	void resizemap(uint) throws;
 
 public:
@@ -127,11 +148,14 @@ public:
 		int i = indexof(key);
 		return i >= 0 ? &items[i] : nullptr;
 	}
+	void find_many(const KEY* keys, uint n, ITEM** items) noexcept; // store find() for n keys in items[]
+	void find_many(const KEY* keys, uint n, ITEM const** items) const noexcept;
 
 	// add / remove items:
 	void	 purge() noexcept;
 	HashMap& add(KEY, ITEM) throws;		// overwrites if key already exists
 	HashMap& add_new(KEY, ITEM) throws; // key must be new
+	HashMap& add_many(const KEY* keys, const ITEM* items, uint n) throws; // overwrites existing keys
 	void	 remove(KEY) noexcept;		// silently does nothing if key does not exist
 
 	// misc:
@@ -163,12 +187,13 @@ inline void HashMap<KEY, ITEM>::swap(HashMap<KEY, ITEM>& a, HashMap<KEY, ITEM>&
 {
 	std::swap(a.items, b.items);
 	std::swap(a.keys, b.keys);
+	std::swap(a.hashes, b.hashes);
 	std::swap(a.map, b.map);
 	std::swap(a.mask, b.mask);
 }
 
 template<class KEY, class ITEM>
-HashMap<KEY, ITEM>::HashMap(uint max) throws : items(), keys(), map(nullptr), mask(0)
+HashMap<KEY, ITEM>::HashMap(uint max) throws : items(), keys(), hashes(), map(nullptr), mask(0)
 {
 	// create HashMap with preallocated items[] and initial map[] size
 	// there will be no reallocation of items[] and  no reallocation and reindexing of map[] up to max items
@@ -184,12 +209,14 @@ HashMap<KEY, ITEM>::HashMap(uint max) throws : items(), keys(), map(nullptr), ma
 
 	items.grow(0, max);
 	keys.grow(0, max);
+	hashes.grow(0, max);
 }
 
 template<class KEY, class ITEM>
 HashMap<KEY, ITEM>::HashMap(HashMap&& q) noexcept :
 	items(std::move(q.items)),
 	keys(std::move(q.keys)),
+	hashes(std::move(q.hashes)),
 	map(q.map),
 	mask(q.mask)
 {
@@ -200,12 +227,13 @@ HashMap<KEY, ITEM>::HashMap(HashMap&& q) noexcept :
 }
 
 template<class KEY, class ITEM>
-HashMap<KEY, ITEM>::HashMap(const HashMap& q) throws : items(), keys(), map(nullptr), mask(0)
+HashMap<KEY, ITEM>::HashMap(const HashMap& q) throws : items(), keys(), hashes(), map(nullptr), mask(0)
 {
-	items = q.items;
-	keys  = q.keys;
-	map	  = new int[q.mask + 1];
-	mask  = q.mask;
+	items  = q.items;
+	keys   = q.keys;
+	hashes = q.hashes;
+	map	   = new int[q.mask + 1];
+	mask   = q.mask;
 	memcpy(&map[0], &q.map[0], (mask + 1) * sizeof(map[0]));
 }
 
@@ -243,6 +271,7 @@ void HashMap<KEY, ITEM>::purge() noexcept
 
 	items.purge();
 	keys.purge();
+	hashes.purge();
 	clearmap();
 }
 
@@ -266,27 +295,27 @@ void HashMap<KEY, ITEM>::resizemap(uint newsize) throws
 	// put all items back into map:
 	for (uint idx = 0, e = items.count(); idx < e; idx++)
 	{
-		uint i = kio::hash(keys[idx]);
+		uint i = hashes[idx];
 		while (map[i & mask] != FREE) map[i++ & mask] &= ~BIT31; // clear end-of-thread marker on this index
 		map[i & mask] = idx + BIT31;							 // store index, set end-of-thread marker
 	}
 }
 
 template<class KEY, class ITEM>
-int HashMap<KEY, ITEM>::indexof(KEY key) const noexcept // search key by value
+int HashMap<KEY, ITEM>::indexof(KEY key, uint32 h) const noexcept // search key by value
 {
-	// search for key
+	// search for key with hash h
 	// returns index in items[] or -1
 
-	uint i	 = kio::hash(key);
-	int	 idx = map[i & mask];
+	uint   i   = h;
+	int	   idx = map[i & mask];
 	if (idx == FREE) return -1;
 
 	for (;;)
 	{
 		bool fin = idx < 0;
 		idx &= ~BIT31;
-		if (kio::same(keys[idx], key)) return idx; // found
+		if (hashes[idx] == h && kio::same(keys[idx], key)) return idx; // found
 		if (fin) return -1;						   // end of thread => not found
 		idx = map[++i & mask];
 		assert(idx != FREE);
@@ -299,22 +328,32 @@ HashMap<KEY, ITEM>& HashMap<KEY, ITEM>::add(KEY key, ITEM item) throws
 	// add item for key
 	// if key alredy exists, then overwrite
 
+	add(key, std::move(item), kio::hash(key));
+	return *this;
+}
+
+template<class KEY, class ITEM>
+void HashMap<KEY, ITEM>::add(KEY key, ITEM item, uint32 h) throws
+{
+	// add item for key with hash h
+	// if key alredy exists, then overwrite
+
 a:
-	uint mask = this->mask;		// for rapid access
-	uint i	  = kio::hash(key); // i = index in map[]
-	int	 idx  = map[i & mask];	// idx = index in items[]
-	if (idx == FREE) goto b;	// map[i] is free => quick action!
+	uint mask = this->mask;	   // for rapid access
+	uint i	  = h;			   // i = index in map[]
+	int	 idx  = map[i & mask]; // idx = index in items[]
+	if (idx == FREE) goto b;   // map[i] is free => quick action!
 
 	// search for existing key:
 	for (;;)
 	{
 		bool fin = idx < 0;
 		idx &= ~BIT31;
-		if (kio::same(keys[idx], key)) // key exists => overwrite & exit:
+		if (hashes[idx] == h && kio::same(keys[idx], key)) // key exists => overwrite & exit:
 		{
 			items[idx] = std::move(item); // overwrite item at idx
 			keys[idx]  = key; // also overwrite key, if KEY==cstr then the key may be kept alive by it's item
-			return *this;
+			return;
 		}
 		if (fin) break;		   // no more chances: key does not yet exist
 		idx = map[++i & mask]; // inspect next map[i] / items[idx]
@@ -345,8 +384,7 @@ b:
 	map[i & mask] = items.count() + BIT31; // store index, set end-of-thread marker
 	items.append(std::move(item));		   // store item at index
 	keys.append(key);					   // store key at index
-
-	return *this;
+	hashes.append(h);					   // store hash at index
 }
 
 template<class KEY, class ITEM>
@@ -357,11 +395,13 @@ HashMap<KEY, ITEM>& HashMap<KEY, ITEM>::add_new(KEY key, ITEM item) throws
 
 	assert(!contains(key));
 
+	uint32 h = kio::hash(key);
+
 a:
-	uint mask = this->mask;		// for rapid access
-	uint i	  = kio::hash(key); // i = index in map[]
-	int	 idx  = map[i & mask];	// idx = index in items[]
-	if (idx == FREE) goto b;	// map[i] is free => quick action!
+	uint mask = this->mask;	   // for rapid access
+	uint i	  = h;			   // i = index in map[]
+	int	 idx  = map[i & mask]; // idx = index in items[]
+	if (idx == FREE) goto b;   // map[i] is free => quick action!
 
 	// check whether it's time to grow the map[]:
 	if (items.count() * 2 > mask)
@@ -387,10 +427,92 @@ b:
 	map[i & mask] = items.count() + BIT31; // store index, set end-of-thread marker
 	items.append(std::move(item));		   // store item at index
 	keys.append(key);					   // store key at index
+	hashes.append(h);					   // store hash at index
 
 	return *this;
 }
 
+template<class KEY, class ITEM>
+template<typename FN>
+void HashMap<KEY, ITEM>::prefetch_many(const KEY* keys, uint n, FN fn) const noexcept(noexcept(fn(0u, 0u)))
+{
+	// calculate the hashes of n keys and call fn(i,hash) for each key in a software pipeline:
+	// the slot in map[] is prefetched for key i,
+	// the first entry of the thread in keys[] and hashes[] is prefetched for key i-DIST,
+	// and fn() is called for key i-2*DIST.
+	// so the memory accesses for 2*DIST keys are in flight at the same time.
+	// map[] must not be resized by fn(). other modifications of map[] only make a prefetch useless.
+
+	static_assert((DIST & (DIST - 1)) == 0, "DIST must be a power of 2");
+	uint32 h[4 * DIST]; // ring buffer
+
+	for (uint i = 0; i < n + 2 * DIST; i++)
+	{
+		if (i < n)
+		{
+			uint32 hash		   = kio::hash(keys[i]);
+			h[i % (4 * DIST)] = hash;
+			__builtin_prefetch(map + (hash & mask));
+		}
+
+		uint k = i - DIST; // wraps around for i < DIST
+		if (k < n)
+		{
+			int idx = map[h[k % (4 * DIST)] & mask];
+			if (idx != FREE)
+			{
+				idx &= ~BIT31;
+				__builtin_prefetch(hashes.getData() + idx);
+				__builtin_prefetch(this->keys.getData() + idx);
+			}
+		}
+
+		k = i - 2 * DIST;
+		if (k < n) fn(k, h[k % (4 * DIST)]);
+	}
+}
+
+template<class KEY, class ITEM>
+void HashMap<KEY, ITEM>::find_many(const KEY* keys, uint n, ITEM** z) noexcept
+{
+	// search n keys and store pointers to their items or nullptr in z[]
+	// same as find() but the memory accesses for multiple keys overlap
+
+	prefetch_many(keys, n, [this, keys, z](uint i, uint32 h) noexcept {
+		int idx = indexof(keys[i], h);
+		z[i]	= idx >= 0 ? &items[uint(idx)] : nullptr;
+	});
+}
+
+template<class KEY, class ITEM>
+void HashMap<KEY, ITEM>::find_many(const KEY* keys, uint n, ITEM const** z) const noexcept
+{
+	prefetch_many(keys, n, [this, keys, z](uint i, uint32 h) noexcept {
+		int idx = indexof(keys[i], h);
+		z[i]	= idx >= 0 ? &items[uint(idx)] : nullptr;
+	});
+}
+
+template<class KEY, class ITEM>
+HashMap<KEY, ITEM>& HashMap<KEY, ITEM>::add_many(const KEY* keys, const ITEM* items, uint n) throws
+{
+	// add n items for keys
+	// same as add() but the memory accesses for multiple keys overlap
+	// map[] and the arrays are resized in advance for the case that all keys are new:
+	// then map[] is not resized while the pipeline is running
+
+	uint max = this->items.count() + n;
+	assert(max <= maxCount);
+
+	if (max * 2 > mask) resizemap(4u << msbit(max - 1)); // mapsize = 2 * max!
+	this->items.growmax(max);
+	this->keys.growmax(max);
+	hashes.growmax(max);
+
+	prefetch_many(keys, n, [this, keys, items](uint i, uint32 h) { add(keys[i], items[i], h); });
+	return *this;
+}
+
 template<class KEY, class ITEM>
 void HashMap<KEY, ITEM>::remove(KEY key) noexcept // search key by value
 {
@@ -401,17 +523,18 @@ void HashMap<KEY, ITEM>::remove(KEY key) noexcept // search key by value
 	bool fin;
 	int	 idx;
 
-	uint i = kio::hash(key); // i = index in map[]
-	idx	   = map[i & mask];	 // idx = index in items[]
-	if (idx == FREE) return; // not found
+	uint32 h = kio::hash(key);
+	uint   i = h;			  // i = index in map[]
+	idx		 = map[i & mask]; // idx = index in items[]
+	if (idx == FREE) return;  // not found
 
 	for (;;)
 	{
-		fin = idx < 0;						  // end-of-thread marker
-		idx &= ~BIT31;						  // real index
-		if (kio::same(keys[idx], key)) break; // item found at map[i] / items[idx]
-		if (fin) return;					  // end of thread => not found
-		idx = map[++i & mask];				  // next i / idx
+		fin = idx < 0;											  // end-of-thread marker
+		idx &= ~BIT31;											  // real index
+		if (hashes[idx] == h && kio::same(keys[idx], key)) break; // item found at map[i] / items[idx]
+		if (fin) return;										  // end of thread => not found
+		idx = map[++i & mask];									  // next i / idx
 	}
 
 	// item has been found at map[i] / items[idx]:
@@ -422,7 +545,7 @@ void HashMap<KEY, ITEM>::remove(KEY key) noexcept // search key by value
 	if (idx != idx2)
 	{
 		// find index i2 in map[] for moved item:
-		uint i2 = kio::hash(keys[idx2]); // i2 = index in map[]
+		uint i2 = hashes[idx2]; // i2 = index in map[]
 		for (;; ++i2)
 		{
 			//assert(map[i2&mask] != FREE);
@@ -432,11 +555,13 @@ void HashMap<KEY, ITEM>::remove(KEY key) noexcept // search key by value
 
 		// move item and point map[i2] to new location:
 		items[idx] = std::move(items[idx2]);
-		keys[idx]  = keys[idx2];
+		keys[idx]	= keys[idx2];
+		hashes[idx] = hashes[idx2];
 		map[i2 & mask] += idx - idx2; // keep bit31
 	}
 	items.drop();
 	keys.drop();
+	hashes.drop();
 
 	// map[i] is a free slot
 	// fin tells whether map[i] is at the end of the thread
@@ -450,7 +575,7 @@ void HashMap<KEY, ITEM>::remove(KEY key) noexcept // search key by value
 		fin = idx < 0; // update fin for j
 		idx &= ~BIT31;
 
-		uint j0 = kio::hash(keys[idx]); // j0 = nominal position of j in map[]
+		uint j0 = hashes[idx]; // j0 = nominal position of j in map[]
 		if (j == j0) continue;			// on it's nominal position
 
 		if (((j - j0) & mask) >= ((j - i) & mask)) // j0<=i ?
@@ -499,6 +624,11 @@ void HashMap<KEY, TYPE>::deserialize(FD& fd, void* data) throws
 	keys.deserialize(fd, data);
 	if (items.count() != keys.count()) throw DataError("HashMap<T,U>: key/item mismatch");
 
+	// the hashes are not part of the file format:
+	hashes.purge();
+	hashes.grow(0, keys.count());
+	for (uint i = 0; i < keys.count(); i++) { hashes.append(kio::hash(keys[i])); }
+
 	uint mapsize = items.count() < 8 ? 16 : 4u << msbit(items.count() - 1); // mapsize = 2 * max!
 	resizemap(mapsize);
 }
@@ -4,6 +4,7 @@
 
 
 #include "Templates/HashMap.h"
+#include "Templates/FlatHashMap.h"
 #include "Templates/Array.h"
 #include "doctest/doctest/doctest.h"
 #include "unix/FD.h"
@@ -205,6 +206,62 @@ TEST_CASE("HashMap")
 		CHECK(eq(fd.read_str(), usingstr("  •[ 2] [#%8x] \"Bbb\" = 44", kio::sdbm_hash("Bbb"))));
 		CHECK(fd.read_char() == 'X');
 	}
+
+	SUBCASE("add_many(), find_many()")
+	{
+		// more keys than fit in the prefetch pipeline
+		// the map is resized by add_many() and some keys are added twice
+
+		Array<int> keys, items;
+		for (int i = 0; i < 999; i++) { keys << i * 7 << i * 7 + 3; }
+		for (int i = 0; i < 999; i++) { items << i * 11 << i * 11 + 1; }
+		keys << 21 << 35;
+		items << 99 << 88;
+
+		HashMap<int, int> map(8);
+		map.add(0, 1);
+		map.add_many(keys.getData(), items.getData(), keys.count());
+		CHECK(map.count() == 999 * 2);
+		CHECK(map[0] == 0);
+		CHECK(map[21] == 99);
+		CHECK(map[35] == 88);
+		CHECK(map[14] == 22);
+		CHECK(map[17] == 23);
+
+		Array<int> q;
+		for (int i = 0; i < 999 * 7 + 5; i++) q << i;
+		Array<int*> z(q.count());
+		map.find_many(q.getData(), q.count(), z.getData());
+		for (int i = 0; i < 999 * 7 + 5; i++)
+		{
+			int* p = map.find(i);
+			CHECK(z[i] == p);
+			CHECK((p != nullptr) == (i < 999 * 7 && (i % 7 == 0 || i % 7 == 3)));
+		}
+
+		const HashMap<int, int>& cmap = map;
+		Array<const int*>		 cz(q.count());
+		cmap.find_many(q.getData(), q.count(), cz.getData());
+		for (uint i = 0; i < q.count(); i++) CHECK(cz[i] == z[i]);
+	}
+
+	SUBCASE("add_many(), find_many() with cstr keys")
+	{
+		cstr keys[]	 = {"Aaa", "Ccc", "Bbb", "Ddd", "Aaa"};
+		uint items[] = {1, 2, 3, 4, 5};
+
+		HashMap<cstr, uint> map;
+		map.add_many(keys, items, 5);
+		CHECK(map.count() == 4);
+
+		cstr  q[] = {"Bbb", "Eee", "Aaa", ""};
+		uint* z[4];
+		map.find_many(q, 4, z);
+		CHECK(z[0] && *z[0] == 3);
+		CHECK(z[1] == nullptr);
+		CHECK(z[2] && *z[2] == 5);
+		CHECK(z[3] == nullptr);
+	}
 }
 
 TEST_CASE("HashMap stress test")
@@ -337,3 +394,205 @@ TEST_CASE("HashMap cstr key test:")
 	for (uint i = 0; i < a.count(); i++) CHECK(map.contains(a[i]));
 	for (uint i = 0; i < r.count(); i++) CHECK(!map.contains(r[i]));
 }
+
+
+template<typename MAP, typename KEY>
+static double time_lookups(const MAP& map, const Array<KEY>& keys, uint& found)
+{
+	double t0 = now();
+	for (uint i = 0; i < keys.count(); i++) { found += map.contains(keys[i]); }
+	return now() - t0;
+}
+
+TEST_CASE("HashMap vs FlatHashMap performance test" * doctest::skip(false))
+{
+	static const uint N = 1000000;
+
+	SUBCASE("uint32 keys")
+	{
+		Array<uint32> hits(0u, N), misses(0u, N);
+		for (uint i = 0; i < N; i++) { hits.append(uint32(random()) | 1); }
+		for (uint i = 0; i < N; i++) { misses.append(uint32(random()) & ~1u); }
+
+		HashMap<uint32, uint32>		map1;
+		FlatHashMap<uint32, uint32> map2;
+		double						t1 = now();
+		for (uint i = 0; i < N; i++) { map1.add(hits[i], i); }
+		double t2 = now();
+		for (uint i = 0; i < N; i++) { map2.add(hits[i], i); }
+		double t3 = now();
+		CHECK(map1.count() == map2.count());
+
+		hits.shuffle();
+		uint   found1 = 0, found2 = 0;
+		double h1 = time_lookups(map1, hits, found1), h2 = time_lookups(map2, hits, found2);
+		CHECK(found1 == N);
+		CHECK(found2 == N);
+		double m1 = time_lookups(map1, misses, found1), m2 = time_lookups(map2, misses, found2);
+		CHECK(found1 == N);
+		CHECK(found2 == N);
+
+		logline("HashMap<uint32>:     add %.1f ns, hit %.1f ns, miss %.1f ns", (t2 - t1) * 1e9 / N, h1 * 1e9 / N,
+				m1 * 1e9 / N);
+		logline("FlatHashMap<uint32>: add %.1f ns, hit %.1f ns, miss %.1f ns", (t3 - t2) * 1e9 / N, h2 * 1e9 / N,
+				m2 * 1e9 / N);
+	}
+
+	SUBCASE("cstr keys")
+	{
+		static const uint M = N / 4;
+		Array<cstr>		  hits(0u, M), misses(0u, M);
+		for (uint i = 0; i < M; i++) { hits.append(newcopy(usingstr("hit/%08x/%u", uint(random()), i))); }
+		for (uint i = 0; i < M; i++) { misses.append(newcopy(usingstr("miss/%08x/%u", uint(random()), i))); }
+
+		HashMap<cstr, uint>		map1;
+		FlatHashMap<cstr, uint> map2;
+		double					t1 = now();
+		for (uint i = 0; i < M; i++) { map1.add(hits[i], i); }
+		double t2 = now();
+		for (uint i = 0; i < M; i++) { map2.add(hits[i], i); }
+		double t3 = now();
+		CHECK(map1.count() == map2.count());
+
+		hits.shuffle();
+		uint   found1 = 0, found2 = 0;
+		double h1 = time_lookups(map1, hits, found1), h2 = time_lookups(map2, hits, found2);
+		CHECK(found1 == M);
+		CHECK(found2 == M);
+		double m1 = time_lookups(map1, misses, found1), m2 = time_lookups(map2, misses, found2);
+		CHECK(found1 == M);
+		CHECK(found2 == M);
+
+		logline("HashMap<cstr>:       add %.1f ns, hit %.1f ns, miss %.1f ns", (t2 - t1) * 1e9 / M, h1 * 1e9 / M,
+				m1 * 1e9 / M);
+		logline("FlatHashMap<cstr>:   add %.1f ns, hit %.1f ns, miss %.1f ns", (t3 - t2) * 1e9 / M, h2 * 1e9 / M,
+				m2 * 1e9 / M);
+
+		for (uint i = 0; i < M; i++) { delete[] hits[i]; }
+		for (uint i = 0; i < M; i++) { delete[] misses[i]; }
+	}
+}
+
+template<typename KEY>
+static void time_growth_and_lookups(cstr name, const Array<KEY>& hits, const Array<KEY>& misses)
+{
+	// growth = time for adding all keys starting with a tiny map minus time with a presized map
+
+	uint N = hits.count();
+
+	double			   t0 = now();
+	HashMap<KEY, uint> map1(8);
+	for (uint i = 0; i < N; i++) { map1.add(hits[i], i); }
+	double			   t1 = now();
+	HashMap<KEY, uint> map2(N);
+	for (uint i = 0; i < N; i++) { map2.add(hits[i], i); }
+	double t2 = now();
+
+	uint   found = 0;
+	double h	 = time_lookups(map1, hits, found);
+	CHECK(found == N);
+	double m = time_lookups(map1, misses, found);
+	CHECK(found == N);
+
+	logline("HashMap<%s>: add %.1f ns, growth %.1f ns, hit %.1f ns, miss %.1f ns", name, (t2 - t1) * 1e9 / N,
+			(t1 - t0 - (t2 - t1)) * 1e9 / N, h * 1e9 / N, m * 1e9 / N);
+}
+
+TEST_CASE("HashMap growth performance test" * doctest::skip(false))
+{
+	static const uint N = 1000000;
+
+	SUBCASE("uint64 keys")
+	{
+		Array<uint64> hits(0u, N), misses(0u, N);
+		for (uint i = 0; i < N; i++) { hits.append((uint64(random()) << 32) + uint(random()) * 2 + 1); }
+		for (uint i = 0; i < N; i++) { misses.append((uint64(random()) << 32) + uint(random()) * 2); }
+		time_growth_and_lookups("uint64", hits, misses);
+	}
+
+	SUBCASE("cstr keys")
+	{
+		Array<cstr> hits(0u, N), misses(0u, N);
+		for (uint i = 0; i < N; i++) { hits.append(newcopy(usingstr("some/path/%08x/%u", uint(random()), i))); }
+		for (uint i = 0; i < N; i++) { misses.append(newcopy(usingstr("some/path/%08x/%u.", uint(random()), i))); }
+		time_growth_and_lookups("cstr", hits, misses);
+		for (uint i = 0; i < N; i++) { delete[] hits[i]; }
+		for (uint i = 0; i < N; i++) { delete[] misses[i]; }
+	}
+}
+
+template<typename KEY>
+static void time_add_many_and_find_many(cstr name, Array<KEY>& keys, const Array<KEY>& misses)
+{
+	uint		N = keys.count();
+	Array<uint> items(0u, N);
+	for (uint i = 0; i < N; i++) { items.append(i); }
+
+	double			   t0 = now();
+	HashMap<KEY, uint> map1(N);
+	for (uint i = 0; i < N; i++) { map1.add(keys[i], items[i]); }
+	double			   t1 = now();
+	HashMap<KEY, uint> map2(N);
+	map2.add_many(keys.getData(), items.getData(), N);
+	double t2 = now();
+	CHECK(map1 == map2);
+
+	// lookups in random order, every other key is a miss:
+	keys.shuffle();
+	for (uint i = 0; i < N; i += 2) { keys[i] = misses[i]; }
+
+	uint64 s1 = 0, s2 = 0;
+	double t3 = now();
+	for (uint i = 0; i < N; i++)
+	{
+		const uint* p = map1.find(keys[i]);
+		if (p) s1 += *p;
+	}
+	double t4 = now();
+
+	static const uint M = 1024;
+	uint*			  z[M];
+	for (uint i = 0; i < N; i += M)
+	{
+		map1.find_many(keys.getData() + i, min(M, N - i), z);
+		for (uint j = 0; j < min(M, N - i); j++)
+			if (z[j]) s2 += *z[j];
+	}
+	double t5 = now();
+	CHECK(s1 == s2);
+
+	logline("HashMap<%s>: add %.1f ns, add_many %.1f ns, find %.1f ns, find_many %.1f ns", name, (t1 - t0) * 1e9 / N,
+			(t2 - t1) * 1e9 / N, (t4 - t3) * 1e9 / N, (t5 - t4) * 1e9 / N);
+}
+
+TEST_CASE("HashMap find_many() performance test" * doctest::skip(true))
+{
+	// maps larger than the last level cache
+
+	SUBCASE("uint64 keys")
+	{
+		// map[] = 128 MB, keys[] = 128 MB, hashes[] = 64 MB
+
+		static const uint N = 16 << 20;
+
+		Array<uint64> hits(0u, N), misses(0u, N);
+		for (uint i = 0; i < N; i++) { hits.append((uint64(random()) << 32) + uint(random()) * 2 + 1); }
+		for (uint i = 0; i < N; i++) { misses.append((uint64(random()) << 32) + uint(random()) * 2); }
+		time_add_many_and_find_many("uint64", hits, misses);
+	}
+
+	SUBCASE("cstr keys")
+	{
+		// map[] = 32 MB, keys[] = 32 MB, hashes[] = 16 MB, strings ≈ 128 MB
+
+		static const uint N = 4 << 20;
+
+		Array<cstr> hits(0u, N), misses(0u, N);
+		for (uint i = 0; i < N; i++) { hits.append(newcopy(usingstr("some/path/%08x/%u", uint(random()), i))); }
+		for (uint i = 0; i < N; i++) { misses.append(newcopy(usingstr("some/path/%08x/%u.", uint(random()), i))); }
+		Array<cstr> keys(hits);
+		time_add_many_and_find_many("cstr", keys, misses);
+		for (uint i = 0; i < N; i++) { delete[] hits[i]; }
+		for (uint i = 0; i < N; i++) { delete[] misses[i]; }
+	}
+}
@@ -0,0 +1,154 @@
+#pragma once
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+//#include "kio/kio.h"
+#include <atomic>
+#include <thread>
+typedef unsigned int uint;
+
+
+namespace kio
+{
+
+/**
+ *  This template class provides a bounded queue to connect multiple writer threads with multiple reader threads.
+ *  Same API as Queue<T,SIZE>, plus try_put() and try_get().
+ *  All threads can access the queue without a mutex.
+ *
+ *  Every slot has a sequence number which tells whether the slot can be written or read in the current round:
+ *    seq == pos		slot is free for the writer which claims position pos
+ *    seq == pos+1	slot holds data for the reader which claims position pos
+ *  a reader sets seq = pos+SIZE after reading, which makes it free for the writer in the next round.
+ *  Writers claim a position by incrementing wp, readers by incrementing rp, with a CAS.
+ *
+ *  rp, wp and every slot are in separate cache lines so that writers and readers don't share cache lines.
+ *  Note: for C++14 the queue must not be allocated with new, because new ignores alignas(64).
+ *  (it still works but cache lines may be shared.)
+ */
+template<typename T, uint SIZE>
+class MPMCQueue
+{
+	static const uint MASK = SIZE - 1;
+	static_assert(SIZE > 1 && (SIZE & MASK) == 0, "size must be a power of 2");
+
+protected:
+	struct alignas(64) Slot
+	{
+		std::atomic<uint> seq;
+		T				  data;
+	};
+
+	alignas(64) std::atomic<uint> rp {0}; // next position to read
+	alignas(64) std::atomic<uint> wp {0}; // next position to write
+	Slot buffer[SIZE];
+
+public:
+	MPMCQueue() noexcept
+	{
+		for (uint i = 0; i < SIZE; i++) { buffer[i].seq.store(i, std::memory_order_relaxed); }
+	}
+	~MPMCQueue() = default;
+
+	// note: the result of avail() and free() may be outdated immediately if other threads access the queue
+	uint avail() const noexcept
+	{
+		uint n = wp.load(std::memory_order_acquire) - rp.load(std::memory_order_acquire);
+		return int(n) < 0 ? 0 : n > SIZE ? SIZE : n;
+	}
+	uint free() const noexcept { return SIZE - avail(); }
+
+	bool try_put(T&& c) noexcept; // false if queue is full
+	bool try_put(const T& c) noexcept
+	{
+		T t(c);
+		return try_put(std::move(t));
+	}
+	bool try_get(T& c) noexcept; // false if queue is empty
+
+	// put() and get() wait until the queue is not full or not empty:
+	void put(T&& c) noexcept
+	{
+		while (!try_put(std::move(c))) { std::this_thread::yield(); }
+	}
+	void put(const T& c) noexcept
+	{
+		T t(c);
+		put(std::move(t));
+	}
+	T get() noexcept
+	{
+		T c;
+		while (!try_get(c)) { std::this_thread::yield(); }
+		return c;
+	}
+
+	// read() and write() return the number of items actually transferred.
+	// other threads may read or write concurrently, so the items may not be adjacent in the queue.
+	uint read(T* z, uint n) noexcept
+	{
+		uint i = 0;
+		while (i < n && try_get(z[i])) i++;
+		return i;
+	}
+	uint write(const T* q, uint n) noexcept
+	{
+		uint i = 0;
+		while (i < n && try_put(q[i])) i++;
+		return i;
+	}
+};
+
+
+template<typename T, uint SIZE>
+bool MPMCQueue<T, SIZE>::try_put(T&& c) noexcept
+{
+	uint pos = wp.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		Slot& slot = buffer[pos & MASK];
+		uint  seq  = slot.seq.load(std::memory_order_acquire);
+		int	  diff = int(seq - pos);
+
+		if (diff == 0) // slot is free in this round => try to claim it:
+		{
+			if (wp.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+			{
+				slot.data = std::move(c);
+				slot.seq.store(pos + 1, std::memory_order_release);
+				return true;
+			}
+			// else pos was updated by compare_exchange_weak()
+		}
+		else if (diff < 0) return false; // slot not yet read in previous round => queue full
+		else pos = wp.load(std::memory_order_relaxed); // another writer was faster
+	}
+}
+
+template<typename T, uint SIZE>
+bool MPMCQueue<T, SIZE>::try_get(T& c) noexcept
+{
+	uint pos = rp.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		Slot& slot = buffer[pos & MASK];
+		uint  seq  = slot.seq.load(std::memory_order_acquire);
+		int	  diff = int(seq - (pos + 1));
+
+		if (diff == 0) // slot holds data for this round => try to claim it:
+		{
+			if (rp.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+			{
+				c = std::move(slot.data);
+				slot.seq.store(pos + SIZE, std::memory_order_release);
+				return true;
+			}
+			// else pos was updated by compare_exchange_weak()
+		}
+		else if (diff < 0) return false; // slot not yet written in this round => queue empty
+		else pos = rp.load(std::memory_order_relaxed); // another reader was faster
+	}
+}
+
+} // namespace kio
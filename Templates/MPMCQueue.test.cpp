@@ -0,0 +1,164 @@
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+
+#include "kio/kio.h"
+
+#include "Templates/MPMCQueue.h"
+#include "Templates/Queue.h"
+#include "cpp/cppthreads.h"
+#include "doctest/doctest/doctest.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace kio;
+
+
+TEST_CASE("MPMCQueue")
+{
+	SUBCASE("") { logline("●●● %s:", __FILE__); }
+
+	SUBCASE("single thread")
+	{
+		static MPMCQueue<uint, 8> q;
+		CHECK(q.avail() == 0);
+		CHECK(q.free() == 8);
+
+		uint n = 0;
+		CHECK(!q.try_get(n));
+		for (uint i = 0; i < 8; i++) CHECK(q.try_put(i + 10));
+		CHECK(!q.try_put(99u));
+		CHECK(q.avail() == 8);
+		CHECK(q.free() == 0);
+
+		CHECK(q.get() == 10);
+		CHECK(q.try_get(n));
+		CHECK(n == 11);
+		CHECK(q.avail() == 6);
+		q.put(18);
+		q.put(19);
+		CHECK(!q.try_put(99u));
+
+		uint bu[10];
+		CHECK(q.read(bu, 10) == 8);
+		for (uint i = 0; i < 8; i++) CHECK(bu[i] == i + 12);
+		CHECK(q.avail() == 0);
+
+		// wrap around many times:
+		for (uint i = 0; i < 100; i++)
+		{
+			for (uint j = 0; j < 5; j++) bu[j] = i + j;
+			CHECK(q.write(bu, 5) == 5);
+			CHECK(q.read(bu + 5, 5) == 5);
+			CHECK_UNARY(bu[5] == i && bu[9] == i + 4);
+		}
+		CHECK(q.avail() == 0);
+		CHECK(q.write(bu, 10) == 8);
+		CHECK(q.avail() == 8);
+		CHECK(q.read(bu, 3) == 3);
+		CHECK(q.write(bu, 5) == 3);
+	}
+
+	SUBCASE("4 writers, 4 readers")
+	{
+		// every writer writes N distinct values
+		// every value must be read exactly once
+
+		static constexpr uint N = 100000, T = 4;
+		static MPMCQueue<uint, 64> q;
+
+		std::atomic<uint64>		 sum {0};
+		std::atomic<uint>		 cnt {0};
+		std::vector<std::thread> threads;
+		for (uint t = 0; t < T; t++)
+		{
+			threads.emplace_back([t] {
+				for (uint i = 0; i < N; i++) q.put(t * N + i);
+			});
+			threads.emplace_back([&sum, &cnt] {
+				uint64 s = 0;
+				for (uint i = 0; i < N; i++) s += q.get();
+				sum += s;
+				cnt += N;
+			});
+		}
+		for (std::thread& thread : threads) thread.join();
+
+		CHECK(cnt == T * N);
+		CHECK(sum == uint64(T * N) * (T * N - 1) / 2);
+		CHECK(q.avail() == 0);
+	}
+}
+
+
+template<typename QUEUE>
+static double time_queue(QUEUE& q, uint writers, uint readers, uint n)
+{
+	// n items are distributed to the writers and readers
+	// returns million items per second
+
+	std::vector<std::thread> threads;
+	double					 t0 = now();
+	for (uint t = 0; t < writers; t++)
+	{
+		threads.emplace_back([&q, n, writers] {
+			for (uint i = 0; i < n / writers; i++) q.put(i);
+		});
+	}
+	for (uint t = 0; t < readers; t++)
+	{
+		threads.emplace_back([&q, n, readers] {
+			for (uint i = 0; i < n / readers; i++) q.get();
+		});
+	}
+	for (std::thread& thread : threads) thread.join();
+	return n / (now() - t0) / 1e6;
+}
+
+template<typename T, uint SIZE>
+class LockedQueue // a Queue with a PLock for comparison
+{
+	Queue<T, SIZE> q;
+	PLock		   lock;
+
+public:
+	void put(T c)
+	{
+		for (;;)
+		{
+			{
+				PLocker<PLock> _(lock);
+				if (q.free()) return q.put(std::move(c));
+			}
+			std::this_thread::yield();
+		}
+	}
+	T get()
+	{
+		for (;;)
+		{
+			{
+				PLocker<PLock> _(lock);
+				if (q.avail()) return q.get();
+			}
+			std::this_thread::yield();
+		}
+	}
+};
+
+TEST_CASE("MPMCQueue performance test" * doctest::skip(false))
+{
+	static constexpr uint N = 1 << 20;
+
+	static MPMCQueue<uint, 1024>   q1;
+	static LockedQueue<uint, 1024> q2;
+
+	for (uint threads : {1u, 2u, 4u})
+	{
+		double mips1 = time_queue(q1, threads, threads, N);
+		double mips2 = time_queue(q2, threads, threads, N);
+		logline("%u writers, %u readers: MPMCQueue %6.2f M/s, Queue+PLock %6.2f M/s", threads, threads, mips1, mips2);
+	}
+}
@@ -0,0 +1,389 @@
+#pragma once
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+#include "kio/kio.h"
+#include "sort.h"
+#include "unix/FD.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <type_traits>
+#include <unistd.h>
+
+
+/*	MappedArray<T> is an array of trivially copyable items in a memory mapped file:
+
+	- the size is only limited by the address space and the disk, not by ArrayMAX or the RAM
+	- reopening the file gives instant access to the data: no parsing, pages are loaded on demand
+	- the pages are written back by the OS. sync() makes a checkpoint.
+	- advise() passes access hints to the OS.
+
+	the file starts with a 64 byte header: magic, version, sizeof(T) and the item count.
+	the file is grown in steps and truncated to the used size in close().
+	new items are initialized with zero.
+	items are not constructed or destroyed.
+
+	the API is similar to Array's API, but count and index are size_t.
+	operator[] aborts on failed index check!
+	file errors throw FileError, a wrong file format throws DataError.
+*/
+
+
+template<typename T>
+class MappedArray
+{
+	static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+
+	struct Header
+	{
+		char   magic[4]; // "MArr"
+		uint16 version;
+		uint16 itemsize;
+		uint32 _padding;
+		uint64 count;
+		char   _reserved[40];
+	};
+	static_assert(sizeof(Header) == 64, "");
+
+	static constexpr uint16 VERSION	 = 1;
+	static constexpr size_t GROWSTEP = 1 << 20; // min. size to grow the file
+
+	FD		fd;
+	Header* header	 = nullptr;
+	T*		data	 = nullptr;
+	size_t	cnt		 = 0;
+	size_t	max		 = 0; // capacity of the mapping
+	bool	writable = false;
+
+	static size_t mapsize(size_t max) noexcept { return sizeof(Header) + max * sizeof(T); }
+	void		  map(size_t newmax) throws;
+	void		  unmap() noexcept;
+
+public:
+	enum Advice { Normal = MADV_NORMAL, Sequential = MADV_SEQUENTIAL, Random = MADV_RANDOM, WillNeed = MADV_WILLNEED };
+
+	MappedArray() noexcept = default;
+	explicit MappedArray(cstr path, int mode = 'm') throws { open(path, mode); }
+	~MappedArray() noexcept;
+	MappedArray(MappedArray&& q) noexcept { swap(q); }
+	MappedArray& operator=(MappedArray&& q) noexcept
+	{
+		swap(q);
+		return *this;
+	}
+	MappedArray(const MappedArray&)			   = delete;
+	MappedArray& operator=(const MappedArray&) = delete;
+	void		 swap(MappedArray& q) noexcept;
+
+	// mode 'r': open existing file read-only
+	// mode 'm': open existing file for read and write or create a new file
+	// mode 'w': create a new file or truncate an existing file
+	void open(cstr path, int mode = 'm') throws;
+	void close() throws; // truncate file to used size and close it
+	bool is_open() const noexcept { return header != nullptr; }
+	cstr filepath() const noexcept { return fd.filepath(); }
+
+	// write back modified pages and the count:
+	void sync(bool wait = true) throws;
+	void advise(Advice, size_t a = 0, size_t e = ~size_t(0)) noexcept;
+
+	// access data members:
+	size_t	 count() const noexcept { return cnt; }
+	const T* getData() const noexcept { return data; }
+	T*		 getData() noexcept { return data; }
+	const T& operator[](size_t i) const noexcept
+	{
+		assert(i < cnt);
+		return data[i];
+	}
+	T& operator[](size_t i) noexcept
+	{
+		assert(i < cnt);
+		return data[i];
+	}
+	const T& first() const noexcept
+	{
+		assert(cnt);
+		return data[0];
+	}
+	T& first() noexcept
+	{
+		assert(cnt);
+		return data[0];
+	}
+	const T& last() const noexcept
+	{
+		assert(cnt);
+		return data[cnt - 1];
+	}
+	T& last() noexcept
+	{
+		assert(cnt);
+		return data[cnt - 1];
+	}
+
+	// resize:
+	void growmax(size_t newmax) throws;
+	void grow(size_t newcnt) throws;
+	void shrink(size_t newcnt) noexcept;
+	void resize(size_t newcnt) throws
+	{
+		grow(newcnt);
+		shrink(newcnt);
+	}
+	void purge() noexcept { shrink(0); }
+	T&	 append(T q) throws
+	{
+		growmax(cnt + 1);
+		data[cnt] = q;
+		header->count = ++cnt;
+		return data[cnt - 1];
+	}
+	MappedArray& operator<<(T q) throws
+	{
+		append(q);
+		return *this;
+	}
+	void append(const T* q, size_t n) throws;
+	T	 pop() noexcept
+	{
+		assert(cnt && writable);
+		header->count = --cnt;
+		return data[cnt];
+	}
+
+	void sort() noexcept
+	{
+		assert(writable);
+		if (cnt) ::sort(data, data + cnt);
+	} // uses gt()
+	void rsort() noexcept
+	{
+		assert(writable);
+		if (cnt) ::rsort(data, data + cnt);
+	} // uses lt()
+	void sort(COMPARATOR(T) gt) noexcept
+	{
+		assert(writable);
+		if (cnt) ::sort(data, data + cnt, gt);
+	}
+};
+
+
+// -----------------------------------------------------------------------
+//					  I M P L E M E N T A T I O N S
+// -----------------------------------------------------------------------
+
+template<typename T>
+inline str tostr(const MappedArray<T>& array)
+{
+	// return 1-line description of array for debugging and logging:
+	return usingstr("MappedArray<T>[%zu]", array.count());
+}
+
+template<typename T>
+MappedArray<T>::~MappedArray() noexcept
+{
+	try
+	{
+		close();
+	}
+	catch (std::exception& e)
+	{
+		logline("~MappedArray: %s", e.what());
+	}
+}
+
+template<typename T>
+void MappedArray<T>::swap(MappedArray& q) noexcept
+{
+	fd.swap(q.fd);
+	std::swap(header, q.header);
+	std::swap(data, q.data);
+	std::swap(cnt, q.cnt);
+	std::swap(max, q.max);
+	std::swap(writable, q.writable);
+}
+
+template<typename T>
+void MappedArray<T>::map(size_t newmax) throws
+{
+	// map or remap the file for newmax items
+	// the file must already have the required size
+
+	size_t newsize = mapsize(newmax);
+	int	   prot	   = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+	void*  p;
+
+	if (header == nullptr) p = mmap(nullptr, newsize, prot, MAP_SHARED, fd.file_id(), 0);
+#ifdef _LINUX
+	else p = mremap(header, mapsize(max), newsize, MREMAP_MAYMOVE);
+#else
+	else
+	{
+		unmap();
+		p = mmap(nullptr, newsize, prot, MAP_SHARED, fd.file_id(), 0);
+	}
+#endif
+	if (p == MAP_FAILED) throw FileError(fd, errno);
+
+	header = reinterpret_cast<Header*>(p);
+	data   = reinterpret_cast<T*>(header + 1);
+	max	   = newmax;
+}
+
+template<typename T>
+void MappedArray<T>::unmap() noexcept
+{
+	if (header) munmap(header, mapsize(max));
+	header = nullptr;
+	data   = nullptr;
+	max	   = 0;
+}
+
+template<typename T>
+void MappedArray<T>::open(cstr path, int mode) throws
+{
+	// open or create file
+	// if the file exists then check the header and map it
+
+	assert(mode == 'r' || mode == 'm' || mode == 'w');
+
+	close();
+	writable = mode != 'r';
+	fd.open_file(path, mode == 'r' ? O_RDONLY : mode == 'm' ? O_RDWR | O_CREAT : O_RDWR | O_CREAT | O_TRUNC);
+
+	off_t fsize = fd.file_size();
+	if (fsize == 0 && writable) // new file:
+	{
+		fd.resize_file(off_t(mapsize(0)));
+		map(0);
+		memcpy(header->magic, "MArr", 4);
+		header->version	 = VERSION;
+		header->itemsize = sizeof(T);
+		header->count	 = 0;
+		cnt				 = 0;
+		return;
+	}
+
+	if (size_t(fsize) < sizeof(Header)) throw DataError("%s: not a MappedArray file", fd.filename());
+	size_t n = (size_t(fsize) - sizeof(Header)) / sizeof(T);
+	map(n);
+
+	if (memcmp(header->magic, "MArr", 4) != 0 || header->version != VERSION)
+	{
+		unmap();
+		throw DataError("%s: not a MappedArray file", fd.filename());
+	}
+	if (header->itemsize != sizeof(T) || header->count > n)
+	{
+		unmap();
+		throw DataError("%s: wrong item size or file truncated", fd.filename());
+	}
+	cnt = header->count;
+}
+
+template<typename T>
+void MappedArray<T>::close() throws
+{
+	// write count, unmap and truncate the file to the used size
+
+	if (!fd.is_valid()) return;
+
+	if (header)
+	{
+		if (writable) header->count = cnt;
+		unmap();
+		if (writable) fd.resize_file(off_t(mapsize(cnt)));
+	}
+	fd.close_file();
+	cnt = 0;
+}
+
+template<typename T>
+void MappedArray<T>::sync(bool wait) throws
+{
+	// write back modified pages and the count
+	// wait = false: only schedule the write
+
+	assert(is_open());
+	if (!writable) return;
+
+	header->count = cnt;
+	if (msync(header, mapsize(max), wait ? MS_SYNC : MS_ASYNC) != 0) throw FileError(fd, errno);
+}
+
+template<typename T>
+void MappedArray<T>::advise(Advice advice, size_t a, size_t e) noexcept
+{
+	// tell the OS how the range [a..[e will be accessed
+
+	if (e > max) e = max;
+	if (a >= e) return;
+
+	// madvise() needs a page aligned address:
+	static const size_t pagesize = size_t(sysconf(_SC_PAGESIZE));
+	size_t				start	 = (sizeof(Header) + a * sizeof(T)) & ~(pagesize - 1);
+	size_t				end		 = sizeof(Header) + e * sizeof(T);
+	madvise(reinterpret_cast<char*>(header) + start, end - start, advice);
+}
+
+template<typename T>
+void MappedArray<T>::growmax(size_t newmax) throws
+{
+	// grow the file and the mapping
+	// only grows, never shrinks
+	// grows at least by 1/8 and by GROWSTEP bytes
+
+	assert(is_open() && writable);
+
+	if (newmax <= max) return;
+
+	size_t n = max + max / 8 + GROWSTEP / sizeof(T);
+	if (newmax < n) newmax = n;
+
+	fd.resize_file(off_t(mapsize(newmax)));
+	map(newmax);
+}
+
+template<typename T>
+void MappedArray<T>::grow(size_t newcnt) throws
+{
+	// grow data[]
+	// only grows, never shrinks
+	// new items are cleared to zero
+
+	if (newcnt <= cnt) return;
+
+	growmax(newcnt);
+	memset(reinterpret_cast<void*>(data + cnt), 0, (newcnt - cnt) * sizeof(T));
+	header->count = cnt = newcnt;
+}
+
+template<typename T>
+void MappedArray<T>::shrink(size_t newcnt) noexcept
+{
+	// shrink data[]
+	// the file is truncated in close()
+
+	if (newcnt >= cnt) return;
+	assert(writable);
+	header->count = cnt = newcnt;
+}
+
+template<typename T>
+void MappedArray<T>::append(const T* q, size_t n) throws
+{
+	// q may point into data[] which may move in growmax()
+
+	if (q >= data && q < data + cnt)
+	{
+		size_t i = size_t(q - data);
+		growmax(cnt + n);
+		q = data + i;
+	}
+	else growmax(cnt + n);
+	memcpy(reinterpret_cast<void*>(data + cnt), q, n * sizeof(T));
+	header->count = cnt += n;
+}
@@ -0,0 +1,155 @@
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+
+#include "Templates/MappedArray.h"
+#include "Templates/Array.h"
+#include "doctest/doctest/doctest.h"
+#include <sys/resource.h>
+
+
+static cstr test_path(cstr name) { return usingstr("/tmp/%s_%u", name, uint(getpid())); }
+
+TEST_CASE("MappedArray")
+{
+	SUBCASE("") { logline("●●● %s:", __FILE__); }
+
+	cstr path = test_path("MappedArray.test");
+
+	SUBCASE("create, reopen, modify")
+	{
+		{
+			MappedArray<uint32> a(path, 'w');
+			CHECK(a.is_open());
+			CHECK(a.count() == 0);
+			a << 3 << 1 << 2;
+			CHECK(a.count() == 3);
+			CHECK_UNARY(a[0] == 3 && a[1] == 1 && a[2] == 2);
+			a.grow(100000);
+			CHECK(a.count() == 100000);
+			CHECK(a[99999] == 0);
+			for (uint i = 3; i < 100000; i++) a[i] = i * 7;
+			a.shrink(50000);
+			CHECK(a.pop() == 49999 * 7);
+			a.sync();
+		}
+
+		CHECK(FD(path).file_size() == off_t(64 + 49999 * 4)); // truncated in close()
+
+		{
+			MappedArray<uint32> a(path, 'r');
+			CHECK(a.count() == 49999);
+			CHECK_UNARY(a[0] == 3 && a[1] == 1 && a[2] == 2 && a[3] == 21);
+			CHECK(a.last() == 49998 * 7);
+			a.advise(a.Random);
+		}
+
+		{
+			MappedArray<uint32> a(path); // 'm'
+			CHECK(a.count() == 49999);
+			a.append(a.getData(), 10);
+			CHECK(a.count() == 50009);
+			CHECK(a.last() == 21 * 3);
+			a.sort();
+			CHECK_UNARY(a[0] == 1 && a[1] == 1 && a[2] == 2);
+			uint errors = 0;
+			for (size_t i = 1; i < a.count(); i++) errors += a[i - 1] > a[i];
+			CHECK(errors == 0);
+			a.rsort();
+			CHECK(a.first() == 49998 * 7);
+		}
+
+		MappedArray<uint32> a;
+		a.open(path, 'w');
+		CHECK(a.count() == 0);
+		a.close();
+		CHECK(!a.is_open());
+	}
+
+	SUBCASE("wrong file")
+	{
+		{
+			MappedArray<uint64> a(path, 'w');
+			a << 1 << 2;
+		}
+		CHECK_THROWS_AS(MappedArray<uint32>(path, 'r'), DataError);
+
+		FD(path, 'w').write_str("this is not a MappedArray file, but it is long enough to have a header.");
+		CHECK_THROWS_AS(MappedArray<uint64>(path, 'm'), DataError);
+	}
+
+	SUBCASE("move")
+	{
+		MappedArray<int16> a(path, 'w');
+		a << 1 << 2;
+		MappedArray<int16> b(std::move(a));
+		CHECK(!a.is_open());
+		CHECK(b.count() == 2);
+		a = std::move(b);
+		CHECK(a.count() == 2);
+	}
+
+	unlink(path);
+}
+
+
+static size_t data_size() // VmData of this process
+{
+	FD	   fd("/proc/self/status");
+	char   bu[4000];
+	uint32 n = fd.read_bytes(bu, sizeof(bu) - 1, true);
+	bu[n]	 = 0;
+	cstr s	 = strstr(bu, "VmData:");
+	return s ? size_t(strtoul(s + 7, nullptr, 10)) << 10 : 0;
+}
+
+TEST_CASE("MappedArray: larger than the memory limit")
+{
+	// set the limit for the data segment (RLIMIT_DATA) to the current size + 16 MB
+	// an Array<uint32> with 32 MB can't be allocated anymore
+	// but a MappedArray<uint32> with 32 MB can be created, reopened and sorted,
+	// because shared file mappings don't count against RLIMIT_DATA
+
+	static constexpr size_t N = 8 << 20; // items
+
+	cstr path = test_path("MappedArray.test.large");
+
+	struct RestoreLimit // restore RLIMIT_DATA even if a CHECK or MappedArray throws
+	{
+		rlimit old_limit;
+		RestoreLimit() noexcept { getrlimit(RLIMIT_DATA, &old_limit); }
+		~RestoreLimit() noexcept { setrlimit(RLIMIT_DATA, &old_limit); }
+	} restore_limit;
+
+	rlimit limit   = restore_limit.old_limit;
+	limit.rlim_cur = data_size() + (16 << 20);
+	if (setrlimit(RLIMIT_DATA, &limit) != 0) return logline("setrlimit failed: test skipped");
+
+	Array<uint32> array;
+	CHECK_THROWS(array.grow(N));
+
+	{
+		MappedArray<uint32> a(path, 'w');
+		a.grow(N);
+		uint32 r = 12345;
+		for (size_t i = 0; i < N; i++) a[i] = r = r * 1103515245 + 12345;
+	}
+	double t0 = now();
+	{
+		MappedArray<uint32> a(path, 'm');
+		CHECK(a.count() == N);
+		a.advise(a.Sequential);
+		a.sort();
+	}
+	logline("MappedArray<uint32>[%zu]: reopen and sort: %.3f sec", N, now() - t0);
+	{
+		MappedArray<uint32> a(path, 'r');
+		CHECK(a.count() == N);
+		uint errors = 0;
+		for (size_t i = 1; i < N; i++) errors += a[i - 1] > a[i];
+		CHECK(errors == 0);
+	}
+
+	unlink(path);
+}
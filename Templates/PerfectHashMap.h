@@ -0,0 +1,326 @@
+#pragma once
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+#include "Templates/Array.h"
+#include "Templates/HashMap.h"
+#include "hash/hash.h"
+#include "kio/kio.h"
+#include <type_traits>
+
+
+/*	Template class PerfectHashMap stores Objects with Keys in a minimal perfect hash table.
+
+	A PerfectHashMap is built once from a finished HashMap or from an array of keys.
+	Thereafter keys can't be added or removed, but the items can be modified.
+	The keys are mapped to the slots 0 .. count()-1 without collisions, so there is no map[] and no probing:
+	a lookup takes one hash, one displacement read and one key compare.
+	The key compare is needed to reject keys which are not in the map.
+
+	The fixed costs are 4 bytes per bucket, that is 1.33 bytes per item, plus sizeof(KEY) + sizeof(ITEM) per item.
+
+	Algorithm: CHD (compress, hash and displace):
+
+	every key has a 64 bit hash, computed with a seed.
+	the keys are distributed into buckets with ~LAMBDA keys per bucket.
+	the buckets are placed in order of decreasing size:
+	for every bucket a displacement d is searched which maps all keys of the bucket to free slots.
+	buckets with only 1 key are placed last, they store the index of a free slot with bit DIRECT set.
+	if a displacement can't be found then the build is restarted with a new seed.
+
+	Keys are stored as flat copy. (e.g. c-strings are not cloned.)
+	The hash for cstr keys is calculated from the characters,
+	for other keys from the bytes of the key. Keys must not contain padding bytes.
+
+
+	template arguments:
+
+		class KEY		must be a flat type or cstr. Keys are compared with same().
+		class ITEM		must be a flat type for PerfectHashMap.
+*/
+
+
+namespace kio
+{
+namespace perfect_hash
+{
+using kio::fmix64;
+
+inline uint64 fnv1a64(const uint8* p, size_t n, uint64 seed) noexcept
+{
+	uint64 h = 0xcbf29ce484222325ull ^ seed;
+	while (n--) { h = (h ^ *p++) * 0x100000001b3ull; }
+	return fmix64(h);
+}
+
+inline uint64 hash64(cstr key, uint64 seed) noexcept
+{
+	uint64 h = 0xcbf29ce484222325ull ^ seed;
+	while (*key) { h = (h ^ uint8(*key++)) * 0x100000001b3ull; }
+	return fmix64(h);
+}
+
+template<class KEY>
+inline uint64 hash64(const KEY& key, uint64 seed) noexcept
+{
+	static_assert(!std::is_pointer<KEY>::value, "pointers can't be hashed by value");
+	static_assert(std::is_trivially_copyable<KEY>::value, "KEY must be trivially copyable");
+
+	if (sizeof(KEY) <= sizeof(uint64))
+	{
+		uint64 n = 0;
+		memcpy(&n, &key, sizeof(KEY));
+		return fmix64(n ^ seed); // fmix64 is bijective => no collisions
+	}
+	else return fnv1a64(reinterpret_cast<const uint8*>(&key), sizeof(KEY), seed);
+}
+} // namespace perfect_hash
+} // namespace kio
+
+
+template<class KEY, class ITEM>
+class PerfectHashMap
+{
+private:
+	Array<KEY>	  keys;	 // keys[slot]
+	Array<ITEM>	  items; // items[slot]
+	Array<uint32> disp;	 // displacement per bucket or DIRECT + slot
+	uint64		  seed	   = 0;
+	uint		  nbuckets = 0;
+
+	static constexpr uint	LAMBDA	  = 3;		   // average keys per bucket: 4 is 2.5x slower to build, 5 is 9x slower
+	static constexpr uint32 DIRECT	  = 1u << 31;  // flag in disp[]: slot stored directly
+	static constexpr uint	MAX_SEEDS = 100;	   // give up after so many failed attempts
+	static constexpr uint64 GOLDEN	  = 0x9e3779b97f4a7c15ull;
+
+	uint bucket(uint64 h) const noexcept { return uint((uint64(uint32(h >> 32)) * nbuckets) >> 32); }
+	uint slot(uint64 h, uint32 d) const noexcept
+	{
+		return uint((uint64(uint32(kio::perfect_hash::fmix64(h + d * GOLDEN))) * keys.count()) >> 32);
+	}
+
+	bool try_build(const KEY* q, uint n, Array<uint>& slots) throws;
+	void build(const KEY* q, uint n, Array<uint>& slots) throws;
+
+public:
+	static constexpr uint maxCount = Array<KEY>::maxCount < Array<ITEM>::maxCount ? Array<KEY>::maxCount :
+																					  Array<ITEM>::maxCount;
+
+	PerfectHashMap() noexcept = default;
+	explicit PerfectHashMap(const HashMap<KEY, ITEM>&) throws;
+	explicit PerfectHashMap(const Array<KEY>& keys) throws; // all items are cleared to zero
+	PerfectHashMap(const Array<KEY>& keys, const Array<ITEM>& items) throws;
+
+	// get internal data:
+	const Array<KEY>&  getKeys() const noexcept { return keys; }
+	Array<ITEM>&	   getItems() noexcept { return items; }
+	const Array<ITEM>& getItems() const noexcept { return items; }
+	uint			   getBucketCount() const noexcept { return nbuckets; }
+
+	// get items:
+	int	  indexof(KEY) const noexcept; // slot in keys[] and items[] or -1
+	uint  count() const noexcept { return keys.count(); }
+	bool  contains(KEY key) const noexcept { return indexof(key) != -1; } // uses same(KEY,KEY)
+	ITEM  get(KEY key, ITEM dflt) const noexcept;						  // uses same(KEY,KEY)
+	ITEM& get(KEY key) noexcept
+	{
+		int i = indexof(key);
+		assert(i != -1);
+		return items[i];
+	}
+	ITEM const& get(KEY key) const noexcept
+	{
+		int i = indexof(key);
+		assert(i != -1);
+		return items[i];
+	}
+	ITEM&		operator[](KEY key) noexcept { return get(key); }
+	ITEM const& operator[](KEY key) const noexcept { return get(key); }
+	ITEM*		find(KEY key) noexcept
+	{
+		int i = indexof(key);
+		return i >= 0 ? &items[i] : nullptr;
+	}
+	ITEM const* find(KEY key) const noexcept
+	{
+		int i = indexof(key);
+		return i >= 0 ? &items[i] : nullptr;
+	}
+};
+
+
+// -----------------------------------------------------------------------
+//				   	I M P L E M E N T A T I O N S
+// -----------------------------------------------------------------------
+
+
+template<class KEY, class ITEM>
+inline str tostr(const PerfectHashMap<KEY, ITEM>& hashmap)
+{
+	// return 1-line description of hashmap for debugging and logging:
+	return usingstr("PerfectHashMap[%u]", hashmap.count());
+}
+
+template<class KEY, class ITEM>
+PerfectHashMap<KEY, ITEM>::PerfectHashMap(const HashMap<KEY, ITEM>& q) throws :
+	PerfectHashMap(q.getKeys(), q.getItems())
+{}
+
+template<class KEY, class ITEM>
+PerfectHashMap<KEY, ITEM>::PerfectHashMap(const Array<KEY>& q) throws
+{
+	Array<uint> slots;
+	build(q.getData(), q.count(), slots);
+	items.grow(q.count());
+}
+
+template<class KEY, class ITEM>
+PerfectHashMap<KEY, ITEM>::PerfectHashMap(const Array<KEY>& q, const Array<ITEM>& qitems) throws
+{
+	assert(q.count() == qitems.count());
+
+	Array<uint> slots;
+	build(q.getData(), q.count(), slots);
+	items.grow(q.count());
+	for (uint i = 0; i < q.count(); i++) { items[slots[i]] = qitems[i]; }
+}
+
+template<class KEY, class ITEM>
+void PerfectHashMap<KEY, ITEM>::build(const KEY* q, uint n, Array<uint>& slots) throws
+{
+	// build the hash table for keys q[n]
+	// stores the keys in keys[] and their slots in slots[]
+	// throws DataError if a key is not unique
+
+	for (seed = 0; seed < MAX_SEEDS; seed++)
+	{
+		if (try_build(q, n, slots)) return;
+		xlogline("PerfectHashMap: retry with seed %u", uint(seed + 1));
+	}
+	throw DataError("PerfectHashMap: can't build hash table"); // something is badly wrong with the hash function
+}
+
+template<class KEY, class ITEM>
+bool PerfectHashMap<KEY, ITEM>::try_build(const KEY* q, uint n, Array<uint>& slots) throws
+{
+	// try to build the hash table with the current seed
+	// returns false if a displacement for a bucket could not be found
+
+	keys.purge();
+	keys.grow(n);
+	disp.purge();
+	nbuckets = (n + LAMBDA - 1) / LAMBDA;
+	disp.grow(nbuckets);
+	slots.purge();
+	slots.grow(n);
+	if (n == 0) return true;
+
+	// hash the keys and sort them into buckets:
+	Array<uint64> hashes(n);
+	Array<uint>	  start(nbuckets + 1); // start of bucket in order[]
+	for (uint i = 0; i < n; i++)
+	{
+		hashes[i] = kio::perfect_hash::hash64(q[i], seed);
+		start[bucket(hashes[i]) + 1]++;
+	}
+	uint maxsize = 0;
+	for (uint b = 0; b < nbuckets; b++)
+	{
+		maxsize = max(maxsize, start[b + 1]);
+		start[b + 1] += start[b];
+	}
+	Array<uint> order(n); // key indexes sorted by bucket
+	{
+		Array<uint> fill(start);
+		for (uint i = 0; i < n; i++) { order[fill[bucket(hashes[i])]++] = i; }
+	}
+
+	// sort the buckets by decreasing size:
+	Array<uint> bysize(nbuckets);
+	{
+		Array<uint> fill(maxsize + 2);
+		for (uint b = 0; b < nbuckets; b++) { fill[maxsize - (start[b + 1] - start[b]) + 1]++; }
+		for (uint s = 0; s <= maxsize; s++) { fill[s + 1] += fill[s]; }
+		for (uint b = 0; b < nbuckets; b++) { bysize[fill[maxsize - (start[b + 1] - start[b])]++] = b; }
+	}
+
+	// place the buckets with 2 or more keys:
+	Array<uint8> taken(n);
+	Array<uint>	 pos(maxsize);
+	uint		 bi = 0;
+	for (; bi < nbuckets; bi++)
+	{
+		uint		b  = bysize[bi];
+		uint		a  = start[b];
+		uint		sz = start[b + 1] - a;
+		const uint* k  = &order[a];
+		if (sz <= 1) break;
+
+		// keys with the same hash can't be separated:
+		for (uint i = 0; i < sz; i++)
+			for (uint j = i + 1; j < sz; j++)
+			{
+				if (hashes[k[i]] != hashes[k[j]]) continue;
+				if (kio::same(q[k[i]], q[k[j]])) throw DataError("PerfectHashMap: duplicate key");
+				return false;
+			}
+
+		for (uint32 d = 0;; d++)
+		{
+			if (d == DIRECT) return false;
+
+			uint i = 0;
+			for (; i < sz; i++)
+			{
+				uint p = slot(hashes[k[i]], d);
+				if (taken[p]) break;
+				taken[p] = 1;
+				pos[i]	 = p;
+			}
+			if (i == sz)
+			{
+				disp[b] = d;
+				break;
+			}
+			while (i--) taken[pos[i]] = 0; // undo
+		}
+		for (uint i = 0; i < sz; i++) { slots[k[i]] = pos[i]; }
+	}
+
+	// buckets with 1 key go directly into the remaining free slots:
+	uint p = 0;
+	for (; bi < nbuckets; bi++)
+	{
+		uint b = bysize[bi];
+		if (start[b + 1] == start[b]) break; // empty buckets
+		while (taken[p]) p++;
+		taken[p]			  = 1;
+		disp[b]				  = DIRECT + p;
+		slots[order[start[b]]] = p;
+	}
+
+	for (uint i = 0; i < n; i++) { keys[slots[i]] = q[i]; }
+	return true;
+}
+
+template<class KEY, class ITEM>
+int PerfectHashMap<KEY, ITEM>::indexof(KEY key) const noexcept
+{
+	// search for key
+	// returns index in items[] or -1
+
+	if (nbuckets == 0) return -1;
+
+	uint64 h = kio::perfect_hash::hash64(key, seed);
+	uint32 d = disp[bucket(h)];
+	uint   i = d & DIRECT ? d - DIRECT : slot(h, d);
+	return kio::same(keys[i], key) ? int(i) : -1;
+}
+
+template<class KEY, class ITEM>
+inline ITEM PerfectHashMap<KEY, ITEM>::get(KEY key, ITEM dflt) const noexcept
+{
+	int idx = indexof(key);
+	return idx == -1 ? std::move(dflt) : items[idx];
+}
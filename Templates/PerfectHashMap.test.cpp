@@ -0,0 +1,151 @@
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+
+#include "Templates/PerfectHashMap.h"
+#include "doctest/doctest/doctest.h"
+
+
+TEST_CASE("PerfectHashMap")
+{
+	SUBCASE("") { logline("●●● %s:", __FILE__); }
+
+	SUBCASE("empty")
+	{
+		PerfectHashMap<uint32, uint32> a;
+		CHECK(a.count() == 0);
+		CHECK(!a.contains(0));
+		PerfectHashMap<uint32, uint32> b {HashMap<uint32, uint32>()};
+		CHECK(b.count() == 0);
+		CHECK(!b.contains(0));
+		CHECK(b.get(1, 7) == 7);
+	}
+
+	SUBCASE("from HashMap")
+	{
+		HashMap<uint32, double> h;
+		for (uint32 i = 1; i <= 10000; i++) h.add(i * 13, i * 0.5);
+
+		PerfectHashMap<uint32, double> a(h);
+		CHECK(a.count() == 10000);
+		CHECK(a.getBucketCount() == 3334);
+
+		uint errors = 0;
+		for (uint32 i = 0; i < 10001 * 13; i++)
+		{
+			if (i % 13 || i == 0) errors += a.contains(i) || a.find(i) != nullptr;
+			else errors += a.get(i) != i / 13 * 0.5 || *a.find(i) != i / 13 * 0.5;
+		}
+		CHECK(errors == 0);
+		CHECK(a.get(1, -1.0) == -1.0);
+		CHECK(a[26] == 1.0);
+
+		// items can be modified:
+		a[26] = 99.0;
+		CHECK(a.get(26) == 99.0);
+
+		// all slots are used exactly once:
+		for (uint i = 0; i < a.count(); i++) errors += a.indexof(a.getKeys()[i]) != int(i);
+		CHECK(errors == 0);
+	}
+
+	SUBCASE("cstr keys")
+	{
+		HashMap<cstr, uint> h;
+		h.add("A", 2).add("Ccc", 22).add("Bb", 44).add("", 55);
+		PerfectHashMap<cstr, uint> a(h);
+		CHECK(a.count() == 4);
+		CHECK(a.get("A") == 2);
+		CHECK(a.get("Ccc") == 22);
+		CHECK(a.get(usingstr("%s", "Bb")) == 44); // compared by value
+		CHECK(a.get("") == 55);
+		CHECK(!a.contains("B"));
+		CHECK(a.get("D", 0) == 0);
+
+		TempMemPool tmp;
+		Array<cstr> keys;
+		for (uint i = 0; i < 5000; i++) keys << usingstr("key_%u", i);
+		PerfectHashMap<cstr, uint> b(keys); // index only: items are cleared
+		CHECK(b.count() == 5000);
+		uint errors = 0;
+		for (uint i = 0; i < 5000; i++)
+		{
+			errors += b.get(keys[i]) != 0;
+			errors += b.contains(usingstr("key_%u", i + 5000));
+			b.get(keys[i]) = i;
+		}
+		for (uint i = 0; i < 5000; i++) errors += b.get(usingstr("key_%u", i)) != i;
+		CHECK(errors == 0);
+	}
+
+	SUBCASE("duplicate keys")
+	{
+		Array<uint32> keys;
+		keys << 1 << 2 << 3 << 2;
+		using Map = PerfectHashMap<uint32, uint32>;
+		CHECK_THROWS_AS(Map {keys}, DataError);
+	}
+}
+
+
+template<typename MAP, typename KEY>
+static double time_lookups(const MAP& map, const Array<KEY>& keys, uint& found)
+{
+	double t0 = now();
+	for (uint i = 0; i < keys.count(); i++) { found += map.contains(keys[i]); }
+	return now() - t0;
+}
+
+template<typename KEY>
+static void compare_lookups(cstr name, const Array<KEY>& hits, const Array<KEY>& misses)
+{
+	uint N = hits.count();
+
+	HashMap<KEY, uint> map1(N);
+	for (uint i = 0; i < N; i++) { map1.add(hits[i], i); }
+	double					  t0 = now();
+	PerfectHashMap<KEY, uint> map2(map1);
+	double					  t1 = now();
+
+	uint   found1 = 0, found2 = 0;
+	double h1 = time_lookups(map1, hits, found1), h2 = time_lookups(map2, hits, found2);
+	CHECK(found1 == N);
+	CHECK(found2 == N);
+	double x1 = time_lookups(map1, misses, found1), x2 = time_lookups(map2, misses, found2);
+	CHECK(found1 == N);
+	CHECK(found2 == N);
+
+	// size of the tables, not counting overallocation:
+	uint   cnt = map1.count();
+	double m1  = double(map1.getMapSize() * sizeof(int)) / cnt + sizeof(KEY) + sizeof(uint) + sizeof(uint32);
+	double m2  = double(map2.getBucketCount() * sizeof(uint32)) / cnt + sizeof(KEY) + sizeof(uint);
+
+	logline("HashMap<%s>:        hit %.1f ns, miss %.1f ns, %.1f bytes/item", name, h1 * 1e9 / N, x1 * 1e9 / N, m1);
+	logline("PerfectHashMap<%s>: hit %.1f ns, miss %.1f ns, %.1f bytes/item, build %.1f ns/item", name, h2 * 1e9 / N,
+			x2 * 1e9 / N, m2, (t1 - t0) * 1e9 / N);
+}
+
+TEST_CASE("PerfectHashMap vs HashMap performance test" * doctest::skip(false))
+{
+	static const uint N = 1000000;
+
+	SUBCASE("uint32 keys")
+	{
+		Array<uint32> hits(0u, N), misses(0u, N);
+		for (uint i = 0; i < N; i++) { hits.append(uint32(random()) | 1); }
+		for (uint i = 0; i < N; i++) { misses.append(uint32(random()) & ~1u); }
+		hits.shuffle();
+		compare_lookups("uint32", hits, misses);
+	}
+
+	SUBCASE("cstr keys")
+	{
+		static const uint M = N / 4;
+		TempMemPool		  tmp;
+		Array<cstr>		  hits(0u, M), misses(0u, M);
+		for (uint i = 0; i < M; i++) { hits.append(usingstr("hit/%08x/%u", uint(random()), i)); }
+		for (uint i = 0; i < M; i++) { misses.append(usingstr("miss/%08x/%u", uint(random()), i)); }
+		compare_lookups("cstr", hits, misses);
+	}
+}
@@ -0,0 +1,279 @@
+#pragma once
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+#include "Array.h"
+#include "RCPtr.h"
+#include "StrArray.h"
+
+
+/*	PooledStrArray stores all strings in large chunks of memory, similar to the pool of class Names:
+
+	- appending a string needs no heap allocation (only 1 per 64 kB)
+	- purge() releases the whole pool at once
+	- copying the array only copies the pointers: the chunks are shared by reference counting.
+	  strings in the pool are never modified. a copy appends new strings to a new chunk.
+	- FD::read_file(PooledStrArray&) reads the file into a single chunk and splits it in place.
+
+	the strings are immutable: operator[] returns cstr.
+	removing strings does not free memory in the pool.
+	a PooledStrArray converts implicitly to const Array<cstr>&,
+	which is valid as long as the PooledStrArray is not modified or destroyed.
+	nullptr strings are stored as nullptr.
+*/
+
+
+class PooledStrArray
+{
+	struct Chunk
+	{
+		RCDATA_NOWEAK
+
+		RCPtr<Chunk> prev;
+		char*		 data;
+
+		explicit Chunk(RCPtr<Chunk>&& prev, uint size) throws : prev(std::move(prev)), data(new char[size]) {}
+		~Chunk() noexcept;
+		NO_COPY_MOVE(Chunk);
+	};
+
+	static constexpr uint CHUNKSIZE	 = 64 * 1024;
+	static constexpr uint LARGE_SIZE = CHUNKSIZE / 8; // strings ≥ LARGE_SIZE get their own chunk
+
+	Array<cstr>	 array;
+	RCPtr<Chunk> pool;				// last allocated chunk
+	char*		 pool_ptr = nullptr; // free space in the chunk this array may write into
+	char*		 pool_end = nullptr;
+
+	str alloc(uint len) throws; // allocate space for len chars + 0 in pool
+
+public:
+	~PooledStrArray() noexcept = default;
+	PooledStrArray() noexcept  = default;
+	PooledStrArray(PooledStrArray&& q) noexcept;
+	PooledStrArray(const PooledStrArray& q) throws : array(q.array), pool(q.pool) {} // shares the chunks
+	explicit PooledStrArray(const Array<cstr>& q) throws;
+	explicit PooledStrArray(const StrArray& q) throws;
+	PooledStrArray& operator=(PooledStrArray&& q) noexcept;
+	PooledStrArray& operator=(const PooledStrArray& q) throws { return *this = PooledStrArray(q); }
+	PooledStrArray& operator=(const Array<cstr>& q) throws { return *this = PooledStrArray(q); }
+	PooledStrArray& operator=(const StrArray& q) throws { return *this = PooledStrArray(q); }
+
+	// convert to StrArray with StrArray(PooledStrArray) => deep copy.
+	operator const Array<cstr>&() const noexcept { return array; }
+
+	// access data members:
+	uint		count() const noexcept { return array.count(); }
+	const cstr* getData() const noexcept { return array.getData(); }
+	cstr		operator[](uint i) const noexcept { return array[i]; }
+	cstr		operator[](int i) const noexcept { return array[i]; }
+	cstr		first() const noexcept { return array.first(); }
+	cstr		last() const noexcept { return array.last(); }
+
+	bool operator==(const Array<cstr>& q) const noexcept { return array == q; } // compare values
+	bool operator!=(const Array<cstr>& q) const noexcept { return array != q; } // compare values
+	bool operator==(const PooledStrArray& q) const noexcept { return array == q.array; }
+	bool operator!=(const PooledStrArray& q) const noexcept { return array != q.array; }
+	bool operator==(const StrArray& q) const noexcept; // compare values
+	bool operator!=(const StrArray& q) const noexcept { return !operator==(q); }
+	uint indexof(cstr s) const noexcept { return array.indexof(s); } // compare values
+	bool contains(cstr s) const noexcept { return array.contains(s); }
+
+	// resize:
+	void shrink(uint newcnt) noexcept { array.shrink(newcnt); }
+	void drop() noexcept { array.drop(); }
+	cstr pop() noexcept { return array.pop(); } // valid until purge() or destruction
+	void purge() noexcept;
+
+	cstr append(cstr q) throws { return array.append(q ? poolcopy(q, uint(strlen(q))) : nullptr); }
+	cstr append(cstr q, uint len) throws { return array.append(poolcopy(q, len)); } // append substring
+	void appendifnew(cstr q) throws
+	{
+		if (!contains(q)) append(q);
+	}
+	PooledStrArray& operator<<(cstr q) throws
+	{
+		append(q);
+		return *this;
+	}
+	void append(const cstr* q, uint n) throws;
+	void append(const Array<cstr>& q) throws { append(q.getData(), q.count()); }
+	void append(const StrArray& q) throws { append(q.getData(), q.count()); }
+
+	void removeat(uint i, bool fast = 0) noexcept { array.removeat(i, fast); }
+	void removerange(uint a, uint e) noexcept { array.removerange(a, e); }
+	void removeitem(cstr s, bool fast = 0) noexcept
+	{
+		uint i = indexof(s);
+		if (i != ~0u) removeat(i, fast);
+	} // remove by value
+	void insertat(uint idx, cstr s) throws { array.insertat(idx, s ? poolcopy(s, uint(strlen(s))) : nullptr); }
+
+	void sort() noexcept { array.sort(); }
+	void rsort() noexcept { array.rsort(); }
+	void sort(bool (*gt)(cstr, cstr)) noexcept { array.sort(gt); }
+
+	// copy string into pool:
+	cstr poolcopy(cstr q, uint len) throws;
+
+	// for FD::read_file():
+	// allocate a chunk for a buffer of size len+1 and split it into lines
+	ptr	 alloc_buffer(uint len) throws;
+	void split_buffer(ptr a, ptr e) throws; // appends the lines
+};
+
+
+// -----------------------------------------------------------------------
+//					  I M P L E M E N T A T I O N S
+// -----------------------------------------------------------------------
+
+inline str tostr(const PooledStrArray& array)
+{
+	// return 1-line description of object for debugging and logging:
+	return usingstr("PooledStrArray[%u]", array.count());
+}
+
+inline PooledStrArray::Chunk::~Chunk() noexcept
+{
+	delete[] data;
+
+	// release the chain of chunks without recursion if we hold the last reference:
+	RCPtr<Chunk> p = std::move(prev);
+	while (p && p->refcnt() == 1)
+	{
+		RCPtr<Chunk> q = std::move(p->prev);
+		std::swap(p, q); // q = old p which has no more prev => released at end of scope
+	}
+}
+
+inline PooledStrArray::PooledStrArray(PooledStrArray&& q) noexcept :
+	array(std::move(q.array)),
+	pool(std::move(q.pool)),
+	pool_ptr(q.pool_ptr),
+	pool_end(q.pool_end)
+{
+	q.pool_ptr = q.pool_end = nullptr;
+}
+
+inline PooledStrArray& PooledStrArray::operator=(PooledStrArray&& q) noexcept
+{
+	Array<cstr>::swap(array, q.array);
+	std::swap(pool, q.pool);
+	std::swap(pool_ptr, q.pool_ptr);
+	std::swap(pool_end, q.pool_end);
+	return *this;
+}
+
+inline PooledStrArray::PooledStrArray(const Array<cstr>& q) throws
+{
+	append(q); //
+}
+
+inline PooledStrArray::PooledStrArray(const StrArray& q) throws
+{
+	append(q); //
+}
+
+inline void PooledStrArray::purge() noexcept
+{
+	array.purge();
+	pool	 = nullptr;
+	pool_ptr = pool_end = nullptr;
+}
+
+inline str PooledStrArray::alloc(uint len) throws
+{
+	// allocate memory for a string with len chars + 0 in the pool
+	// large strings get their own chunk
+	// small strings start a new chunk if they don't fit in the current chunk
+
+	uint size = len + 1;
+	if (size <= uint(pool_end - pool_ptr))
+	{
+		str s = pool_ptr;
+		pool_ptr += size;
+		return s;
+	}
+
+	if (size >= LARGE_SIZE)
+	{
+		pool = new Chunk(std::move(pool), size);
+		return pool->data;
+	}
+
+	pool	 = new Chunk(std::move(pool), CHUNKSIZE);
+	pool_ptr = pool->data + size;
+	pool_end = pool->data + CHUNKSIZE;
+	return pool->data;
+}
+
+inline cstr PooledStrArray::poolcopy(cstr q, uint len) throws
+{
+	// copy string into the pool
+
+	str s = alloc(len);
+	memcpy(s, q, len);
+	s[len] = 0;
+	return s;
+}
+
+inline bool PooledStrArray::operator==(const StrArray& q) const noexcept
+{
+	if (count() != q.count()) return false;
+	for (uint i = 0; i < count(); i++)
+	{
+		if (ne(array[i], q[i])) return false;
+	}
+	return true;
+}
+
+inline void PooledStrArray::append(const cstr* q, uint n) throws
+{
+	// append copies of strings
+	// sums up the size of all small strings and allocates the pool for them at once
+
+	assert(q != array.getData() || n == 0);
+
+	size_t total = 0;
+	for (uint i = 0; i < n; i++)
+	{
+		if (q[i] == nullptr) continue;
+		size_t size = strlen(q[i]) + 1;
+		if (size < LARGE_SIZE) total += size;
+	}
+	if (total > size_t(pool_end - pool_ptr) && total >= CHUNKSIZE)
+	{
+		if (total > 0xffffffffu) throw std::bad_alloc();
+		pool	 = new Chunk(std::move(pool), uint(total));
+		pool_ptr = pool->data;
+		pool_end = pool->data + total;
+	}
+
+	array.growmax(array.count() + n);
+	for (uint i = 0; i < n; i++) append(q[i]);
+}
+
+inline ptr PooledStrArray::alloc_buffer(uint len) throws
+{
+	// allocate a new chunk for a buffer of len bytes + 0
+	// the buffer will be split in place by split_buffer()
+	// strings appended later go into a new chunk
+
+	pool	 = new Chunk(std::move(pool), len + 1);
+	pool_ptr = pool_end = nullptr;
+	pool->data[len]		= 0;
+	return pool->data;
+}
+
+inline void PooledStrArray::split_buffer(ptr a, ptr e) throws
+{
+	// split the buffer from alloc_buffer() in place and append the lines
+	// _split() replaces the contents of the target array
+
+	if (array.count() == 0) return _split(array, a, e);
+
+	Array<cstr> lines;
+	_split(lines, a, e);
+	array.append(lines.getData(), lines.count());
+}
@@ -0,0 +1,192 @@
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+
+#include "Templates/PooledStrArray.h"
+#include "doctest/doctest/doctest.h"
+#include "unix/FD.h"
+#ifdef __GLIBC__
+  #include <malloc.h>
+#endif
+
+
+TEST_CASE("PooledStrArray")
+{
+	SUBCASE("") { logline("●●● %s:", __FILE__); }
+
+	SUBCASE("append, remove, insert")
+	{
+		PooledStrArray a;
+		CHECK(a.count() == 0);
+
+		a << "11" << "22" << nullptr << "33";
+		CHECK(a.count() == 4);
+		CHECK(eq(a[0], "11"));
+		CHECK(a[2] == nullptr);
+		CHECK(eq(a.last(), "33"));
+		CHECK(a.indexof("33") == 3);
+		CHECK(a.contains("22"));
+		CHECK(!a.contains("44"));
+
+		a.appendifnew("22");
+		a.appendifnew("44");
+		CHECK(a.count() == 5);
+		a.append("555555", 3);
+		CHECK(eq(a.last(), "555"));
+
+		a.removeat(2);
+		a.removeitem("22");
+		CHECK(a == (StrArray() << "11" << "33" << "44" << "555"));
+		a.insertat(1, "xx");
+		CHECK(a == (StrArray() << "11" << "xx" << "33" << "44" << "555"));
+		a.removerange(1, 3);
+		CHECK(a == (StrArray() << "11" << "44" << "555"));
+		a.rsort();
+		CHECK(a == (StrArray() << "555" << "44" << "11"));
+		a.drop();
+		CHECK(eq(a.pop(), "44"));
+		a.purge();
+		CHECK(a.count() == 0);
+	}
+
+	SUBCASE("large strings and many chunks")
+	{
+		PooledStrArray a;
+		str			   big = tempstr(100000);
+		memset(big, 'x', 100000);
+
+		for (uint i = 0; i < 20000; i++)
+		{
+			if (i % 1000 == 0) a.append(big);
+			else a.append(usingstr("string %u", i));
+		}
+		CHECK(a.count() == 20000);
+		uint errors = 0;
+		for (uint i = 0; i < 20000; i++)
+		{
+			if (i % 1000 == 0) errors += strlen(a[i]) != 100000;
+			else errors += ne(a[i], usingstr("string %u", i));
+		}
+		CHECK(errors == 0);
+	}
+
+	SUBCASE("copy shares the pool")
+	{
+		PooledStrArray a;
+		a << "11" << "22" << "33";
+		PooledStrArray b(a);
+		CHECK(b == a);
+		CHECK(b[1] == a[1]); // same pointer
+
+		a << "44";
+		b << "55";
+		CHECK(a == (StrArray() << "11" << "22" << "33" << "44"));
+		CHECK(b == (StrArray() << "11" << "22" << "33" << "55"));
+
+		a.purge();
+		CHECK(b == (StrArray() << "11" << "22" << "33" << "55"));
+
+		PooledStrArray c;
+		c = b;
+		b = PooledStrArray();
+		CHECK(c == (StrArray() << "11" << "22" << "33" << "55"));
+		PooledStrArray d(std::move(c));
+		CHECK(c.count() == 0);
+		CHECK(d.count() == 4);
+	}
+
+	SUBCASE("convert to and from StrArray and Array<cstr>")
+	{
+		StrArray s;
+		s << "11" << "22" << "33";
+		PooledStrArray a(s);
+		CHECK(a == s);
+		CHECK(a[0] != s[0]); // copied
+
+		StrArray t(a);
+		CHECK(t == s);
+
+		const Array<cstr>& c = a;
+		CHECK(c.count() == 3);
+		CHECK(c[2] == a[2]);
+
+		PooledStrArray b(c);
+		CHECK(b == a);
+	}
+
+	SUBCASE("read_file")
+	{
+		FD fd;
+		fd.open_tempfile();
+		fd.write_str("line 1\nline 2\r\n\nline 4");
+		fd.rewind_file();
+
+		PooledStrArray a;
+		a << "foo";
+		fd.read_file(a);
+		CHECK(a == (StrArray() << "foo" << "line 1" << "line 2" << "" << "line 4")); // appended
+		a << "line 5";
+		CHECK(a.count() == 6);
+		CHECK(eq(a[5], "line 5"));
+	}
+}
+
+
+static size_t heap_in_use() // bytes allocated with malloc() or new
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+	struct mallinfo2 info = mallinfo2();
+	return info.uordblks + info.hblkhd;
+#else
+	return 0;
+#endif
+}
+
+TEST_CASE("PooledStrArray performance test" * doctest::skip(false))
+{
+	// write a file with 2M lines
+	// read it into a StrArray and into a PooledStrArray
+	// compare time and memory
+
+	static constexpr uint N = 2000000;
+
+	FD fd;
+	fd.open_tempfile();
+	{
+		TempMemPool tmp;
+		for (uint i = 0; i < N; i++) fd.write_str(usingstr("/usr/lib/some/path/file_%u.so\n", i));
+	}
+
+	fd.rewind_file();
+	size_t	 m0 = heap_in_use();
+	double	 t0 = now();
+	StrArray a;
+	fd.read_file(a);
+	double	 t1 = now();
+	size_t	 m1 = heap_in_use();
+	StrArray a2(a);
+	double	 t2 = now();
+	a.purge();
+	a2.purge();
+	double t3 = now();
+
+	fd.rewind_file();
+	size_t		   m3 = heap_in_use();
+	double		   t4 = now();
+	PooledStrArray b;
+	fd.read_file(b);
+	double		   t5 = now();
+	size_t		   m4 = heap_in_use();
+	PooledStrArray b2(b);
+	double		   t6 = now();
+	CHECK(b2.count() == N);
+	b.purge();
+	b2.purge();
+	double t7 = now();
+
+	logline("StrArray:       read %.3f sec, %3zu MB, copy %.3f sec, purge %.3f sec", t1 - t0, (m1 - m0) >> 20, t2 - t1,
+			t3 - t2);
+	logline("PooledStrArray: read %.3f sec, %3zu MB, copy %.3f sec, purge %.3f sec", t5 - t4, (m4 - m3) >> 20, t6 - t5,
+			t7 - t6);
+}
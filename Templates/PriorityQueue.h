@@ -0,0 +1,427 @@
+#pragma once
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+#include "Templates/Array.h"
+#include "kio/kio.h"
+
+
+/*	PriorityQueue<T,D> is a min-heap: top() is the smallest item.
+
+	The heap is a D-ary tree stored in an Array<T>: the children of item[i] are item[D*i+1 .. D*i+D].
+	With D = 4 the tree has half the height of a binary heap and the children of an item
+	are in one or two cache lines. Items are compared with lt(). Items with the same priority
+	are returned in no specific order.
+
+	IndexedPriorityQueue<T,D> is a PriorityQueue where items can be modified and removed.
+	push() returns a handle for the item which is valid until the item is popped or removed.
+	Handles are small integers: they are reused and can be used as an index into another array.
+
+	Both are suitable for timer and event queues: push events with their time and pop the next one.
+
+	pop() moves the hole at the top down to a leaf, always taking the smallest child, then moves the
+	last item into the hole and sifts it up. The last item most likely belongs near the bottom,
+	so this needs less compares than sifting it down from the top. On the way down the grandchildren,
+	which are contiguous, are prefetched while the children are compared.
+*/
+
+
+namespace kio
+{
+namespace priority_queue
+{
+template<typename T>
+inline void prefetch(const T* a, uint n) noexcept
+{
+	// prefetch n items starting at a
+
+	for (cptr p = cptr(a), e = cptr(a + n); p < e; p += 64) { __builtin_prefetch(p); }
+	__builtin_prefetch(a + n - 1);
+}
+} // namespace priority_queue
+} // namespace kio
+
+
+template<typename T, uint D = 4>
+class PriorityQueue
+{
+	static_assert(D >= 2, "D must be ≥ 2");
+
+	Array<T> heap;
+
+	void sift_up(uint i) noexcept;
+	void sift_down(uint i) noexcept;
+	uint sift_hole(uint i, uint n) noexcept;
+
+public:
+	PriorityQueue() noexcept = default;
+	explicit PriorityQueue(Array<T> items) noexcept; // O(n)
+
+	// access data members:
+	uint	 count() const noexcept { return heap.count(); }
+	bool	 isEmpty() const noexcept { return heap.count() == 0; }
+	const T& top() const noexcept { return heap.first(); } // smallest item
+	const Array<T>& getItems() const noexcept { return heap; } // in heap order
+
+	// add and remove items:
+	void push(T item) throws;
+	T	 pop() noexcept;			   // remove and return the smallest item
+	void drop() noexcept;		   // remove the smallest item
+	T	 replace_top(T item) noexcept; // pop() + push() in one step
+	void purge() noexcept { heap.purge(); }
+	void grow(uint max) throws { heap.grow(heap.count(), max); } // preallocate
+};
+
+
+template<typename T, uint D = 4>
+class IndexedPriorityQueue
+{
+	static_assert(D >= 2, "D must be ≥ 2");
+
+	struct Item
+	{
+		T	 value;
+		uint handle;
+	};
+
+	Array<Item> heap;
+	Array<uint> pos;		  // handle -> index in heap[] or FREE
+	uint		free_handles; // list of free handles linked through pos[] or NONE
+
+	static constexpr uint NONE = ~0u;
+	static constexpr uint FREE = 0x80000000u; // bit set in pos[] of free handles
+
+	void sift_up(uint i) noexcept;
+	void sift_down(uint i) noexcept;
+	uint sift_hole(uint i, uint n) noexcept;
+	void move(uint z, Item&& q) noexcept
+	{
+		pos[q.handle] = z;
+		heap[z]		  = std::move(q);
+	}
+	void remove_at(uint i) noexcept;
+
+public:
+	IndexedPriorityQueue() noexcept : free_handles(NONE) {}
+
+	// access data members:
+	uint	 count() const noexcept { return heap.count(); }
+	bool	 isEmpty() const noexcept { return heap.count() == 0; }
+	const T& top() const noexcept { return heap.first().value; } // smallest item
+	uint	 top_handle() const noexcept { return heap.first().handle; }
+	bool	 contains(uint handle) const noexcept { return handle < pos.count() && !(pos[handle] & FREE); }
+	const T& get(uint handle) const noexcept
+	{
+		assert(contains(handle));
+		return heap[pos[handle]].value;
+	}
+	const T& operator[](uint handle) const noexcept { return get(handle); }
+
+	// add and remove items:
+	uint push(T item) throws; // returns handle
+	T	 pop() noexcept;	  // remove and return the smallest item
+	void drop() noexcept { remove_at(0); }
+	void remove(uint handle) noexcept;
+	void purge() noexcept;
+
+	// modify items:
+	void update(uint handle, T item) noexcept;		 // set new value
+	void decrease_key(uint handle, T item) noexcept; // set new value which must be ≤ the old value
+};
+
+
+// -----------------------------------------------------------------------
+//					  I M P L E M E N T A T I O N S
+// -----------------------------------------------------------------------
+
+template<typename T, uint D>
+inline str tostr(const PriorityQueue<T, D>& queue)
+{
+	// return 1-line description of queue for debugging and logging:
+	return usingstr("PriorityQueue[%u]", queue.count());
+}
+
+template<typename T, uint D>
+inline str tostr(const IndexedPriorityQueue<T, D>& queue)
+{
+	// return 1-line description of queue for debugging and logging:
+	return usingstr("IndexedPriorityQueue[%u]", queue.count());
+}
+
+template<typename T, uint D>
+PriorityQueue<T, D>::PriorityQueue(Array<T> items) noexcept : heap(std::move(items))
+{
+	// heapify: sift down all items which have children, starting with the last one
+
+	uint n = heap.count();
+	for (uint i = n > 1 ? (n - 2) / D + 1 : 0; i--;) { sift_down(i); }
+}
+
+template<typename T, uint D>
+void PriorityQueue<T, D>::sift_up(uint i) noexcept
+{
+	// move item[i] up until its parent is not larger
+
+	T item = std::move(heap[i]);
+	while (i)
+	{
+		uint parent = (i - 1) / D;
+		if (!lt(item, heap[parent])) break;
+		heap[i] = std::move(heap[parent]);
+		i		= parent;
+	}
+	heap[i] = std::move(item);
+}
+
+template<typename T, uint D>
+void PriorityQueue<T, D>::sift_down(uint i) noexcept
+{
+	// move item[i] down until its smallest child is not smaller
+
+	uint n	  = heap.count();
+	T	 item = std::move(heap[i]);
+	for (;;)
+	{
+		uint a = D * i + 1;
+		if (a >= n) break;
+		uint e = min(a + D, n);
+		uint g = D * a + 1; // grandchildren
+		if (g < n) kio::priority_queue::prefetch(&heap[g], min(D * D, n - g));
+
+		uint c = a; // smallest child
+		for (uint j = a + 1; j < e; j++) { c = lt(heap[j], heap[c]) ? j : c; }
+		if (!lt(heap[c], item)) break;
+		heap[i] = std::move(heap[c]);
+		i		= c;
+	}
+	heap[i] = std::move(item);
+}
+
+template<typename T, uint D>
+uint PriorityQueue<T, D>::sift_hole(uint i, uint n) noexcept
+{
+	// move the hole at item[i] down to a leaf, always taking the smallest child
+	// only the first n items are considered
+	// returns the new position of the hole
+
+	for (;;)
+	{
+		uint a = D * i + 1;
+		if (a >= n) return i;
+		uint e = min(a + D, n);
+		uint g = D * a + 1; // grandchildren
+		if (g < n) kio::priority_queue::prefetch(&heap[g], min(D * D, n - g));
+
+		uint c = a; // smallest child
+		for (uint j = a + 1; j < e; j++) { c = lt(heap[j], heap[c]) ? j : c; }
+		heap[i] = std::move(heap[c]);
+		i		= c;
+	}
+}
+
+template<typename T, uint D>
+void PriorityQueue<T, D>::push(T item) throws
+{
+	heap.append(std::move(item));
+	sift_up(heap.count() - 1);
+}
+
+template<typename T, uint D>
+T PriorityQueue<T, D>::pop() noexcept
+{
+	assert(heap.count());
+
+	T item = std::move(heap[0]);
+	drop();
+	return item;
+}
+
+template<typename T, uint D>
+void PriorityQueue<T, D>::drop() noexcept
+{
+	// remove the top item:
+	// move the hole down to a leaf, move the last item into the hole and sift it up
+
+	assert(heap.count());
+
+	uint n = heap.count() - 1;
+	uint i = sift_hole(0, n);
+	if (i != n)
+	{
+		heap[i] = std::move(heap[n]);
+		sift_up(i);
+	}
+	heap.drop();
+}
+
+template<typename T, uint D>
+T PriorityQueue<T, D>::replace_top(T item) noexcept
+{
+	// remove the top item and add a new item
+	// this needs only one sift_down()
+
+	assert(heap.count());
+
+	std::swap(item, heap[0]);
+	sift_down(0);
+	return item;
+}
+
+template<typename T, uint D>
+void IndexedPriorityQueue<T, D>::sift_up(uint i) noexcept
+{
+	Item item = std::move(heap[i]);
+	while (i)
+	{
+		uint parent = (i - 1) / D;
+		if (!lt(item.value, heap[parent].value)) break;
+		move(i, std::move(heap[parent]));
+		i = parent;
+	}
+	move(i, std::move(item));
+}
+
+template<typename T, uint D>
+void IndexedPriorityQueue<T, D>::sift_down(uint i) noexcept
+{
+	uint n	  = heap.count();
+	Item item = std::move(heap[i]);
+	for (;;)
+	{
+		uint a = D * i + 1;
+		if (a >= n) break;
+		uint e = min(a + D, n);
+		uint g = D * a + 1; // grandchildren
+		if (g < n) kio::priority_queue::prefetch(&heap[g], min(D * D, n - g));
+
+		uint c = a; // smallest child
+		for (uint j = a + 1; j < e; j++) { c = lt(heap[j].value, heap[c].value) ? j : c; }
+		if (!lt(heap[c].value, item.value)) break;
+		move(i, std::move(heap[c]));
+		i = c;
+	}
+	move(i, std::move(item));
+}
+
+template<typename T, uint D>
+uint IndexedPriorityQueue<T, D>::sift_hole(uint i, uint n) noexcept
+{
+	for (;;)
+	{
+		uint a = D * i + 1;
+		if (a >= n) return i;
+		uint e = min(a + D, n);
+		uint g = D * a + 1; // grandchildren
+		if (g < n) kio::priority_queue::prefetch(&heap[g], min(D * D, n - g));
+
+		uint c = a; // smallest child
+		for (uint j = a + 1; j < e; j++) { c = lt(heap[j].value, heap[c].value) ? j : c; }
+		move(i, std::move(heap[c]));
+		i = c;
+	}
+}
+
+template<typename T, uint D>
+uint IndexedPriorityQueue<T, D>::push(T item) throws
+{
+	// add item and return its handle
+	// a free handle is reused if possible
+
+	heap.growmax(heap.count() + 1);
+
+	uint handle;
+	if (free_handles != NONE)
+	{
+		handle		 = free_handles;
+		free_handles = pos[handle] & ~FREE;
+		if (free_handles == (NONE & ~FREE)) free_handles = NONE;
+	}
+	else
+	{
+		assert(pos.count() < FREE);
+		handle = pos.count();
+		pos.append(0);
+	}
+
+	heap.append(Item {std::move(item), handle});
+	sift_up(heap.count() - 1);
+	return handle;
+}
+
+template<typename T, uint D>
+void IndexedPriorityQueue<T, D>::remove_at(uint i) noexcept
+{
+	// remove item at heap[i] and free its handle:
+	// move the hole down to a leaf, move the last item into the hole and sift it up.
+	// the last item may move up above i: this is ok because all items below i are ≥ the items above.
+
+	assert(i < heap.count());
+
+	uint handle	 = heap[i].handle;
+	pos[handle]	 = free_handles | FREE;
+	free_handles = handle;
+
+	uint n = heap.count() - 1;
+	i	   = sift_hole(i, n);
+	if (i != n)
+	{
+		move(i, std::move(heap[n]));
+		sift_up(i);
+	}
+	heap.drop();
+}
+
+template<typename T, uint D>
+T IndexedPriorityQueue<T, D>::pop() noexcept
+{
+	assert(heap.count());
+
+	T item = std::move(heap[0].value);
+	remove_at(0);
+	return item;
+}
+
+template<typename T, uint D>
+void IndexedPriorityQueue<T, D>::remove(uint handle) noexcept
+{
+	assert(contains(handle));
+	remove_at(pos[handle]);
+}
+
+template<typename T, uint D>
+void IndexedPriorityQueue<T, D>::purge() noexcept
+{
+	heap.purge();
+	pos.purge();
+	free_handles = NONE;
+}
+
+template<typename T, uint D>
+void IndexedPriorityQueue<T, D>::update(uint handle, T item) noexcept
+{
+	// set new value for item
+	// the item is moved up or down as needed
+
+	assert(contains(handle));
+
+	uint i		  = pos[handle];
+	bool up		  = lt(item, heap[i].value);
+	heap[i].value = std::move(item);
+	if (up) sift_up(i);
+	else sift_down(i);
+}
+
+template<typename T, uint D>
+void IndexedPriorityQueue<T, D>::decrease_key(uint handle, T item) noexcept
+{
+	// set new value for item which must not be larger than the old value
+	// the item can only move up
+
+	assert(contains(handle));
+
+	uint i = pos[handle];
+	assert(!lt(heap[i].value, item));
+	heap[i].value = std::move(item);
+	sift_up(i);
+}
@@ -0,0 +1,248 @@
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+
+#include "Templates/PriorityQueue.h"
+#include "doctest/doctest/doctest.h"
+#include <functional>
+#include <queue>
+#include <vector>
+
+
+TEST_CASE("PriorityQueue")
+{
+	SUBCASE("") { logline("●●● %s:", __FILE__); }
+
+	SUBCASE("push, pop")
+	{
+		PriorityQueue<int> q;
+		CHECK(q.isEmpty());
+		q.push(5);
+		q.push(3);
+		q.push(8);
+		q.push(3);
+		CHECK(q.count() == 4);
+		CHECK(q.top() == 3);
+		CHECK(q.pop() == 3);
+		CHECK(q.pop() == 3);
+		CHECK(q.pop() == 5);
+		q.drop();
+		CHECK(q.isEmpty());
+	}
+
+	SUBCASE("random items, D = 2..8")
+	{
+		auto test = [](auto& q) {
+			Array<uint> items;
+			for (uint i = 0; i < 10000; i++) items << uint(random()) % 5000;
+			for (uint i = 0; i < items.count(); i++) q.push(items[i]);
+			items.sort();
+
+			uint errors = 0;
+			for (uint i = 0; i < items.count(); i++) errors += q.pop() != items[i];
+			CHECK(errors == 0);
+			CHECK(q.isEmpty());
+		};
+		PriorityQueue<uint, 2> q2;
+		test(q2);
+		PriorityQueue<uint, 3> q3;
+		test(q3);
+		PriorityQueue<uint> q4;
+		test(q4);
+		PriorityQueue<uint, 8> q8;
+		test(q8);
+	}
+
+	SUBCASE("heapify, replace_top")
+	{
+		Array<cstr> items;
+		for (uint i = 0; i < 1000; i++) items << usingstr("%04u", uint(random()) % 10000);
+		PriorityQueue<cstr> q(items);
+		CHECK(q.count() == 1000);
+
+		items.sort();
+		CHECK(eq(q.top(), items[0]));
+		CHECK(eq(q.replace_top("9999"), items[0]));
+		CHECK(q.count() == 1000);
+		items[0] = "9999";
+		items.sort();
+
+		uint errors = 0;
+		for (uint i = 0; i < items.count(); i++) errors += ne(q.pop(), items[i]);
+		CHECK(errors == 0);
+
+		PriorityQueue<cstr> q0 {Array<cstr>()};
+		CHECK(q0.isEmpty());
+		PriorityQueue<cstr> q1 {Array<cstr>(1)};
+		CHECK(q1.count() == 1);
+	}
+}
+
+
+TEST_CASE("IndexedPriorityQueue")
+{
+	SUBCASE("push, pop, handles")
+	{
+		IndexedPriorityQueue<int> q;
+		CHECK(q.isEmpty());
+		uint h5 = q.push(5);
+		uint h3 = q.push(3);
+		uint h8 = q.push(8);
+		CHECK(h5 == 0);
+		CHECK(h3 == 1);
+		CHECK(h8 == 2);
+		CHECK(q.top() == 3);
+		CHECK(q.top_handle() == h3);
+		CHECK(q[h8] == 8);
+
+		CHECK(q.pop() == 3);
+		CHECK(!q.contains(h3));
+		CHECK(q.contains(h5));
+		CHECK(q.push(7) == h3); // handle reused
+		CHECK(q.get(h3) == 7);
+
+		q.decrease_key(h8, 1);
+		CHECK(q.top_handle() == h8);
+		q.update(h8, 10);
+		CHECK(q.top_handle() == h5);
+		q.remove(h5);
+		CHECK(q.count() == 2);
+		CHECK(q.pop() == 7);
+		CHECK(q.pop() == 10);
+		CHECK(q.isEmpty());
+
+		q.push(1);
+		q.purge();
+		CHECK(q.isEmpty());
+		CHECK(!q.contains(0));
+		CHECK(q.push(2) == 0);
+	}
+
+	SUBCASE("random operations")
+	{
+		// compare with a plain array of values
+
+		IndexedPriorityQueue<uint, 4> q;
+		Array<uint>					  values; // handle -> value or ~0u
+		uint						  errors = 0;
+
+		for (uint i = 0; i < 100000; i++)
+		{
+			uint r = uint(random());
+			uint h = uint(random()) % (values.count() + 1);
+
+			switch (r % 6)
+			{
+			case 0:
+			case 1:
+			{
+				uint v = r >> 8;
+				h	   = q.push(v);
+				if (h == values.count()) values << v;
+				else errors += values[h] != ~0u, values[h] = v;
+				break;
+			}
+			case 2:
+				if (q.isEmpty()) break;
+				h = q.top_handle();
+				errors += q.pop() != values[h];
+				values[h] = ~0u;
+				break;
+			case 3:
+				if (h == values.count() || values[h] == ~0u) break;
+				q.remove(h);
+				values[h] = ~0u;
+				break;
+			case 4:
+				if (h == values.count() || values[h] == ~0u) break;
+				q.update(h, r >> 8);
+				values[h] = r >> 8;
+				break;
+			case 5:
+				if (h == values.count() || values[h] == ~0u) break;
+				q.decrease_key(h, values[h] / 2);
+				values[h] = values[h] / 2;
+				break;
+			}
+
+			if (!q.isEmpty())
+			{
+				// top() must be the smallest value:
+				uint min = ~0u;
+				if (i % 100 == 0)
+					for (uint j = 0; j < values.count(); j++) min = std::min(min, values[j]);
+				else min = q.top();
+				errors += q.top() != min;
+				errors += values[q.top_handle()] != q.top();
+			}
+		}
+		CHECK(errors == 0);
+
+		uint n = 0;
+		for (uint j = 0; j < values.count(); j++) n += values[j] != ~0u;
+		CHECK(q.count() == n);
+
+		uint last = 0;
+		while (!q.isEmpty())
+		{
+			uint v = q.pop();
+			errors += v < last;
+			last = v;
+		}
+		CHECK(errors == 0);
+	}
+}
+
+
+TEST_CASE("PriorityQueue performance test" * doctest::skip(false))
+{
+	// push N random items and pop them all
+	// repeat for small N
+
+	auto run = [](uint N) {
+		uint reps = max(1u, 10000000 / N);
+		uint64 sum1 = 0, sum2 = 0, sum3 = 0;
+
+		Array<uint64> items;
+		for (uint i = 0; i < N; i++) items << (uint64(random()) << 31 | uint64(random()));
+
+		double t0 = now();
+		for (uint r = 0; r < reps; r++)
+		{
+			std::priority_queue<uint64, std::vector<uint64>, std::greater<uint64>> q;
+			for (uint i = 0; i < N; i++) q.push(items[i]);
+			for (uint i = 0; i < N; i++)
+			{
+				sum1 += q.top() * i;
+				q.pop();
+			}
+		}
+		double t1 = now();
+		for (uint r = 0; r < reps; r++)
+		{
+			PriorityQueue<uint64> q;
+			for (uint i = 0; i < N; i++) q.push(items[i]);
+			for (uint i = 0; i < N; i++) sum2 += q.pop() * i;
+		}
+		double t2 = now();
+		for (uint r = 0; r < reps; r++)
+		{
+			IndexedPriorityQueue<uint64> q;
+			for (uint i = 0; i < N; i++) q.push(items[i]);
+			for (uint i = 0; i < N; i++) sum3 += q.pop() * i;
+		}
+		double t3 = now();
+		CHECK(sum1 == sum2);
+		CHECK(sum1 == sum3);
+
+		double n = double(N) * reps;
+		logline("N = %8u: push+pop: std::priority_queue %.1f ns, PriorityQueue %.1f ns, IndexedPriorityQueue %.1f ns",
+				N, (t1 - t0) * 1e9 / n, (t2 - t1) * 1e9 / n, (t3 - t2) * 1e9 / n);
+	};
+
+	run(1000);
+	run(100000);
+	run(1000000);
+	run(10000000);
+}
@@ -5,6 +5,16 @@
 
 //#include "kio/kio.h"
 #include <atomic>
+#include <chrono>
+#if defined(_LINUX) || defined(__linux__)
+  #include <climits>
+  #include <linux/futex.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#else
+  #include <condition_variable>
+  #include <mutex>
+#endif
 typedef unsigned int uint;
 
 
@@ -17,6 +27,10 @@ namespace kio
  *  Writer and reader thread can access the queue without a mutex.
  *  Therefore only one thread can write and only one thread can read.
  *  If multiple threads can read or write a queue, then this class is unsuitable.
+ *
+ *  get_blocking(), put_blocking() and wait_for() park the calling thread until the queue state changes.
+ *  The waiting thread sets the waiting flag and sleeps on rp or wp (futex on Linux, else a condition variable).
+ *  The other side only makes a system call if the waiting flag is set.
  */
 template<typename T, uint SIZE>
 class Queue
@@ -28,6 +42,11 @@ protected:
 	T				  buffer[SIZE]; // write -> wp++ -> read -> rp++
 	std::atomic<uint> rp {0};		// only modified by reader
 	std::atomic<uint> wp {0};		// only modified by writer
+	std::atomic<uint> waiting {0};	// number of threads waiting in get_blocking(), put_blocking() or wait_for()
+#if !defined(_LINUX) && !defined(__linux__)
+	std::mutex				mutex;
+	std::condition_variable cond;
+#endif
 
 	static inline void copy(T* z, const T* q, uint n) noexcept // helper: hopefully optimized proper copy
 	{
@@ -37,6 +56,15 @@ protected:
 	void copy_q2b(T*, uint n) noexcept;		  // helper: copy queue to external linear buffer
 	void copy_b2q(const T*, uint n) noexcept; // helper: copy external linear buffer to queue
 
+	using Clock = std::chrono::steady_clock;
+	static Clock::time_point deadline(double timeout) noexcept;
+	bool wait(const std::atomic<uint>&, uint oldval, Clock::time_point) noexcept; // helper: wait while value==oldval
+	void wake(const std::atomic<uint>&) noexcept;								   // helper: wake waiting thread
+	void notify(const std::atomic<uint>& a) noexcept
+	{
+		if (waiting.load()) wake(a);
+	}
+
 public:
 	Queue()	 = default;
 	~Queue() = default;
@@ -53,6 +81,7 @@ public:
 		T	 c = std::move(buffer[i & MASK]);
 		FENCE;
 		rp = i + 1;
+		notify(rp);
 		return c;
 	}
 	void put(T&& c) noexcept
@@ -62,6 +91,7 @@ public:
 		buffer[i & MASK] = std::move(c);
 		FENCE;
 		wp = i + 1;
+		notify(wp);
 	}
 
 	uint read(T* z, uint n) noexcept
@@ -70,6 +100,7 @@ public:
 		copy_q2b(z, n);
 		FENCE;
 		rp += n;
+		notify(rp);
 		return n;
 	}
 	uint write(const T* q, uint n) noexcept
@@ -78,11 +109,149 @@ public:
 		copy_b2q(q, n);
 		FENCE;
 		wp += n;
+		notify(wp);
 		return n;
 	}
+
+	// blocking versions, timeout in seconds:
+	// return false if timed out
+	bool get_blocking(T& c, double timeout = 1e9) noexcept;
+	bool put_blocking(T&& c, double timeout = 1e9) noexcept;
+
+	// wait until at least n items are available or timeout, n ≤ SIZE
+	// returns avail()
+	uint wait_for(uint n, double timeout = 1e9) noexcept;
 };
 
 
+template<typename T, uint SIZE>
+inline typename Queue<T, SIZE>::Clock::time_point Queue<T, SIZE>::deadline(double timeout) noexcept
+{
+	// limit timeout to some years to avoid overflow:
+	return Clock::now() + std::chrono::duration_cast<Clock::duration>(
+							  std::chrono::duration<double>(timeout < 1e8 ? timeout : 1e8));
+}
+
+#if defined(_LINUX) || defined(__linux__)
+
+template<typename T, uint SIZE>
+bool Queue<T, SIZE>::wait(const std::atomic<uint>& a, uint oldval, Clock::time_point end) noexcept
+{
+	// wait until value of a != oldval or timeout
+	// the caller must have incremented 'waiting'
+	// returns false if timed out
+
+	static_assert(sizeof(a) == sizeof(int), "futex needs a 32 bit int");
+
+	while (a.load() == oldval)
+	{
+		auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - Clock::now()).count();
+		if (ns <= 0) return false;
+
+		timespec ts {time_t(ns / 1000000000), long(ns % 1000000000)};
+		syscall(SYS_futex, &a, FUTEX_WAIT_PRIVATE, oldval, &ts, nullptr, 0);
+	}
+	return true;
+}
+
+template<typename T, uint SIZE>
+inline void Queue<T, SIZE>::wake(const std::atomic<uint>& a) noexcept
+{
+	syscall(SYS_futex, &a, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+}
+
+#else
+
+template<typename T, uint SIZE>
+bool Queue<T, SIZE>::wait(const std::atomic<uint>& a, uint oldval, Clock::time_point end) noexcept
+{
+	// wait until value of a != oldval or timeout
+	// the caller must have incremented 'waiting'
+	// returns false if timed out
+
+	std::unique_lock<std::mutex> lock(mutex);
+	return cond.wait_until(lock, end, [&] { return a.load() != oldval; });
+}
+
+template<typename T, uint SIZE>
+inline void Queue<T, SIZE>::wake(const std::atomic<uint>&) noexcept
+{
+	// lock the mutex to avoid a lost wakeup between the waiter's test and wait:
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+	}
+	cond.notify_all();
+}
+
+#endif
+
+template<typename T, uint SIZE>
+bool Queue<T, SIZE>::get_blocking(T& c, double timeout) noexcept
+{
+	// get next item
+	// wait until an item is available or timeout
+
+	if (!avail())
+	{
+		Clock::time_point end = deadline(timeout);
+		waiting++;
+		for (uint w = wp; w == rp; w = wp)
+		{
+			if (!wait(wp, w, end)) break;
+		}
+		waiting--;
+		if (!avail()) return false;
+	}
+
+	c = get();
+	return true;
+}
+
+template<typename T, uint SIZE>
+bool Queue<T, SIZE>::put_blocking(T&& c, double timeout) noexcept
+{
+	// put item
+	// wait until there is a free slot or timeout
+
+	if (!free())
+	{
+		Clock::time_point end = deadline(timeout);
+		waiting++;
+		for (uint r = rp; wp - r == SIZE; r = rp)
+		{
+			if (!wait(rp, r, end)) break;
+		}
+		waiting--;
+		if (!free()) return false;
+	}
+
+	put(std::move(c));
+	return true;
+}
+
+template<typename T, uint SIZE>
+uint Queue<T, SIZE>::wait_for(uint n, double timeout) noexcept
+{
+	// wait until at least n items are available or timeout
+	// returns the number of available items
+
+	assert(n <= SIZE);
+
+	if (avail() < n)
+	{
+		Clock::time_point end = deadline(timeout);
+		waiting++;
+		for (uint w = wp; w - rp < n; w = wp)
+		{
+			if (!wait(wp, w, end)) break;
+		}
+		waiting--;
+	}
+
+	return avail();
+}
+
+
 template<typename T, uint SIZE>
 inline void Queue<T, SIZE>::copy_b2q(const T* q, uint n) noexcept
 {
@@ -0,0 +1,155 @@
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+
+#include "kio/kio.h"
+
+#include "Templates/Queue.h"
+#include "doctest/doctest/doctest.h"
+#include <thread>
+
+using namespace kio;
+
+
+TEST_CASE("Queue")
+{
+	SUBCASE("") { logline("●●● %s:", __FILE__); }
+
+	SUBCASE("single thread")
+	{
+		Queue<uint, 8> q;
+		CHECK(q.avail() == 0);
+		CHECK(q.free() == 8);
+
+		for (uint i = 0; i < 8; i++) q.put(i + 10);
+		CHECK(q.avail() == 8);
+		CHECK(q.free() == 0);
+		CHECK(q.get() == 10);
+		CHECK(q.get() == 11);
+
+		uint bu[10];
+		CHECK(q.read(bu, 10) == 6);
+		for (uint i = 0; i < 6; i++) CHECK(bu[i] == i + 12);
+		CHECK(q.write(bu, 10) == 8);
+		CHECK(q.read(bu + 2, 3) == 3);
+		CHECK(bu[2] == 12);
+		CHECK(bu[4] == 14);
+	}
+
+	SUBCASE("blocking with timeout")
+	{
+		Queue<uint, 4> q;
+		uint		   n = 0;
+
+		double t0 = now();
+		CHECK(!q.get_blocking(n, 0.02));
+		CHECK(now() - t0 >= 0.02);
+		CHECK(q.wait_for(1, 0.01) == 0);
+
+		for (uint i = 0; i < 4; i++) CHECK(q.put_blocking(i + 1, 0.0));
+		t0 = now();
+		CHECK(!q.put_blocking(5, 0.02));
+		CHECK(now() - t0 >= 0.02);
+		CHECK(q.wait_for(4, 0.0) == 4);
+
+		CHECK(q.get_blocking(n, 0.0));
+		CHECK(n == 1);
+		CHECK(q.put_blocking(5, 0.0));
+		for (uint i = 0; i < 4; i++) CHECK(q.get_blocking(n));
+		CHECK(n == 5);
+	}
+
+	SUBCASE("blocking with 2 threads")
+	{
+		static constexpr uint N = 100000;
+
+		Queue<uint, 16> q;
+		std::thread		writer([&q] {
+			for (uint i = 0; i < N; i++) q.put_blocking(uint(i));
+		});
+
+		uint errors = 0, n;
+		for (uint i = 0; i < N; i++)
+		{
+			if (i % 1000 == 0 && q.wait_for(8, 1.0) < 8) errors++;
+			if (!q.get_blocking(n, 1.0) || n != i) errors++;
+		}
+		writer.join();
+		CHECK(errors == 0);
+		CHECK(q.avail() == 0);
+	}
+}
+
+
+TEST_CASE("Queue ping-pong performance test" * doctest::skip(false))
+{
+	// two threads pass one item back and forth
+	// the round trip time is the latency of 2 wake-ups
+
+	static constexpr uint N = 20000;
+
+	Queue<uint, 4> ping;
+	Queue<uint, 4> pong;
+	uint		   n;
+
+	std::thread pinger([&] {
+		for (uint i = 0; i < N; i++)
+		{
+			ping.put_blocking(uint(i));
+			pong.get_blocking(n);
+		}
+	});
+
+	double t0 = now();
+	for (uint i = 0; i < N; i++)
+	{
+		uint m;
+		ping.get_blocking(m);
+		pong.put_blocking(uint(m));
+	}
+	pinger.join();
+	double t1 = now();
+	logline("blocking:  round trip = %.2f µs", (t1 - t0) * 1e6 / N);
+
+	// the same with polling and yield():
+	std::thread poller([&] {
+		for (uint i = 0; i < N; i++)
+		{
+			ping.put(uint(i));
+			while (!pong.avail()) std::this_thread::yield();
+			pong.get();
+		}
+	});
+
+	t0 = now();
+	for (uint i = 0; i < N; i++)
+	{
+		while (!ping.avail()) std::this_thread::yield();
+		pong.put(ping.get());
+	}
+	poller.join();
+	t1 = now();
+	logline("yielding:  round trip = %.2f µs", (t1 - t0) * 1e6 / N);
+
+	// and with polling and waitDelay():
+	static constexpr uint M = 200;
+	std::thread			  sleeper([&] {
+		  for (uint i = 0; i < M; i++)
+		  {
+			  ping.put(uint(i));
+			  while (!pong.avail()) waitDelay(50e-6);
+			  pong.get();
+		  }
+	  });
+
+	t0 = now();
+	for (uint i = 0; i < M; i++)
+	{
+		while (!ping.avail()) waitDelay(50e-6);
+		pong.put(ping.get());
+	}
+	sleeper.join();
+	t1 = now();
+	logline("sleeping:  round trip = %.2f µs (waitDelay(50µs))", (t1 - t0) * 1e6 / M);
+}
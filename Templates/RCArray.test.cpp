@@ -6,6 +6,8 @@
 #include "Templates/RCArray.h"
 #include "doctest/doctest/doctest.h"
 #include "unix/FD.h"
+#include <atomic>
+#include <thread>
 #include <vector>
 
 
@@ -845,6 +847,100 @@ TEST_CASE("RCArray performance test" * doctest::skip(false))
 }
 
 
+static std::atomic<int> rc5_objects {0};
+class RCObject5
+{
+	RCDATA_WITHWEAK
+public:
+	RCObject5() noexcept { rc5_objects++; }
+	~RCObject5() { rc5_objects--; }
+};
+
+TEST_CASE("WeakPtr: promotion races with destruction")
+{
+	// a thread promotes a WeakPtr while the main thread drops the last RCPtr
+	// the promotion must either get the object or nullptr and the object must be destroyed exactly once
+
+	uint got = 0;
+	for (uint i = 0; i < 1000; i++)
+	{
+		RCPtr<RCObject5>  p = new RCObject5;
+		WeakPtr<RCObject5> w {p};
+		std::atomic<bool>  running {false};
+
+		std::thread t([&] {
+			for (;;)
+			{
+				RCPtr<RCObject5> q {w};
+				if (!q) break;
+				got++;
+				running = true;
+				std::this_thread::yield();
+			}
+		});
+
+		while (!running) std::this_thread::yield();
+		p = nullptr;
+		t.join();
+		CHECK(!w);
+	}
+	CHECK(rc5_objects == 0);
+	logline("WeakPtr race test: %u successful promotions", got);
+}
+
+class alignas(64) RCObject4Aligned : public RCObject4 // one cache line per object
+{
+public:
+	// c++14: new does not respect alignas > 16:
+	static void* operator new(size_t size)
+	{
+		void* p;
+		if (posix_memalign(&p, 64, size)) throw std::bad_alloc();
+		return p;
+	}
+	static void			  operator delete(void* p) noexcept { free(p); }
+	static constexpr bool _rc_pooled = true; // memory must be released with this operator delete
+};
+
+TEST_CASE("WeakPtr promotion performance test" * doctest::skip(false))
+{
+	// every thread promotes a WeakPtr to its own object
+	// the objects are in separate cache lines and there is no shared data,
+	// so the throughput should scale with the number of cores
+
+	static constexpr uint N = 2000000;
+
+	for (uint nthreads : {1u, 2u, 4u, 8u, 16u})
+	{
+		std::vector<RCPtr<RCObject4Aligned>>  objects;
+		std::vector<WeakPtr<RCObject4Aligned>> weakptrs;
+		for (uint i = 0; i < nthreads; i++) objects.emplace_back(new RCObject4Aligned);
+		for (uint i = 0; i < nthreads; i++) weakptrs.emplace_back(objects[i]);
+
+		std::vector<std::thread> threads;
+		std::atomic<uint>		 errors {0};
+		double					 t0 = now();
+		for (uint i = 0; i < nthreads; i++)
+		{
+			threads.emplace_back([&weakptrs, &errors, i, nthreads] {
+				WeakPtr<RCObject4Aligned>& w = weakptrs[i];
+				for (uint j = 0; j < N / nthreads; j++)
+				{
+					RCPtr<RCObject4Aligned> p {w};
+					if (!p) errors++;
+				}
+			});
+		}
+		for (std::thread& thread : threads) thread.join();
+		double t1 = now();
+
+		CHECK(errors == 0);
+		for (uint i = 0; i < nthreads; i++) CHECK(objects[i].refcnt() == 1);
+		logline("%2u threads: %.1f M promotions/sec", nthreads, N / (t1 - t0) / 1e6);
+	}
+}
+
+
 /*
 
 
@@ -0,0 +1,140 @@
+#pragma once
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+#include "Templates/RCObject.h"
+#include "kio/kio.h"
+#include <atomic>
+
+
+/*	RCMailbox<T> is an intrusive lock-free queue to pass RCPtr<T> messages
+	from any number of threads to one consumer thread, e.g. to an event loop.
+
+	T must be derived from RCMailboxLink, e.g. from RCMessage.
+	The link is stored in the message itself, so push() needs no node allocation.
+	A message can only be in one mailbox at a time.
+
+	push() takes over the reference of the RCPtr and is wait-free:
+	it is one atomic exchange and one store.
+	pop() and drain() must only be called by the consumer thread.
+	They take the references back into RCPtrs.
+
+	This is the MPSC queue of D. Vyukov:
+	producers swap their message into 'head' and then link the previous head to it.
+	the consumer reads from 'tail' and follows the links.
+	a stub link keeps the queue non-empty, so head and tail never become nullptr.
+	between the exchange and the store of a producer the queue is temporarily not linked.
+	then pop() returns nullptr even if the queue is not empty and the consumer must try again later.
+*/
+
+
+template<typename T>
+class RCMailbox
+{
+	static_assert(std::is_base_of<RCMailboxLink, T>::value, "T must be derived from RCMailboxLink");
+	NO_COPY_MOVE(RCMailbox);
+
+	using Link = RCMailboxLink;
+
+	alignas(64) std::atomic<Link*> head; // last pushed link, written by producers
+	alignas(64) Link* tail;				 // next link to read, owned by the consumer
+	Link stub;
+
+	void push_link(Link* n) noexcept
+	{
+		n->_mbnext.store(nullptr, std::memory_order_relaxed);
+		Link* prev = head.exchange(n, std::memory_order_acq_rel);
+		prev->_mbnext.store(n, std::memory_order_release); // link into the queue
+	}
+
+	static T* message(Link* n) noexcept { return static_cast<T*>(n); }
+
+public:
+	RCMailbox() noexcept : head(&stub), tail(&stub) {}
+	~RCMailbox() noexcept { drain([](RCPtr<T>) {}); }
+
+	// producer:
+	void push(RCPtr<T> msg) noexcept; // takes over the reference; msg must not be nullptr
+
+	// consumer:
+	bool	 isEmpty() const noexcept;
+	RCPtr<T> pop() noexcept; // returns nullptr if empty
+	template<typename FN>
+	uint drain(FN fn) noexcept(noexcept(fn(RCPtr<T>()))); // calls fn(RCPtr<T>) for all messages
+};
+
+
+// -----------------------------------------------------------------------
+//					  I M P L E M E N T A T I O N S
+// -----------------------------------------------------------------------
+
+template<typename T>
+void RCMailbox<T>::push(RCPtr<T> msg) noexcept
+{
+	assert(msg != nullptr);
+
+	T* p  = msg.p;
+	msg.p = nullptr; // the mailbox now owns the reference
+	push_link(p);
+}
+
+template<typename T>
+bool RCMailbox<T>::isEmpty() const noexcept
+{
+	// test whether there are no messages and no push is in progress
+	// if tail is not the stub then tail is a message
+
+	return tail == &stub && stub._mbnext.load(std::memory_order_acquire) == nullptr &&
+		   head.load(std::memory_order_acquire) == &stub;
+}
+
+template<typename T>
+RCPtr<T> RCMailbox<T>::pop() noexcept
+{
+	// get the next message
+	// returns nullptr if the mailbox is empty or a producer is just pushing the next message
+
+	RCPtr<T> msg;
+	Link*	 t	  = tail;
+	Link*	 next = t->_mbnext.load(std::memory_order_acquire);
+
+	if (t == &stub) // skip the stub
+	{
+		if (next == nullptr) return msg;
+		tail = t = next;
+		next	 = t->_mbnext.load(std::memory_order_acquire);
+	}
+
+	if (next == nullptr)
+	{
+		// t is the last message in the queue
+		// if head != t then a producer has swapped in another message but not yet linked it:
+		if (head.load(std::memory_order_acquire) != t) return msg;
+
+		// push the stub behind t so that t can be unlinked:
+		push_link(&stub);
+		next = t->_mbnext.load(std::memory_order_acquire);
+		if (next == nullptr) return msg; // another producer came in between
+	}
+
+	tail  = next;
+	msg.p = message(t); // take over the reference
+	return msg;
+}
+
+template<typename T>
+template<typename FN>
+uint RCMailbox<T>::drain(FN fn) noexcept(noexcept(fn(RCPtr<T>())))
+{
+	// get all messages which are currently available
+	// returns the number of messages
+
+	uint n = 0;
+	while (RCPtr<T> msg = pop())
+	{
+		fn(std::move(msg));
+		n++;
+	}
+	return n;
+}
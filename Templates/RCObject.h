@@ -4,6 +4,7 @@
 
 #pragma once
 #include "RCPtr.h"
+#include <atomic>
 
 
 /*	base classes to be used instead of directly using RCDATA.	
@@ -20,3 +21,21 @@ class RCObject
 public:
 	virtual ~RCObject() = default;
 };
+
+
+/*	link for messages which are sent through a RCMailbox.
+	the link is stored in the message itself, so the mailbox needs no node allocation.
+	a message can only be in one mailbox at a time.
+*/
+
+struct RCMailboxLink
+{
+	std::atomic<RCMailboxLink*> _mbnext {nullptr};
+
+	RCMailboxLink() noexcept = default;
+	RCMailboxLink(const RCMailboxLink&) noexcept {}
+	RCMailboxLink& operator=(const RCMailboxLink&) noexcept { return *this; }
+};
+
+class RCMessage : public RCObject, public RCMailboxLink
+{};
@@ -0,0 +1,372 @@
+#pragma once
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+#include "Templates/RCPtr.h"
+#include "cpp/cppthreads.h"
+#include "kio/kio.h"
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+
+
+/*	Pool allocator for classes managed by RCPtr.
+
+	Classes which are created and destroyed at a high rate can add macro RCPOOLED to their class definition.
+	RCPOOLED must be placed in the public section because it defines operator new and delete for the class:
+
+	class Message
+	{
+	public:
+		RCDATA
+		RCPOOLED
+		...
+	};
+
+	RCPool has size classes in steps of 16 bytes up to 256 bytes and in steps of 64 bytes up to 1 kB.
+	Every thread has a freelist for each size class. allocate() and deallocate() pop from and push to
+	the freelists of the current thread without any locking.
+
+	Objects are not returned to the thread which allocated them. Instead, if a freelist grows too long,
+	a batch of BATCH objects is moved to a global depot for this size class, and if a freelist is empty
+	a batch is taken from the depot. So objects which are created in one thread and destroyed in another thread
+	flow back in batches and the mutex of the depot is locked only once per batch.
+	When a thread terminates it moves all its objects to the depot.
+
+	The memory is allocated in slabs of SLABSIZE bytes which are aligned to SLABSIZE.
+	The slab header holds the size class, so deallocate() does not need the size of the object.
+	This is required because the memory of objects with WeakPtrs is released after the object was destroyed.
+	Objects larger than MAXSIZE get a slab of their own. Don't use RCPOOLED for large classes.
+	Slabs are never returned to the system.
+
+	The counters in stats() are collected from the threads when they move a batch to or from the depot
+	and when they terminate. They are exact if all other threads which used the pool have terminated.
+*/
+
+
+// clang-format off
+#define RCPOOLED															\
+  static void* operator new(size_t size) { return kio::RCPool::allocate(size); } \
+  static void operator delete(void* p) noexcept { kio::RCPool::deallocate(p); } \
+  static constexpr bool _rc_pooled = true;
+// clang-format on
+
+
+namespace kio
+{
+
+class RCPool
+{
+public:
+	static constexpr uint SLABSIZE = 64 << 10;
+	static constexpr uint HEADER   = 64; // slab header, objects start at the next cache line
+	static constexpr uint MAXSIZE  = 1024;
+	static constexpr uint BATCH	   = 32; // objects moved to or from the depot at once
+
+	struct Stats
+	{
+		uint64 allocated;	// objects allocated
+		uint64 freed;		// objects deallocated
+		uint64 slabs;		// slabs allocated from the system for small objects
+		uint64 large;		// objects allocated in a slab of their own
+		uint64 batches_put; // batches moved to the depot
+		uint64 batches_got; // batches taken from the depot
+	};
+
+	static void* allocate(size_t size) throws; // throws std::bad_alloc
+	static void	 deallocate(void* p) noexcept;
+	static void	 flush() noexcept; // move all objects of the current thread to the depot
+	static Stats stats() noexcept;
+
+private:
+	static constexpr uint NUM_CLASSES = 16 + (MAXSIZE - 256) / 64;
+	static constexpr uint LARGE		  = ~0u;
+
+	struct Node
+	{
+		Node* next;		  // next object in freelist or batch
+		Node* next_batch; // only in the first object of a batch in the depot
+	};
+
+	struct Slab
+	{
+		uint sizeclass; // or LARGE
+	};
+
+	struct Cache // per thread
+	{
+		Node*  list[NUM_CLASSES];
+		uint   count[NUM_CLASSES];
+		uint64 allocated, freed; // not yet added to the global counters
+		bool   registered;		 // thread exit handler registered
+		bool   dead;			 // thread exit handler was called
+	};
+
+	struct alignas(64) Depot // per size class
+	{
+		PLock lock;
+		Node* batches = nullptr;
+	};
+
+	struct Counters
+	{
+		std::atomic<uint64> allocated {0}, freed {0}, slabs {0}, large {0}, batches_put {0}, batches_got {0};
+	};
+
+	struct ThreadExit
+	{
+		~ThreadExit() noexcept;
+	};
+
+	static uint sizeclass(size_t size) noexcept
+	{
+		return size <= 256 ? (uint(size) + 15) / 16 - (size != 0) : 16 + (uint(size) - 256 + 63) / 64 - 1;
+	}
+	static uint objsize(uint sizeclass) noexcept
+	{
+		return sizeclass < 16 ? (sizeclass + 1) * 16 : 256 + (sizeclass - 15) * 64;
+	}
+	static Slab* slab_of(void* p) noexcept
+	{
+		return reinterpret_cast<Slab*>(uintptr_t(p) & ~uintptr_t(SLABSIZE - 1)); //
+	}
+
+	static Cache& cache() noexcept
+	{
+		static thread_local Cache c; // zero-initialized, no guard
+		return c;
+	}
+	static Depot& depot(uint sizeclass) noexcept
+	{
+		// never destroyed: objects may be deallocated in static dtors
+		// c++14: new[] does not respect alignas > 16:
+		static Depot* depots = [] {
+			char*  memory = new char[NUM_CLASSES * sizeof(Depot) + 63];
+			Depot* d	  = reinterpret_cast<Depot*>((size_t(memory) + 63) & ~size_t(63));
+			for (uint i = 0; i < NUM_CLASSES; i++) { new (&d[i]) Depot; }
+			return d;
+		}();
+		return depots[sizeclass];
+	}
+	static Counters& counters() noexcept
+	{
+		static Counters* c = new Counters;
+		return *c;
+	}
+
+	static Node* refill(Cache&, uint sizeclass) throws;
+	static void	 drain(Cache&, uint sizeclass, uint keep) noexcept;
+	static void	 update_counters(Cache&) noexcept;
+	static void	 register_thread_exit(Cache&) noexcept;
+	static void* allocate_large(size_t size) throws;
+};
+
+
+// -----------------------------------------------------------------------
+//					  I M P L E M E N T A T I O N S
+// -----------------------------------------------------------------------
+
+inline void* RCPool::allocate(size_t size) throws
+{
+	if (unlikely(size > MAXSIZE)) return allocate_large(size);
+
+	uint   c  = sizeclass(size);
+	Cache& tc = cache();
+	Node*  p  = tc.list[c];
+	if (unlikely(!p)) p = refill(tc, c);
+
+	tc.list[c] = p->next;
+	tc.count[c]--;
+	tc.allocated++;
+	return p;
+}
+
+inline void RCPool::deallocate(void* p) noexcept
+{
+	if (!p) return;
+
+	Slab*  slab = slab_of(p);
+	uint   c	= slab->sizeclass;
+	Cache& tc	= cache();
+	tc.freed++;
+
+	if (unlikely(c == LARGE))
+	{
+		register_thread_exit(tc);
+		return ::free(slab);
+	}
+
+	Node* n	   = reinterpret_cast<Node*>(p);
+	n->next	   = tc.list[c];
+	tc.list[c] = n;
+	if (unlikely(++tc.count[c] > 2 * BATCH || !tc.registered || tc.dead))
+	{
+		register_thread_exit(tc); // thread may only deallocate objects
+		drain(tc, c, tc.dead ? 0 : BATCH);
+	}
+}
+
+inline void* RCPool::allocate_large(size_t size) throws
+{
+	// allocate a slab of its own for a large object
+	// the slab must be aligned to SLABSIZE to find the header
+
+	size_t sz	= (size + HEADER + SLABSIZE - 1) & ~size_t(SLABSIZE - 1);
+	Slab*  slab = reinterpret_cast<Slab*>(aligned_alloc(SLABSIZE, sz));
+	if (!slab) throw std::bad_alloc();
+	slab->sizeclass = LARGE;
+
+	Cache& tc = cache();
+	register_thread_exit(tc);
+	tc.allocated++;
+	counters().large++;
+	return reinterpret_cast<char*>(slab) + HEADER;
+}
+
+inline void RCPool::register_thread_exit(Cache& tc) noexcept
+{
+	// the Cache itself is trivially destructible because it may still be used after the thread exit handler.
+	// the handler is a thread_local variable which is constructed on first use:
+
+	if (tc.registered) return;
+	static thread_local ThreadExit thread_exit;
+	(void)thread_exit;
+	tc.registered = true;
+}
+
+inline RCPool::Node* RCPool::refill(Cache& tc, uint c) throws
+{
+	// the freelist for size class c is empty:
+	// take a batch from the depot or allocate a new slab
+	// returns the first node in the freelist
+
+	register_thread_exit(tc);
+	update_counters(tc);
+
+	Depot& d = depot(c);
+	Node*  batch;
+	{
+		PLocker<PLock> lock(d.lock);
+		batch = d.batches;
+		if (batch) d.batches = batch->next_batch;
+	}
+
+	if (batch)
+	{
+		counters().batches_got++;
+		uint n = 0;
+		for (Node* p = batch; p; p = p->next) n++;
+		tc.list[c]	= batch;
+		tc.count[c] = n;
+		return batch;
+	}
+
+	// allocate a new slab and cut it into batches.
+	// keep the first batch and move all other batches to the depot:
+
+	Slab* slab = reinterpret_cast<Slab*>(aligned_alloc(SLABSIZE, SLABSIZE));
+	if (!slab) throw std::bad_alloc();
+	slab->sizeclass = c;
+	counters().slabs++;
+
+	uint  size = objsize(c);
+	uint  num  = (SLABSIZE - HEADER) / size;
+	char* mem  = reinterpret_cast<char*>(slab) + HEADER;
+
+	Node* first = nullptr; // first batch in chain
+	Node* last	= nullptr; // last batch in chain
+	for (uint i0 = 0; i0 < num; i0 += BATCH)
+	{
+		uint e = min(i0 + BATCH, num);
+		for (uint i = i0; i < e; i++)
+		{
+			Node* n = reinterpret_cast<Node*>(mem + i * size);
+			n->next = i + 1 < e ? reinterpret_cast<Node*>(mem + (i + 1) * size) : nullptr;
+		}
+		Node* b		  = reinterpret_cast<Node*>(mem + i0 * size);
+		b->next_batch = nullptr;
+		if (last) last->next_batch = b;
+		else first = b;
+		last = b;
+	}
+
+	if (first != last)
+	{
+		PLocker<PLock> lock(d.lock);
+		last->next_batch = d.batches;
+		d.batches		 = first->next_batch;
+	}
+
+	tc.list[c]	= first;
+	tc.count[c] = min(BATCH, num);
+	return first;
+}
+
+inline void RCPool::drain(Cache& tc, uint c, uint keep) noexcept
+{
+	// move all but 'keep' objects from the freelist of size class c to the depot as one batch
+
+	if (tc.count[c] <= keep) return;
+
+	Node* p = tc.list[c];
+	for (uint i = 1; i < keep; i++) p = p->next;
+	Node* batch = keep ? p->next : p;
+	if (keep) p->next = nullptr;
+	else tc.list[c] = nullptr;
+	tc.count[c] = keep;
+
+	Depot& d = depot(c);
+	{
+		PLocker<PLock> lock(d.lock);
+		batch->next_batch = d.batches;
+		d.batches		  = batch;
+	}
+	counters().batches_put++;
+	update_counters(tc);
+}
+
+inline void RCPool::update_counters(Cache& tc) noexcept
+{
+	// add the per-thread counters to the global counters
+
+	Counters& g = counters();
+	if (tc.allocated) g.allocated += tc.allocated;
+	if (tc.freed) g.freed += tc.freed;
+	tc.allocated = tc.freed = 0;
+}
+
+inline void RCPool::flush() noexcept
+{
+	Cache& tc = cache();
+	for (uint c = 0; c < NUM_CLASSES; c++) drain(tc, c, 0);
+	update_counters(tc);
+}
+
+inline RCPool::ThreadExit::~ThreadExit() noexcept
+{
+	// the thread terminates:
+	// move all objects to the depot.
+	// objects which are deallocated later by this thread, e.g. by dtors of other thread_local variables,
+	// are moved to the depot immediately.
+
+	flush();
+	cache().dead = true;
+}
+
+inline RCPool::Stats RCPool::stats() noexcept
+{
+	Cache&	  tc = cache();
+	Counters& g	 = counters();
+
+	Stats s;
+	s.allocated	  = g.allocated + tc.allocated;
+	s.freed		  = g.freed + tc.freed;
+	s.slabs		  = g.slabs;
+	s.large		  = g.large;
+	s.batches_put = g.batches_put;
+	s.batches_got = g.batches_got;
+	return s;
+}
+
+} // namespace kio
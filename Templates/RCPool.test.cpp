@@ -0,0 +1,278 @@
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+
+#include "Templates/RCPool.h"
+#include "Templates/MPMCQueue.h"
+#include "Templates/RCArray.h"
+#include "doctest/doctest/doctest.h"
+#include <thread>
+#include <vector>
+
+using namespace kio;
+
+
+static std::atomic<int> num_messages {0};
+
+class PooledMessage
+{
+public:
+	RCDATA
+	RCPOOLED
+
+	uint32 id;
+	uint32 data[5];
+
+	PooledMessage(uint32 id = 0) noexcept : id(id) { num_messages++; }
+	virtual ~PooledMessage() noexcept { num_messages--; }
+};
+
+class BigPooledMessage : public PooledMessage
+{
+public:
+	char buffer[200];
+	BigPooledMessage(uint32 id) noexcept : PooledMessage(id) { buffer[199] = char(id); }
+};
+
+class HugePooledMessage : public PooledMessage
+{
+public:
+	char buffer[5000];
+	HugePooledMessage(uint32 id) noexcept : PooledMessage(id) { buffer[4999] = char(id); }
+};
+
+// for the performance test, without the atomic counter:
+
+class HeapMessage
+{
+public:
+	RCDATA
+
+	uint32 id;
+	uint32 data[5];
+
+	HeapMessage(uint32 id = 0) noexcept : id(id) {}
+	virtual ~HeapMessage() noexcept = default;
+};
+
+class PoolMessage : public HeapMessage
+{
+public:
+	RCPOOLED
+	using HeapMessage::HeapMessage;
+};
+
+static_assert(rc_pooled<PooledMessage>::value, "");
+static_assert(rc_pooled<BigPooledMessage>::value, "");
+static_assert(!rc_pooled<HeapMessage>::value, "");
+static_assert(rc_pooled<PoolMessage>::value, "");
+
+
+TEST_CASE("RCPool")
+{
+	SUBCASE("") { logline("●●● %s:", __FILE__); }
+
+	SUBCASE("single thread")
+	{
+		RCPool::Stats s0 = RCPool::stats();
+		{
+			RCArray<PooledMessage> a;
+			for (uint i = 0; i < 1000; i++) a << new PooledMessage(i);
+			CHECK(num_messages == 1000);
+
+			RCPool::Stats s1 = RCPool::stats();
+			CHECK(s1.allocated - s0.allocated == 1000);
+			CHECK(s1.freed - s0.freed == 0);
+
+			uint errors = 0;
+			for (uint i = 0; i < 1000; i++) errors += a[i]->id != i;
+			for (uint i = 1; i < 1000; i++) errors += a[i] == a[i - 1];
+			CHECK(errors == 0);
+		}
+		CHECK(num_messages == 0);
+		RCPool::Stats s2 = RCPool::stats();
+		CHECK(s2.allocated - s0.allocated == 1000);
+		CHECK(s2.freed - s0.freed == 1000);
+
+		// freed objects are reused:
+		void* p1 = new PooledMessage(1);
+		delete reinterpret_cast<PooledMessage*>(p1);
+		void* p2 = new PooledMessage(2);
+		CHECK(p1 == p2);
+		delete reinterpret_cast<PooledMessage*>(p2);
+	}
+
+	SUBCASE("subclasses")
+	{
+		RCPool::Stats s0 = RCPool::stats();
+		{
+			RCPtr<PooledMessage> a = new BigPooledMessage(1);
+			RCPtr<PooledMessage> b = new HugePooledMessage(2);
+			RCPtr<PooledMessage> c = new PooledMessage(3);
+			CHECK(num_messages == 3);
+			CHECK(a->id == 1);
+			CHECK(b->id == 2);
+			CHECK(c->id == 3);
+			CHECK(RCPool::stats().large - s0.large == 1);
+		}
+		CHECK(num_messages == 0);
+		RCPool::Stats s1 = RCPool::stats();
+		CHECK(s1.allocated - s0.allocated == 3);
+		CHECK(s1.freed - s0.freed == 3);
+	}
+
+	SUBCASE("WeakPtr")
+	{
+		// the object is destroyed with the last RCPtr
+		// but the memory is released with the last WeakPtr:
+
+		RCPool::Stats s0 = RCPool::stats();
+		RCPtr<PooledMessage>  a = new BigPooledMessage(42);
+		WeakPtr<PooledMessage> w {a};
+		CHECK(RCPtr<PooledMessage>(w)->id == 42);
+		a = nullptr;
+		CHECK(num_messages == 0);
+		CHECK(RCPool::stats().freed == s0.freed);
+		CHECK(RCPtr<PooledMessage>(w) == nullptr); // clears w
+		CHECK(RCPool::stats().freed - s0.freed == 1);
+	}
+
+	SUBCASE("multiple threads")
+	{
+		// objects are created in the producer threads and destroyed in the consumer threads
+
+		static constexpr uint N = 100000, T = 2;
+		static MPMCQueue<PooledMessage*, 256> q;
+
+		RCPool::Stats			 s0 = RCPool::stats();
+		std::atomic<uint64>		 sum {0};
+		std::vector<std::thread> threads;
+		for (uint t = 0; t < T; t++)
+		{
+			threads.emplace_back([t] {
+				for (uint i = 0; i < N; i++) q.put(new PooledMessage(t * N + i));
+			});
+			threads.emplace_back([&sum] {
+				for (uint i = 0; i < N; i++)
+				{
+					RCPtr<PooledMessage> m = q.get(); // takes ownership
+					sum += m->id;
+				}
+			});
+		}
+		for (auto& t : threads) t.join();
+
+		RCPool::Stats s1 = RCPool::stats();
+		CHECK(sum == uint64(N * T) * (N * T - 1) / 2);
+		CHECK(num_messages == 0);
+		CHECK(s1.allocated - s0.allocated == N * T);
+		CHECK(s1.freed - s0.freed == N * T);
+		CHECK(s1.batches_got - s0.batches_got > 0);
+		CHECK(s1.batches_put - s0.batches_put > 0);
+	}
+}
+
+
+template<typename MSG, uint SIZE>
+static bool receive(MPMCQueue<MSG*, SIZE>& q)
+{
+	MSG* p;
+	if (!q.try_get(p)) return false;
+	RCPtr<MSG> m {p}; // takes ownership and destroys the message
+	return true;
+}
+
+template<typename MSG>
+static double create_and_destroy(uint num_threads, uint n)
+{
+	// every thread creates n messages and sends them to the next thread which destroys them
+
+	static constexpr uint SIZE = 1024;
+	using Queue				   = MPMCQueue<MSG*, SIZE>;
+
+	// c++14: new does not respect alignas > 16:
+	std::vector<char> memory(num_threads * sizeof(Queue) + 63);
+	Queue*			  queues = reinterpret_cast<Queue*>((size_t(memory.data()) + 63) & ~size_t(63));
+	for (uint i = 0; i < num_threads; i++) { new (&queues[i]) Queue; }
+
+	double					 t0 = now();
+	std::vector<std::thread> threads;
+	for (uint t = 0; t < num_threads; t++)
+	{
+		threads.emplace_back([t, n, num_threads, queues] {
+			auto& out = queues[t];
+			auto& in  = queues[(t + 1) % num_threads];
+			uint  nin = 0;
+			for (uint i = 0; i < n; i++)
+			{
+				MSG* m = new MSG(i);
+				while (!out.try_put(m))
+				{
+					if (receive(in)) nin++;
+					else std::this_thread::yield();
+				}
+				nin += receive(in);
+			}
+			while (nin < n)
+			{
+				if (!receive(in)) std::this_thread::yield();
+				else nin++;
+			}
+		});
+	}
+	for (auto& t : threads) t.join();
+	double t1 = now();
+
+	for (uint i = 0; i < num_threads; i++) { queues[i].~Queue(); }
+	return (t1 - t0) / (num_threads * n);
+}
+
+template<typename MSG>
+static double replace_locally(uint num_threads, uint n)
+{
+	// every thread replaces n messages in a small array: measures new and delete only
+
+	double					 t0 = now();
+	std::vector<std::thread> threads;
+	for (uint t = 0; t < num_threads; t++)
+	{
+		threads.emplace_back([n] {
+			MSG* a[64] = {nullptr};
+			for (uint i = 0; i < n; i++)
+			{
+				MSG*& p = a[(i * 7) & 63];
+				delete p;
+				p = new MSG(i);
+			}
+			for (MSG* p : a) delete p;
+		});
+	}
+	for (auto& t : threads) t.join();
+	return (now() - t0) / (num_threads * n);
+}
+
+TEST_CASE("RCPool performance test" * doctest::skip(false))
+{
+	static constexpr uint N = 1000000;
+
+	for (uint num_threads = 1; num_threads <= 4; num_threads *= 2)
+	{
+		RCPool::Stats s0 = RCPool::stats();
+		double		  t1 = replace_locally<HeapMessage>(num_threads, N);
+		double		  t2 = replace_locally<PoolMessage>(num_threads, N);
+		double		  t3 = create_and_destroy<HeapMessage>(num_threads, N);
+		double		  t4 = create_and_destroy<PoolMessage>(num_threads, N);
+		RCPool::Stats s1 = RCPool::stats();
+
+		CHECK(s1.allocated - s0.allocated == 2 * num_threads * N);
+		CHECK(s1.freed - s0.freed == 2 * num_threads * N);
+
+		logline("%u threads: same thread:  new/delete %5.1f ns, RCPOOLED %5.1f ns", num_threads, t1 * 1e9, t2 * 1e9);
+		logline("%u threads: next thread:  new/delete %5.1f ns, RCPOOLED %5.1f ns (RCPtr + MPMCQueue)", num_threads,
+				t3 * 1e9, t4 * 1e9);
+		logline("  RCPool: %lu allocated, %lu freed, %lu slabs, %lu batches put, %lu batches got",
+				ulong(s1.allocated - s0.allocated), ulong(s1.freed - s0.freed), ulong(s1.slabs),
+				ulong(s1.batches_put - s0.batches_put), ulong(s1.batches_got - s0.batches_got));
+	}
+}
@@ -32,7 +32,7 @@
 	- WeakPtrs: destruction and deallocation of objects can be split in 2 operations
 	  -> memory is not freed until the last WeakPtr goes away
 	  -> deallocation is done with wrong type -> fails for heaps which use sized alloc/dealloc (rare)
-	  -> fails for custom allocators for classes
+	  -> fails for custom allocators for classes, except for RCPOOLED (see RCPool.h)
 
 
 	Mixed info:
@@ -41,7 +41,6 @@
 	If multiple threads can access and modify a smart pointer at the same time, then this must be locked.
 
 	Use of RCPtr and WeakPtr is lock-free (non-blocking).
-	The only locking operation is the conversion of a WeakPtr into an RCPtr.
 
 	Support for RCPtr to a class is achieved by adding macro RCDATA to the class definition:
 
@@ -50,6 +49,9 @@
 	- macro RCDATA_NOWEAK
 	These macros also define a member function 'refcnt()' which returns the hard count.
 
+	Classes which are created and destroyed at a high rate can additionally add macro RCPOOLED
+	to allocate them from a thread-local pool instead of the heap. see RCPool.h.
+
 
 	Usage example
 	-------------
@@ -78,8 +80,8 @@
 	}
 
 
-	Locking of objects and mutex (spinlock) in WeakPtr
-	--------------------------------------------------
+	Locking of objects in WeakPtr
+	-----------------------------
 
 	the WeakPtr locks the memory by incrementing _rcdata.wc ("weak count").
 	the RCPtr additionally locks the object by incrementing _rcdata.hc ("hard count").
@@ -87,21 +89,11 @@
 	if the RCPtr decrements _rcdata.hc to zero it must destroy the object.
 	if the RCPtr or WeakPtr decrements _rcdata.wc to zero it must free the memory.
 
-	The only locking operation:
-
 	In constructor RCPtr(WeakPtr) the hard count hc must be increased, but _only_ if it is non-zero.
-	We can also blindly increase hc and undo it if ++hc == 1.
-	In the first case we have a race condition with the possible destruction of the last RCPtr on another thread,
-	In the second case there is a race condition with a second thread performing RCPtr(WeakPtr) at the same time.
-	If we put a mutex around the second operation, then the mutex is only needed here. fine!
-	But in order to avoid unneeded mutex lock/unlock, we test for hc!=0 beforehand anyway.
-
-	With both tests the total chances for failure (without lock) is miniscule.
-	If all RCPtr(WeakPtr) conversions for a class happen only on the same thread,
-	  e.g. for observers running on a 'gui thread', then this cannot happen at all.
-	If all RCPtr destructions and all RCPtr(WeakPtr) conversions for a class happen
-	  only on the same _two_ threads then this cannot happen too.
-	Then you could use RCDATA_WEAK_NOLOCK in your class definition. But you shouldn't. You'll forget about it.
+	This is done with a compare-and-swap loop on hc of the object itself:
+	once hc went down to zero it can never be increased again, so there is no race condition
+	with the destruction of the last RCPtr on another thread and no global lock is needed.
+	Threads which convert WeakPtrs to different objects don't touch a shared cache line.
 */
 
 
@@ -173,33 +165,53 @@ struct RCDataWithWeak
 
 
 #ifdef NO_THREADS
-inline void rc_lock_spinlock() noexcept {}	 // n.ex.
-inline void rc_unlock_spinlock() noexcept {} // n.ex.
+inline bool rc_retain_if_nonzero(rc_uint32_t& hc) noexcept
+{
+	if (hc == 0) return false;
+	++hc;
+	return true;
+}
 #else
-
-//extern std::atomic_flag rc_spinlock;
-extern std::atomic_bool rc_spinlock;
-
-inline void rc_lock_spinlock() noexcept
+inline bool rc_retain_if_nonzero(rc_uint32_t& hc) noexcept
 {
-	for (int i = 0; rc_spinlock.exchange(true, std::memory_order_acquire); i++)
+	// increment the hard count, but only if it is non-zero
+	// returns false if the object was already destroyed
+
+	uint32_t n = hc.load(std::memory_order_relaxed);
+	while (n != 0 && !hc.compare_exchange_weak(n, n + 1, std::memory_order_acquire, std::memory_order_relaxed))
 	{
-		// we didn't get the lock:
-		// wait until we see that it's free.
-		// this happens only very rarely.
-		// if we block too long then yield to other thread:
-		while (rc_spinlock.load(std::memory_order_relaxed))
-		{
-			if (i > 10) std::this_thread::yield();
-		}
+		// n was updated by compare_exchange_weak()
 	}
+	return n != 0;
 }
+#endif
+
 
-inline void rc_unlock_spinlock() noexcept
+// classes with macro RCPOOLED have their own operator delete.
+// the memory of objects with WeakPtrs is released after the object was destroyed
+// and must then be released with this operator delete as well:
+template<typename T, typename = bool>
+struct rc_pooled : std::false_type
+{};
+template<typename T>
+struct rc_pooled<T, typename std::enable_if<T::_rc_pooled, bool>::type> : std::true_type
+{};
+
+template<typename T>
+inline void rc_free(T* p, std::true_type) noexcept
 {
-	rc_spinlock.store(false, std::memory_order_release); //
+	T::operator delete(p);
+}
+template<typename T>
+inline void rc_free(T* p, std::false_type) noexcept
+{
+	delete reinterpret_cast<const volatile char*>(p);
+}
+template<typename T>
+inline void rc_free(T* p) noexcept
+{
+	rc_free(p, rc_pooled<T> {});
 }
-#endif
 
 
 template<typename T>
@@ -225,7 +237,7 @@ class WeakPtr
 	}
 	static void release(T* p) noexcept
 	{
-		if (p && --p->_rcdata.wc == 0) delete reinterpret_cast<const volatile char*>(p);
+		if (p && --p->_rcdata.wc == 0) rc_free(p);
 	}
 
 public:
@@ -321,6 +333,8 @@ class RCPtr
 	friend class RCArray;
 	template<class T1, class T2>
 	friend class RCHashMap;
+	template<class TT>
+	friend class RCMailbox;
 
 	T* p {nullptr};
 
@@ -340,7 +354,7 @@ private:
 			if (T::_has_wc) // sequence hc, tc:
 			{
 				if (--p->_rcdata.hc == 0) p->~T();
-				if (--p->_rcdata.wc == 0) delete reinterpret_cast<const volatile char*>(p);
+				if (--p->_rcdata.wc == 0) rc_free(p);
 			}
 			else
 			{
@@ -397,22 +411,10 @@ public:
 	{
 		if (T* qp = q.p) // not null
 		{
-			if (qp->_rcdata.hc > 0) // has hard locks
+			if (rc_retain_if_nonzero(qp->_rcdata.hc)) // got it
 			{
-				rc_lock_spinlock();
-
-				if (++qp->_rcdata.hc > 1) // got it
-				{
-					++qp->_rcdata.wc;
-					p = qp;
-				}
-				else // just destroyed
-				{
-					// --qp->_rcdata.hc;
-					qp->_rcdata.hc = 0;
-				}
-
-				rc_unlock_spinlock();
+				++qp->_rcdata.wc;
+				p = qp;
 			}
 			else q = nullptr; // clear the WeakPtr so that it no longer locks the memory
 		}
@@ -0,0 +1,1004 @@
+#pragma once
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+#include "Templates/Array.h"
+#include "Templates/StrArray.h"
+#include "Templates/sort.h"
+#include "kio/kio.h"
+
+
+/*	RadixTree<ITEM> stores items with c-string keys in an adaptive radix tree (ART).
+
+	The tree branches on one byte of the key per level. Inner nodes have room for 4, 16, 48 or 256 children
+	and are replaced with the next larger or smaller type as children are added or removed.
+	Runs of bytes which are common to all keys below a node are stored once in the node (path compression)
+	and a leaf only stores the part of its key after the last branch.
+	Therefore keys with long common prefixes, e.g. file paths, need much less memory than in a HashMap,
+	which additionally needs the strings itself, and keys need not remain valid after add().
+
+	The terminating 0 of a key is used as the branch byte after the last character:
+	no key can be the prefix of another key and keys are visited in strcmp() order.
+
+	Nodes and leaves are allocated in an arena with one free list per size.
+	Memory of removed nodes and leaves is reused for new ones but only given back to the system by purge().
+	(memory of keys > 4 kB is not even reused.)
+
+	find() returns a pointer to the item or nullptr.
+	prefix_range() calls fn(cstr key, ITEM& item) for all keys which start with a prefix, in sorted order.
+	The key passed to fn is only valid during the call.
+	add_all() builds the tree bottom-up from sorted keys if the tree is empty.
+
+	ITEM must be a flat type, e.g. an index or pointer.
+*/
+
+
+template<typename ITEM>
+class RadixTree
+{
+	static_assert(alignof(ITEM) <= 8, "ITEM alignment > 8 not supported");
+
+	using Ref = uintptr_t; // Node* or Leaf* | 1 or 0
+
+	enum NodeType : uint8 { NODE4, NODE16, NODE48, NODE256 };
+
+	struct Node
+	{
+		NodeType type;
+		uint8	 _padding;
+		uint16	 count;		 // number of children
+		uint32	 prefix_len; // the prefix is stored after the node
+	};
+	struct Node4 : public Node
+	{
+		uint8 keys[4]; // sorted
+		uint8 _padding[4];
+		Ref	  children[4];
+	};
+	struct Node16 : public Node
+	{
+		uint8 keys[16]; // sorted
+		Ref	  children[16];
+	};
+	struct Node48 : public Node
+	{
+		uint8 index[256]; // child index + 1 or 0
+		Ref	  children[48];
+	};
+	struct Node256 : public Node
+	{
+		Ref children[256];
+	};
+	struct Leaf
+	{
+		ITEM   item;
+		uint32 len; // key suffix incl. 0 is stored after the leaf
+	};
+
+	// arena:
+	static constexpr uint BLOCKSIZE = 64 * 1024;
+	static constexpr uint MAXFREE	= 4096; // max. size for reuse
+	Array<char*>		  blocks;
+	char*				  block_ptr = nullptr;
+	char*				  block_end = nullptr;
+	Array<void*>		  free_lists; // index = size / 8
+	size_t				  used		= 0;
+	size_t				  allocated = 0;
+
+	Ref	 root = 0;
+	uint cnt  = 0;
+
+	void* alloc(uint size) throws;
+	void  free(void* p, uint size) noexcept;
+
+	static bool	 is_leaf(Ref r) noexcept { return r & 1; }
+	static Leaf* leaf(Ref r) noexcept { return reinterpret_cast<Leaf*>(r - 1); }
+	static Node* node(Ref r) noexcept { return reinterpret_cast<Node*>(r); }
+	static cstr	 suffix(const Leaf* l) noexcept { return reinterpret_cast<cstr>(l + 1); }
+	static uint	 leaf_size(uint len) noexcept { return sizeof(Leaf) + len; }
+	static uint	 node_size(NodeType) noexcept;
+	static cstr	 prefix(const Node* n) noexcept { return reinterpret_cast<cstr>(n) + node_size(n->type); }
+
+	Ref	  new_leaf(cstr suffix, uint len, ITEM) throws;
+	Ref	  new_leaf(cstr prefix, uint plen, uint8 c, const Leaf*) throws; // prefix + c + leaf suffix
+	void  free_leaf(Ref) noexcept;
+	Node* new_node(NodeType, cstr prefix, uint plen) throws;
+	Node* new_node(NodeType, cstr prefix, uint plen, uint8 c, const Node*) throws; // prefix + c + node prefix
+	void  free_node(Node*) noexcept;
+	void  copy_children(Node* z, const Node* q) noexcept;
+
+	static Ref*	 find_child(Node*, uint8 c) noexcept;
+	static Ref	 first_child(const Node*, uint8* c) noexcept;
+	static void	 add_child_nogrow(Node*, uint8 c, Ref child) noexcept;
+	void		 add_child(Ref* slot, uint8 c, Ref child) throws;
+	void		 remove_child(Ref* slot, uint8 c) noexcept;
+	Ref			 build(const cstr* keys, const ITEM* items, uint n, uint depth) throws;
+	void		 destroy_items(Ref) noexcept;
+	template<typename FN>
+	void for_each(Ref, Array<char>& key, FN&& fn);
+
+public:
+	RadixTree() noexcept = default;
+	RadixTree(RadixTree&&) noexcept;
+	RadixTree& operator=(RadixTree&&) noexcept;
+	~RadixTree() noexcept { purge(); }
+	NO_COPY(RadixTree);
+
+	// access data members:
+	uint   count() const noexcept { return cnt; }
+	size_t memoryUsed() const noexcept { return used; } // in nodes and leaves
+	size_t memoryAllocated() const noexcept { return allocated; }
+
+	// get items:
+	ITEM*		find(cstr key) noexcept;
+	const ITEM* find(cstr key) const noexcept { return const_cast<RadixTree*>(this)->find(key); }
+	bool		contains(cstr key) const noexcept { return find(key) != nullptr; }
+	ITEM		get(cstr key, ITEM dflt) const noexcept
+	{
+		const ITEM* p = find(key);
+		return p ? *p : dflt;
+	}
+	ITEM& operator[](cstr key) noexcept
+	{
+		ITEM* p = find(key);
+		assert(p);
+		return *p;
+	}
+
+	// add / remove items:
+	ITEM& add(cstr key, ITEM) throws; // overwrites if key already exists
+	bool  remove(cstr key) noexcept;   // returns false if key does not exist
+	void  purge() noexcept;			   // remove all and release memory
+	void  add_all(const cstr* keys, const ITEM* items, uint n) throws;
+	void  add_all(const Array<cstr>& keys, const Array<ITEM>& items) throws;
+	void  add_all(const StrArray& keys, const Array<ITEM>& items) throws;
+
+	// iterate:
+	template<typename FN>
+	void prefix_range(cstr prefix, FN&& fn); // calls fn(cstr key, ITEM& item) for all keys which start with prefix
+	template<typename FN>
+	void for_each(FN&& fn) { prefix_range("", std::forward<FN>(fn)); }
+};
+
+
+// -----------------------------------------------------------------------
+//					  I M P L E M E N T A T I O N S
+// -----------------------------------------------------------------------
+
+template<typename ITEM>
+inline str tostr(const RadixTree<ITEM>& tree)
+{
+	// return 1-line description of tree for debugging and logging:
+	return usingstr("RadixTree[%u]", tree.count());
+}
+
+template<typename ITEM>
+RadixTree<ITEM>::RadixTree(RadixTree&& q) noexcept :
+	blocks(std::move(q.blocks)),
+	block_ptr(q.block_ptr),
+	block_end(q.block_end),
+	free_lists(std::move(q.free_lists)),
+	used(q.used),
+	allocated(q.allocated),
+	root(q.root),
+	cnt(q.cnt)
+{
+	q.block_ptr = q.block_end = nullptr;
+	q.used						= 0;
+	q.allocated					= 0;
+	q.root						= 0;
+	q.cnt						= 0;
+}
+
+template<typename ITEM>
+RadixTree<ITEM>& RadixTree<ITEM>::operator=(RadixTree&& q) noexcept
+{
+	std::swap(blocks, q.blocks);
+	std::swap(block_ptr, q.block_ptr);
+	std::swap(block_end, q.block_end);
+	std::swap(free_lists, q.free_lists);
+	std::swap(used, q.used);
+	std::swap(allocated, q.allocated);
+	std::swap(root, q.root);
+	std::swap(cnt, q.cnt);
+	return *this;
+}
+
+// ____ arena ____
+
+template<typename ITEM>
+void* RadixTree<ITEM>::alloc(uint size) throws
+{
+	// allocate memory for a node or leaf
+	// from the free list for this size or from the current block
+
+	size = (size + 7) & ~7u;
+
+	uint i = size / 8;
+	if (i < free_lists.count() && free_lists[i])
+	{
+		void* p		  = free_lists[i];
+		free_lists[i] = *reinterpret_cast<void**>(p);
+		used += size;
+		return p;
+	}
+
+	if (size > BLOCKSIZE / 4)
+	{
+		// large key: own block
+
+		blocks.growmax(blocks.count() + 1);
+		char* p = new char[size];
+		blocks.append(p);
+		allocated += size;
+		used += size;
+		return p;
+	}
+
+	if (block_ptr + size > block_end)
+	{
+		blocks.growmax(blocks.count() + 1);
+		block_ptr = new char[BLOCKSIZE];
+		block_end = block_ptr + BLOCKSIZE;
+		blocks.append(block_ptr);
+		allocated += BLOCKSIZE;
+	}
+	void* p = block_ptr;
+	block_ptr += size;
+	used += size;
+	return p;
+}
+
+template<typename ITEM>
+void RadixTree<ITEM>::free(void* p, uint size) noexcept
+{
+	// put memory of a node or leaf into the free list for this size
+
+	size = (size + 7) & ~7u;
+	used -= size;
+	if (size > MAXFREE) return;
+
+	uint i = size / 8;
+	if (i >= free_lists.count())
+	{
+		try
+		{
+			free_lists.grow(MAXFREE / 8 + 1);
+		}
+		catch (std::bad_alloc&)
+		{
+			return;
+		}
+	}
+	*reinterpret_cast<void**>(p) = free_lists[i];
+	free_lists[i]				 = p;
+}
+
+template<typename ITEM>
+void RadixTree<ITEM>::purge() noexcept
+{
+	destroy_items(root);
+	for (uint i = 0; i < blocks.count(); i++) delete[] blocks[i];
+	blocks.purge();
+	free_lists.purge();
+	block_ptr = block_end = nullptr;
+	used				  = 0;
+	allocated			  = 0;
+	root				  = 0;
+	cnt					  = 0;
+}
+
+template<typename ITEM>
+void RadixTree<ITEM>::destroy_items(Ref r) noexcept
+{
+	if (std::is_trivially_destructible<ITEM>::value || r == 0) return;
+	if (is_leaf(r))
+	{
+		leaf(r)->item.~ITEM();
+		return;
+	}
+
+	Node* n = node(r);
+	for (uint c = 0; c < 256; c++)
+	{
+		Ref* p = find_child(n, uint8(c));
+		if (p) destroy_items(*p);
+	}
+}
+
+// ____ nodes and leaves ____
+
+template<typename ITEM>
+uint RadixTree<ITEM>::node_size(NodeType type) noexcept
+{
+	switch (type)
+	{
+	case NODE4: return sizeof(Node4);
+	case NODE16: return sizeof(Node16);
+	case NODE48: return sizeof(Node48);
+	default: return sizeof(Node256);
+	}
+}
+
+template<typename ITEM>
+typename RadixTree<ITEM>::Ref RadixTree<ITEM>::new_leaf(cstr q, uint len, ITEM item) throws
+{
+	// create leaf with key suffix q[len]
+	// len includes the terminating 0
+
+	Leaf* l = reinterpret_cast<Leaf*>(alloc(leaf_size(len)));
+	new (&l->item) ITEM(std::move(item));
+	l->len = len;
+	memcpy(const_cast<str>(suffix(l)), q, len);
+	return Ref(l) + 1;
+}
+
+template<typename ITEM>
+typename RadixTree<ITEM>::Ref RadixTree<ITEM>::new_leaf(cstr q, uint qlen, uint8 c, const Leaf* l2) throws
+{
+	// create leaf with key suffix = q[qlen] + c + suffix of leaf l2
+	// the item is moved from l2
+
+	uint  len = qlen + 1 + l2->len;
+	Leaf* l	  = reinterpret_cast<Leaf*>(alloc(leaf_size(len)));
+	new (&l->item) ITEM(std::move(const_cast<Leaf*>(l2)->item));
+	l->len = len;
+	str z  = const_cast<str>(suffix(l));
+	memcpy(z, q, qlen);
+	z[qlen] = char(c);
+	memcpy(z + qlen + 1, suffix(l2), l2->len);
+	return Ref(l) + 1;
+}
+
+template<typename ITEM>
+void RadixTree<ITEM>::free_leaf(Ref r) noexcept
+{
+	Leaf* l = leaf(r);
+	l->item.~ITEM();
+	free(l, leaf_size(l->len));
+}
+
+template<typename ITEM>
+typename RadixTree<ITEM>::Node* RadixTree<ITEM>::new_node(NodeType type, cstr q, uint plen) throws
+{
+	// create empty node with prefix q[plen]
+
+	uint  size = node_size(type);
+	Node* n	   = reinterpret_cast<Node*>(alloc(size + plen));
+	memset(n, 0, size);
+	n->type		  = type;
+	n->prefix_len = plen;
+	memcpy(ptr(n) + size, q, plen);
+	return n;
+}
+
+template<typename ITEM>
+typename RadixTree<ITEM>::Node* RadixTree<ITEM>::new_node(NodeType type, cstr q, uint qlen, uint8 c, const Node* n2)
+	throws
+{
+	// create node with prefix = q[qlen] + c + prefix of node n2
+	// the children are copied from n2
+
+	uint  size = node_size(type);
+	uint  plen = qlen + 1 + n2->prefix_len;
+	Node* n	   = reinterpret_cast<Node*>(alloc(size + plen));
+	n->type	   = type;
+	copy_children(n, n2);
+	n->prefix_len = plen;
+	str z		  = ptr(n) + size;
+	memcpy(z, q, qlen);
+	z[qlen] = char(c);
+	memcpy(z + qlen + 1, prefix(n2), n2->prefix_len);
+	return n;
+}
+
+template<typename ITEM>
+void RadixTree<ITEM>::free_node(Node* n) noexcept
+{
+	free(n, node_size(n->type) + n->prefix_len);
+}
+
+template<typename ITEM>
+void RadixTree<ITEM>::copy_children(Node* z, const Node* q) noexcept
+{
+	// copy children from node q into empty node z of any type
+	// z must be large enough
+
+	NodeType type = z->type;
+	uint32	 plen = z->prefix_len;
+	memset(z, 0, node_size(type));
+	z->type		  = type;
+	z->prefix_len = plen;
+
+	switch (q->type)
+	{
+	case NODE4:
+	case NODE16:
+	{
+		const uint8* keys	  = q->type == NODE4 ? static_cast<const Node4*>(q)->keys : static_cast<const Node16*>(q)->keys;
+		const Ref*	 children = q->type == NODE4 ? static_cast<const Node4*>(q)->children :
+												   static_cast<const Node16*>(q)->children;
+		for (uint i = 0; i < q->count; i++) add_child_nogrow(z, keys[i], children[i]);
+		break;
+	}
+	case NODE48:
+	{
+		const Node48* q48 = static_cast<const Node48*>(q);
+		for (uint c = 0; c < 256; c++)
+		{
+			if (q48->index[c]) add_child_nogrow(z, uint8(c), q48->children[q48->index[c] - 1]);
+		}
+		break;
+	}
+	case NODE256:
+	{
+		const Node256* q256 = static_cast<const Node256*>(q);
+		for (uint c = 0; c < 256; c++)
+		{
+			if (q256->children[c]) add_child_nogrow(z, uint8(c), q256->children[c]);
+		}
+		break;
+	}
+	}
+}
+
+template<typename ITEM>
+typename RadixTree<ITEM>::Ref* RadixTree<ITEM>::find_child(Node* n, uint8 c) noexcept
+{
+	// find slot of child for byte c
+	// returns nullptr if not found
+
+	switch (n->type)
+	{
+	case NODE4:
+	{
+		Node4* n4 = static_cast<Node4*>(n);
+		for (uint i = 0; i < n->count; i++)
+		{
+			if (n4->keys[i] == c) return &n4->children[i];
+		}
+		return nullptr;
+	}
+	case NODE16:
+	{
+		Node16* n16 = static_cast<Node16*>(n);
+		for (uint i = 0; i < n->count; i++)
+		{
+			if (n16->keys[i] >= c) return n16->keys[i] == c ? &n16->children[i] : nullptr;
+		}
+		return nullptr;
+	}
+	case NODE48:
+	{
+		Node48* n48 = static_cast<Node48*>(n);
+		uint	i	= n48->index[c];
+		return i ? &n48->children[i - 1] : nullptr;
+	}
+	default:
+	{
+		Node256* n256 = static_cast<Node256*>(n);
+		return n256->children[c] ? &n256->children[c] : nullptr;
+	}
+	}
+}
+
+template<typename ITEM>
+typename RadixTree<ITEM>::Ref RadixTree<ITEM>::first_child(const Node* n, uint8* c) noexcept
+{
+	// get the first child and its byte
+	// used to collapse a node with only one child
+
+	switch (n->type)
+	{
+	case NODE4: *c = static_cast<const Node4*>(n)->keys[0]; return static_cast<const Node4*>(n)->children[0];
+	case NODE16: *c = static_cast<const Node16*>(n)->keys[0]; return static_cast<const Node16*>(n)->children[0];
+	case NODE48:
+	{
+		const Node48* n48 = static_cast<const Node48*>(n);
+		for (uint i = 0; i < 256; i++)
+		{
+			if (n48->index[i]) { return *c = uint8(i), n48->children[n48->index[i] - 1]; }
+		}
+		assert(false); // node has no children
+		*c = 0;
+		return 0;
+	}
+	default:
+	{
+		const Node256* n256 = static_cast<const Node256*>(n);
+		for (uint i = 0; i < 256; i++)
+		{
+			if (n256->children[i]) { return *c = uint8(i), n256->children[i]; }
+		}
+		assert(false); // node has no children
+		*c = 0;
+		return 0;
+	}
+	}
+}
+
+template<typename ITEM>
+void RadixTree<ITEM>::add_child_nogrow(Node* n, uint8 c, Ref child) noexcept
+{
+	// add child for byte c to node n which must have room for it
+	// Node4 and Node16 keep their keys sorted
+
+	switch (n->type)
+	{
+	case NODE4:
+	case NODE16:
+	{
+		uint8* keys		= n->type == NODE4 ? static_cast<Node4*>(n)->keys : static_cast<Node16*>(n)->keys;
+		Ref*   children = n->type == NODE4 ? static_cast<Node4*>(n)->children : static_cast<Node16*>(n)->children;
+		assert(n->count < (n->type == NODE4 ? 4 : 16));
+
+		uint i = n->count;
+		while (i && keys[i - 1] > c)
+		{
+			keys[i]		= keys[i - 1];
+			children[i] = children[i - 1];
+			i--;
+		}
+		keys[i]		= c;
+		children[i] = child;
+		break;
+	}
+	case NODE48:
+	{
+		Node48* n48 = static_cast<Node48*>(n);
+		assert(n->count < 48);
+
+		uint i = 0;
+		while (n48->children[i]) i++; // find free slot
+		n48->children[i] = child;
+		n48->index[c]	 = uint8(i + 1);
+		break;
+	}
+	default: static_cast<Node256*>(n)->children[c] = child; break;
+	}
+	n->count++;
+}
+
+template<typename ITEM>
+void RadixTree<ITEM>::add_child(Ref* slot, uint8 c, Ref child) throws
+{
+	// add child for byte c to the node in *slot
+	// if the node is full then it is replaced with the next larger node type
+
+	Node* n = node(*slot);
+
+	static constexpr uint16 max_children[] = {4, 16, 48, 256};
+	if (n->count == max_children[n->type])
+	{
+		Node* z = new_node(NodeType(n->type + 1), prefix(n), n->prefix_len);
+		copy_children(z, n);
+		free_node(n);
+		*slot = Ref(n = z);
+	}
+	add_child_nogrow(n, c, child);
+}
+
+template<typename ITEM>
+void RadixTree<ITEM>::remove_child(Ref* slot, uint8 c) noexcept
+{
+	// remove child for byte c from the node in *slot
+	// if the node becomes small then it is replaced with the next smaller node type
+	// a node with only one child left is merged with the child
+
+	Node* n = node(*slot);
+
+	switch (n->type)
+	{
+	case NODE4:
+	case NODE16:
+	{
+		uint8* keys		= n->type == NODE4 ? static_cast<Node4*>(n)->keys : static_cast<Node16*>(n)->keys;
+		Ref*   children = n->type == NODE4 ? static_cast<Node4*>(n)->children : static_cast<Node16*>(n)->children;
+
+		uint i = 0;
+		while (keys[i] != c) i++;
+		for (n->count--; i < n->count; i++)
+		{
+			keys[i]		= keys[i + 1];
+			children[i] = children[i + 1];
+		}
+		break;
+	}
+	case NODE48:
+	{
+		Node48* n48 = static_cast<Node48*>(n);
+
+		n48->children[n48->index[c] - 1] = 0;
+		n48->index[c]					 = 0;
+		n->count--;
+		break;
+	}
+	default:
+		static_cast<Node256*>(n)->children[c] = 0;
+		n->count--;
+		break;
+	}
+
+	// replacing the node needs memory. if this fails then the node is kept.
+	try
+	{
+		if (n->count == 1)
+		{
+			// merge node with its only child:
+
+			uint8 c1;
+			Ref	  child = first_child(n, &c1);
+
+			if (is_leaf(child))
+			{
+				*slot = new_leaf(prefix(n), n->prefix_len, c1, leaf(child));
+				free_leaf(child); // item was moved
+			}
+			else
+			{
+				Node* n2 = node(child);
+				*slot	 = Ref(new_node(n2->type, prefix(n), n->prefix_len, c1, n2));
+				free_node(n2);
+			}
+			free_node(n);
+			return;
+		}
+
+		static constexpr uint16 min_children[] = {0, 3, 12, 37};
+		if (n->type != NODE4 && n->count == min_children[n->type])
+		{
+			Node* z = new_node(NodeType(n->type - 1), prefix(n), n->prefix_len);
+			copy_children(z, n);
+			free_node(n);
+			*slot = Ref(z);
+		}
+	}
+	catch (std::bad_alloc&)
+	{}
+}
+
+// ____ public API ____
+
+template<typename ITEM>
+ITEM* RadixTree<ITEM>::find(cstr key) noexcept
+{
+	uint len = uint(strlen(key)) + 1;
+	uint d	 = 0; // depth = bytes of key consumed
+	Ref	 r	 = root;
+
+	while (r)
+	{
+		if (is_leaf(r))
+		{
+			Leaf* l = leaf(r);
+			return l->len == len - d && memcmp(suffix(l), key + d, l->len) == 0 ? &l->item : nullptr;
+		}
+
+		// the prefix can't contain a 0 byte so the compare stops at the end of key:
+		Node* n	   = node(r);
+		uint  plen = n->prefix_len;
+		if (plen && strncmp(prefix(n), key + d, plen) != 0) return nullptr;
+		d += plen;
+
+		Ref* p = find_child(n, uint8(key[d++]));
+		r	   = p ? *p : 0;
+	}
+	return nullptr;
+}
+
+template<typename ITEM>
+ITEM& RadixTree<ITEM>::add(cstr key, ITEM item) throws
+{
+	// add item
+	// overwrites item if key already exists
+
+	uint len  = uint(strlen(key)) + 1;
+	uint d	  = 0;
+	Ref* slot = &root;
+
+	for (;;)
+	{
+		Ref r = *slot;
+		if (r == 0)
+		{
+			*slot = new_leaf(key + d, len - d, std::move(item));
+			cnt++;
+			return leaf(*slot)->item;
+		}
+
+		if (is_leaf(r))
+		{
+			Leaf* l = leaf(r);
+			cstr  s = suffix(l);
+
+			if (l->len == len - d && memcmp(s, key + d, l->len) == 0) return l->item = std::move(item); // same key
+
+			// find common prefix:
+			// a leaf reached with branch byte 0 has an empty suffix, but then it was the same key.
+			// else both are 0-terminated and differ before the end.
+			uint i = 0;
+			while (s[i] == key[d + i]) i++;
+
+			Node* n	 = new_node(NODE4, s, i);
+			Ref	  l2 = new_leaf(key + d + i + 1, len - d - i - 1, std::move(item));
+			add_child_nogrow(n, uint8(s[i]), new_leaf(s + i + 1, l->len - i - 1, std::move(l->item)));
+			add_child_nogrow(n, uint8(key[d + i]), l2);
+			free_leaf(r);
+			*slot = Ref(n);
+			cnt++;
+			return leaf(l2)->item;
+		}
+
+		Node* n	   = node(r);
+		cstr  p	   = prefix(n);
+		uint  plen = n->prefix_len;
+
+		uint i = 0;
+		while (i < plen && p[i] == key[d + i]) i++;
+		if (i < plen)
+		{
+			// the key differs in the prefix:
+			// split the prefix: new node with prefix[0..i], old node with prefix[i+1..]
+
+			Node* z	 = new_node(NODE4, p, i);
+			Node* n2 = new_node(n->type, p + i + 1, plen - i - 1);
+			copy_children(n2, n);
+			Ref l2 = new_leaf(key + d + i + 1, len - d - i - 1, std::move(item));
+			add_child_nogrow(z, uint8(p[i]), Ref(n2));
+			add_child_nogrow(z, uint8(key[d + i]), l2);
+			free_node(n);
+			*slot = Ref(z);
+			cnt++;
+			return leaf(l2)->item;
+		}
+		d += plen;
+
+		uint8 c = uint8(key[d]);
+		Ref*  q = find_child(n, c);
+		if (q == nullptr)
+		{
+			Ref l2 = new_leaf(key + d + 1, len - d - 1, std::move(item));
+			try
+			{
+				add_child(slot, c, l2);
+			}
+			catch (...)
+			{
+				free_leaf(l2);
+				throw;
+			}
+			cnt++;
+			return leaf(l2)->item;
+		}
+		slot = q;
+		d++;
+	}
+}
+
+template<typename ITEM>
+bool RadixTree<ITEM>::remove(cstr key) noexcept
+{
+	// remove item
+	// returns false if key does not exist
+
+	uint  len	  = uint(strlen(key)) + 1;
+	uint  d		  = 0;
+	Ref*  slot	  = &root;
+	Ref*  pslot	  = nullptr; // slot of the parent node
+	uint8 c		  = 0;		 // byte of the child in the parent node
+	Ref	  r;
+
+	while ((r = *slot))
+	{
+		if (is_leaf(r))
+		{
+			Leaf* l = leaf(r);
+			if (l->len != len - d || memcmp(suffix(l), key + d, l->len) != 0) return false;
+
+			if (pslot) remove_child(pslot, c);
+			else root = 0;
+			free_leaf(r);
+			cnt--;
+			return true;
+		}
+
+		Node* n	   = node(r);
+		uint  plen = n->prefix_len;
+		if (plen && strncmp(prefix(n), key + d, plen) != 0) return false;
+		d += plen;
+
+		c	  = uint8(key[d++]);
+		pslot = slot;
+		slot  = find_child(n, c);
+		if (!slot) return false;
+	}
+	return false;
+}
+
+template<typename ITEM>
+template<typename FN>
+void RadixTree<ITEM>::for_each(Ref r, Array<char>& key, FN&& fn)
+{
+	// call fn(key, item) for all leaves below r in sorted order
+	// key[] contains the bytes up to r and is restored on return
+
+	uint n = key.count();
+
+	if (is_leaf(r))
+	{
+		Leaf* l = leaf(r);
+		key.append(suffix(l), l->len);
+		fn(cstr(key.getData()), l->item);
+		key.shrink(n);
+		return;
+	}
+
+	Node* nd = node(r);
+	key.append(prefix(nd), nd->prefix_len);
+	switch (nd->type)
+	{
+	case NODE4:
+	case NODE16:
+	{
+		uint8* keys		= nd->type == NODE4 ? static_cast<Node4*>(nd)->keys : static_cast<Node16*>(nd)->keys;
+		Ref*   children = nd->type == NODE4 ? static_cast<Node4*>(nd)->children : static_cast<Node16*>(nd)->children;
+		for (uint i = 0; i < nd->count; i++)
+		{
+			key.append(char(keys[i]));
+			for_each(children[i], key, fn);
+			key.drop();
+		}
+		break;
+	}
+	default:
+	{
+		for (uint c = 0; c < 256; c++)
+		{
+			Ref* p = find_child(nd, uint8(c));
+			if (!p) continue;
+			key.append(char(c));
+			for_each(*p, key, fn);
+			key.drop();
+		}
+		break;
+	}
+	}
+	key.shrink(n);
+}
+
+template<typename ITEM>
+template<typename FN>
+void RadixTree<ITEM>::prefix_range(cstr pfx, FN&& fn)
+{
+	// call fn(cstr key, ITEM& item) for all keys which start with pfx
+	// keys are visited in sorted order
+	// the tree must not be modified by fn
+
+	uint		plen = uint(strlen(pfx));
+	uint		d	 = 0;
+	Ref			r	 = root;
+	Array<char> key(0u, 256);
+
+	while (r)
+	{
+		if (d == plen) return for_each(r, key, fn);
+
+		if (is_leaf(r))
+		{
+			Leaf* l = leaf(r);
+			if (l->len > plen - d && memcmp(suffix(l), pfx + d, plen - d) == 0) for_each(r, key, fn);
+			return;
+		}
+
+		Node* n	 = node(r);
+		uint  np = n->prefix_len;
+		if (memcmp(prefix(n), pfx + d, min(np, plen - d)) != 0) return;
+		if (d + np >= plen) return for_each(r, key, fn); // pfx ends in or after the node prefix
+
+		key.append(prefix(n), np);
+		d += np;
+
+		Ref* p = find_child(n, uint8(pfx[d]));
+		if (!p) return;
+		key.append(pfx[d++]);
+		r = *p;
+	}
+}
+
+template<typename ITEM>
+typename RadixTree<ITEM>::Ref RadixTree<ITEM>::build(const cstr* keys, const ITEM* items, uint n, uint d) throws
+{
+	// build tree for sorted, unique keys[n] bottom-up
+	// d = bytes of keys already consumed
+
+	assert(n);
+	if (n == 1) return new_leaf(keys[0] + d, uint(strlen(keys[0] + d)) + 1, items[0]);
+
+	// common prefix of all keys = common prefix of first and last key:
+	cstr a = keys[0] + d;
+	cstr e = keys[n - 1] + d;
+	uint i = 0;
+	while (a[i] == e[i]) i++;
+
+	// count children:
+	uint nc = 1;
+	for (uint k = 1; k < n; k++) nc += keys[k][d + i] != keys[k - 1][d + i];
+
+	NodeType type = nc <= 4 ? NODE4 : nc <= 16 ? NODE16 : nc <= 48 ? NODE48 : NODE256;
+	Node*	 node = new_node(type, a, i);
+
+	for (uint k0 = 0, k = 1; k0 < n; k0 = k++)
+	{
+		uint8 c = uint8(keys[k0][d + i]);
+		while (k < n && uint8(keys[k][d + i]) == c) k++;
+		add_child_nogrow(node, c, build(keys + k0, items + k0, k - k0, d + i + 1));
+	}
+	return Ref(node);
+}
+
+template<typename ITEM>
+void RadixTree<ITEM>::add_all(const cstr* keys, const ITEM* items, uint n) throws
+{
+	// add items
+	// if a key occurs multiple times then the last item is stored
+	// if the tree is empty then it is built bottom-up from the sorted keys
+	// else the keys are added one by one
+
+	if (cnt)
+	{
+		for (uint i = 0; i < n; i++) add(keys[i], items[i]);
+		return;
+	}
+	if (n == 0) return;
+
+	struct KeyIdx
+	{
+		cstr key;
+		uint idx;
+		static bool gt(const KeyIdx& a, const KeyIdx& b) noexcept
+		{
+			int r = strcmp(a.key, b.key);
+			return r ? r > 0 : a.idx > b.idx;
+		}
+	};
+
+	Array<KeyIdx> a(n);
+	for (uint i = 0; i < n; i++) a[i] = KeyIdx {keys[i], i};
+	sort(a.getData(), a.getData() + n, &KeyIdx::gt);
+
+	// remove duplicates, keep the last one:
+	Array<cstr> k(0u, n);
+	Array<ITEM> it(0u, n);
+	for (uint i = 0; i < n; i++)
+	{
+		if (i + 1 < n && strcmp(a[i].key, a[i + 1].key) == 0) continue;
+		k.append(a[i].key);
+		it.append(items[a[i].idx]);
+	}
+
+	try
+	{
+		root = build(k.getData(), it.getData(), k.count(), 0);
+		cnt	 = k.count();
+	}
+	catch (...)
+	{
+		purge();
+		throw;
+	}
+}
+
+template<typename ITEM>
+inline void RadixTree<ITEM>::add_all(const Array<cstr>& keys, const Array<ITEM>& items) throws
+{
+	assert(keys.count() == items.count());
+	add_all(keys.getData(), items.getData(), keys.count());
+}
+
+template<typename ITEM>
+inline void RadixTree<ITEM>::add_all(const StrArray& keys, const Array<ITEM>& items) throws
+{
+	assert(keys.count() == items.count());
+	add_all(const_cast<const cstr*>(keys.getData()), items.getData(), keys.count());
+}
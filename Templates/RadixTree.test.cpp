@@ -0,0 +1,250 @@
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+
+#include "Templates/RadixTree.h"
+#include "Templates/HashMap.h"
+#include "cstrings/cstrings.h"
+#include "doctest/doctest/doctest.h"
+#include <map>
+#include <string>
+
+
+static cstr random_path(uint n)
+{
+	// paths with common prefixes and file names with different lengths
+
+	static cstr dirs[] = {"/usr/lib/", "/usr/local/lib/", "/home/kio/Documents/", "/home/kio/", "/"};
+	return usingstr("%sproject%u/src/%s%u.%s", dirs[n % 5], n / 5 % 37, n & 1 ? "file" : "f", n,
+					n % 3 ? "cpp" : "h");
+}
+
+
+TEST_CASE("RadixTree")
+{
+	SUBCASE("") { logline("●●● %s:", __FILE__); }
+
+	SUBCASE("add, find, remove")
+	{
+		RadixTree<int> t;
+		CHECK(t.count() == 0);
+		CHECK(t.find("foo") == nullptr);
+		CHECK(!t.remove("foo"));
+
+		t.add("foo", 1);
+		t.add("foobar", 2);
+		t.add("fo", 3);
+		t.add("", 4);
+		t.add("bar", 5);
+		CHECK(t.count() == 5);
+		CHECK(t.get("foo", 0) == 1);
+		CHECK(t.get("foobar", 0) == 2);
+		CHECK(t.get("fo", 0) == 3);
+		CHECK(t.get("", 0) == 4);
+		CHECK(t["bar"] == 5);
+		CHECK(!t.contains("f"));
+		CHECK(!t.contains("foob"));
+		CHECK(!t.contains("foobarx"));
+		CHECK(!t.contains("ba"));
+
+		t.add("foo", 11);
+		CHECK(t.count() == 5);
+		CHECK(*t.find(usingstr("%s", "foo")) == 11); // compared by value
+
+		CHECK(t.remove("foo"));
+		CHECK(!t.contains("foo"));
+		CHECK(t.contains("foobar"));
+		CHECK(t.contains("fo"));
+		CHECK(t.remove(""));
+		CHECK(t.remove("fo"));
+		CHECK(t.remove("foobar"));
+		CHECK(t.count() == 1);
+		CHECK(t["bar"] == 5);
+		CHECK(t.remove("bar"));
+		CHECK(t.count() == 0);
+		CHECK(t.memoryUsed() == 0);
+	}
+
+	SUBCASE("node types")
+	{
+		// all 256 byte values at the same position: the node grows to Node256 and shrinks again
+
+		RadixTree<uint> t;
+		char			key[] = "ab?cd";
+		for (uint c = 1; c < 256; c++)
+		{
+			key[2] = char(c);
+			t.add(key, c);
+		}
+		CHECK(t.count() == 255);
+
+		uint errors = 0;
+		for (uint c = 1; c < 256; c++)
+		{
+			key[2] = char(c);
+			errors += t.get(key, 0) != c;
+		}
+		CHECK(errors == 0);
+
+		for (uint c = 255; c > 1; c--)
+		{
+			key[2] = char(c);
+			errors += !t.remove(key);
+			for (uint c2 = 1; c2 < c; c2 += 7)
+			{
+				key[2] = char(c2);
+				errors += t.get(key, 0) != c2;
+			}
+		}
+		CHECK(errors == 0);
+		CHECK(t.count() == 1);
+		key[2] = 1;
+		CHECK(t.get(key, 0) == 1);
+	}
+
+	SUBCASE("random paths, compare with std::map")
+	{
+		RadixTree<uint>			   t;
+		std::map<std::string, uint> m;
+
+		uint errors = 0;
+		for (uint i = 0; i < 20000; i++)
+		{
+			uint n = uint(random()) % 5000;
+			cstr k = random_path(n);
+			if (random() % 3 == 0)
+			{
+				errors += t.remove(k) != (m.erase(k) == 1);
+			}
+			else
+			{
+				t.add(k, i);
+				m[k] = i;
+			}
+		}
+		CHECK(t.count() == m.size());
+
+		for (uint n = 0; n < 5000; n++)
+		{
+			cstr k	= random_path(n);
+			auto it = m.find(k);
+			errors += it == m.end() ? t.contains(k) : t.get(k, ~0u) != it->second;
+		}
+		CHECK(errors == 0);
+
+		// for_each visits keys in sorted order:
+		auto it = m.begin();
+		uint n	= 0;
+		t.for_each([&](cstr key, uint& item) {
+			errors += it == m.end() || ne(key, it->first.c_str()) || item != it->second;
+			++it, ++n;
+		});
+		CHECK(n == m.size());
+		CHECK(errors == 0);
+	}
+
+	SUBCASE("prefix_range")
+	{
+		RadixTree<uint> t;
+		for (uint n = 0; n < 1000; n++) t.add(random_path(n), n);
+
+		for (cstr prefix : {"/usr/", "/usr/lib/project", "/home/kio/Documents/project7/", "/home/kio/p", "/", "",
+							"/home/kio/Documents/project7/src/f35.h", "/x", "/usr/lib/project99"})
+		{
+			uint expected = 0;
+			for (uint n = 0; n < 1000; n++) expected += startswith(random_path(n), prefix);
+
+			uint n = 0, errors = 0;
+			cstr last = "";
+			t.prefix_range(prefix, [&](cstr key, uint& item) {
+				errors += !startswith(key, prefix) || ne(key, random_path(item)) || !gt(key, last);
+				last = dupstr(key);
+				n++;
+			});
+			CHECK(errors == 0);
+			CHECK(n == expected);
+		}
+	}
+
+	SUBCASE("add_all")
+	{
+		StrArray	keys;
+		Array<uint> items;
+		for (uint i = 0; i < 5000; i++)
+		{
+			keys.append(random_path(i * 7 % 3000)); // with duplicates
+			items << i;
+		}
+
+		RadixTree<uint> t1;
+		t1.add_all(keys, items); // bulk build
+		RadixTree<uint> t2;
+		for (uint i = 0; i < keys.count(); i++) t2.add(keys[i], i);
+		CHECK(t1.count() == 3000);
+		CHECK(t2.count() == 3000);
+
+		uint errors = 0;
+		for (uint i = 0; i < 3000; i++) errors += t1.get(random_path(i), 0) != t2.get(random_path(i), 1);
+		CHECK(errors == 0);
+		CHECK(t1.memoryUsed() <= t2.memoryUsed());
+
+		// add more to a non-empty tree:
+		t1.add_all(keys, items);
+		CHECK(t1.count() == 3000);
+
+		RadixTree<uint> t3(std::move(t1));
+		CHECK(t1.count() == 0);
+		CHECK(t3.count() == 3000);
+		CHECK(t3.remove(random_path(1)));
+		CHECK(t3.count() == 2999);
+	}
+}
+
+
+TEST_CASE("RadixTree performance test" * doctest::skip(false))
+{
+	// file paths: memory and lookup time compared with HashMap<cstr,uint>
+	// the HashMap needs the strings in addition: they are counted with their length + 0 rounded up to 8 bytes
+
+	static constexpr uint N = 1000000;
+
+	StrArray	paths;
+	Array<uint> items;
+	size_t		strings = 0;
+	for (uint i = 0; i < N; i++)
+	{
+		cstr p = usingstr("/home/kio/Projects/p%u/src/d%u/file%u.cpp", i % 97, i / 97 % 101, i);
+		paths.append(p);
+		items << i;
+		strings += (strlen(p) + 1 + 7) & ~7u;
+	}
+
+	double				t0 = now();
+	HashMap<cstr, uint> map(N);
+	for (uint i = 0; i < N; i++) map.add(paths[i], i);
+	double			t1 = now();
+	RadixTree<uint> tree;
+	tree.add_all(paths, items);
+	double t2 = now();
+
+	uint   k  = 12345;
+	uint64 s1 = 0, s2 = 0;
+	for (uint i = 0; i < N; i++) s1 += map.get(paths[(k = k * 1103515245u + 12345u) % N], 0);
+	double t3 = now();
+	k		  = 12345;
+	for (uint i = 0; i < N; i++) s2 += *tree.find(paths[(k = k * 1103515245u + 12345u) % N]);
+	double t4 = now();
+	CHECK(s1 == s2);
+
+	uint   n = 0;
+	double t5 = now();
+	tree.prefix_range("/home/kio/Projects/p7/", [&n](cstr, uint&) { n++; });
+	double t6 = now();
+
+	size_t hm = size_t(map.getMapSize()) * sizeof(int) + N * (sizeof(cstr) + sizeof(uint) + sizeof(uint32)) + strings;
+	logline("HashMap<cstr,uint>: %.1f bytes/key incl. strings, add %.0f ns, find %.0f ns", double(hm) / N,
+			(t1 - t0) * 1e9 / N, (t3 - t2) * 1e9 / N);
+	logline("RadixTree<uint>:    %.1f bytes/key, add_all %.0f ns, find %.0f ns, prefix_range %.0f ns/key",
+			double(tree.memoryUsed()) / N, (t2 - t1) * 1e9 / N, (t4 - t3) * 1e9 / N, (t6 - t5) * 1e9 / n);
+}
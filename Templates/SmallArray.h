@@ -0,0 +1,446 @@
+#pragma once
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+#include "Templates/Array.h"
+#include "kio/kio.h"
+
+
+/*	SmallArray<T,N> stores up to N items in an internal buffer
+	and only allocates data[] on the heap if it grows beyond N items.
+
+	same assumptions as for Array<T>:
+	items must not have virtual member functions. (must not have a vtable)
+	new items are initialized with zero.
+	items are moved around in memory with memcpy().
+
+	the API is a subset of Array's API.
+	a SmallArray can be moved to and from an Array<T>:
+	if the SmallArray has spilled to the heap then data[] is handed over without copying.
+	therefore data[] on the heap is allocated and resized with Array<T>'s static helpers.
+
+	operator[] aborts on failed index check!
+*/
+
+
+template<typename T, uint N>
+class SmallArray
+{
+	static_assert(N > 0, "N must be > 0");
+
+	// used by indexof(): strings are compared by value
+	template<typename U>
+	static bool item_eq(const U& a, const U& b) noexcept
+	{
+		return a == b;
+	}
+	static bool item_eq(cstr a, cstr b) noexcept { return eq(a, b); }
+	static bool item_eq(str a, str b) noexcept { return eq(a, b); }
+
+protected:
+	uint max, cnt;
+	T*	 data;							   // points to buffer[] or heap
+	alignas(T) char buffer[N * sizeof(T)]; // internal storage for up to N items
+
+	T*	 buffer_data() noexcept { return reinterpret_cast<T*>(buffer); }
+	void init() noexcept { max = N, cnt = 0, data = buffer_data(); }
+	void deallocate(T* p, uint max) noexcept
+	{
+		if (p != buffer_data()) Array<T>::deallocate(p, max);
+	}
+	void		memmove(uint z, uint q, uint n) noexcept { ::memmove(ptr(data + z), cptr(data + q), n * sizeof(T)); }
+	static void memcopy(T* z, const void* q, uint n) noexcept { ::memcpy(ptr(z), cptr(q), n * sizeof(T)); }
+	void		memclr(uint z, uint n) noexcept { ::memset(ptr(data + z), 0, n * sizeof(T)); }
+
+public:
+	static constexpr uint maxCount = Array<T>::maxCount;
+
+	~SmallArray() noexcept
+	{
+		for (uint i = 0; i < cnt; i++) data[i].~T();
+		deallocate(data, max);
+	}
+	SmallArray() noexcept { init(); }
+	SmallArray(SmallArray&& q) noexcept;
+	SmallArray(const SmallArray& q) throws;
+	explicit SmallArray(Array<T>&& q) noexcept;
+	SmallArray& operator=(SmallArray&& q) noexcept;
+	SmallArray& operator=(const SmallArray& q) throws;
+	SmallArray& operator=(Array<T>&& q) noexcept;
+
+	// move to Array<T>:
+	operator Array<T>() && throws;
+
+	// access data members:
+	bool	 isInline() const noexcept { return data == reinterpret_cast<const T*>(buffer); }
+	uint	 count() const noexcept { return cnt; }
+	const T* getData() const noexcept { return data; }
+	T*		 getData() noexcept { return data; }
+	const T& operator[](uint i) const noexcept
+	{
+		assert(i < cnt);
+		return data[i];
+	}
+	T& operator[](uint i) noexcept
+	{
+		assert(i < cnt);
+		return data[i];
+	}
+	const T& operator[](int i) const noexcept
+	{
+		assert(uint(i) < cnt);
+		return data[i];
+	}
+	T& operator[](int i) noexcept
+	{
+		assert(uint(i) < cnt);
+		return data[i];
+	}
+	const T& first() const noexcept
+	{
+		assert(cnt);
+		return data[0];
+	}
+	T& first() noexcept
+	{
+		assert(cnt);
+		return data[0];
+	}
+	const T& last() const noexcept
+	{
+		assert(cnt);
+		return data[cnt - 1];
+	}
+	T& last() noexcept
+	{
+		assert(cnt);
+		return data[cnt - 1];
+	}
+
+	bool operator==(const SmallArray& q) const noexcept; // uses ne()
+	bool operator!=(const SmallArray& q) const noexcept { return !operator==(q); }
+
+	uint indexof(REForVALUE(T) item) const noexcept; // compare using '==' except str/cstr: 'eq'
+	bool contains(REForVALUE(T) item) const noexcept { return indexof(item) != ~0u; } // uses indexof()
+
+	// resize:
+	void growmax(uint newmax) throws;
+	T&	 grow() throws
+	{
+		growmax(cnt + 1);
+		return *new (&data[cnt++]) T();
+	}
+	void grow(uint newcnt) throws;
+	void shrink(uint newcnt) noexcept;
+	void resize(uint newcnt) throws
+	{
+		grow(newcnt);
+		shrink(newcnt);
+	}
+	void drop() noexcept
+	{
+		assert(cnt);
+		data[--cnt].~T();
+	}
+	T pop() noexcept
+	{
+		assert(cnt);
+		return std::move(data[--cnt]);
+	}
+	void purge() noexcept
+	{
+		for (uint i = 0; i < cnt; i++) data[i].~T();
+		deallocate(data, max);
+		init();
+	}
+	T& append(T q) throws
+	{
+		growmax(cnt + 1);
+		return *new (&data[cnt++]) T(std::move(q));
+	}
+	void appendifnew(T q) throws
+	{
+		if (!contains(q)) append(std::move(q));
+	} // uses indexof()
+	SmallArray& operator<<(T q) throws
+	{
+		append(std::move(q));
+		return *this;
+	}
+	void append(const T* q, uint n) throws
+	{
+		growmax(cnt + n);
+		for (uint i = 0; i < n; i++) new (&data[cnt + i]) T(*q++);
+		cnt += n;
+	}
+
+	void removeitem(REForVALUE(T) item, bool fast = 0) noexcept // uses indexof()
+	{
+		uint i = indexof(item);
+		if (i != ~0u) removeat(i, fast);
+	}
+	void removeat(uint idx, bool fast = 0) noexcept;
+	void removerange(uint a, uint e) noexcept;
+	void insertat(uint idx, T) throws;
+
+	void sort() noexcept
+	{
+		if (cnt) ::sort(data, data + cnt);
+	} // uses gt()
+	void rsort() noexcept
+	{
+		if (cnt) ::rsort(data, data + cnt);
+	} // uses gt()
+	void sort(COMPARATOR(T) gt) noexcept
+	{
+		if (cnt) ::sort(data, data + cnt, gt);
+	}
+};
+
+
+// -----------------------------------------------------------------------
+//					  I M P L E M E N T A T I O N S
+// -----------------------------------------------------------------------
+
+template<typename T, uint N>
+inline str tostr(const SmallArray<T, N>& array)
+{
+	// return 1-line description of array for debugging and logging:
+	return usingstr("SmallArray<T,%u>[%u]", N, array.count());
+}
+
+template<typename T, uint N>
+SmallArray<T, N>::SmallArray(SmallArray&& q) noexcept
+{
+	if (q.isInline())
+	{
+		init();
+		memcopy(data, q.data, q.cnt);
+		cnt = q.cnt;
+	}
+	else
+	{
+		max	 = q.max;
+		cnt	 = q.cnt;
+		data = q.data;
+	}
+	q.init();
+}
+
+template<typename T, uint N>
+SmallArray<T, N>::SmallArray(const SmallArray& q) throws
+{
+	init();
+	if (q.cnt > N)
+	{
+		data = Array<T>::allocate(q.cnt);
+		max	 = q.cnt;
+	}
+	for (uint i = 0; i < q.cnt; i++) new (data + i) T(q.data[i]);
+	cnt = q.cnt;
+}
+
+template<typename T, uint N>
+SmallArray<T, N>::SmallArray(Array<T>&& q) noexcept
+{
+	// move items from Array
+	// if they fit in buffer[] then they are copied and q.data[] is deallocated
+	// else q.data[] is handed over
+
+	if (q.cnt <= N)
+	{
+		init();
+		memcopy(data, q.data, q.cnt);
+		cnt = q.cnt;
+		Array<T>::deallocate(q.data, q.max);
+	}
+	else
+	{
+		max	 = q.max;
+		cnt	 = q.cnt;
+		data = q.data;
+	}
+	q.max = q.cnt = 0;
+	q.data		  = nullptr;
+}
+
+template<typename T, uint N>
+SmallArray<T, N>::operator Array<T>() && throws
+{
+	// move items to an Array
+	// if data[] is on the heap then it is handed over
+	// else the items are copied into a new data[]
+
+	Array<T> a;
+	if (isInline())
+	{
+		a.data = Array<T>::allocate(cnt);
+		memcopy(a.data, data, cnt);
+		a.max = cnt;
+	}
+	else
+	{
+		a.data = data;
+		a.max  = max;
+	}
+	a.cnt = cnt;
+	init();
+	return a;
+}
+
+template<typename T, uint N>
+SmallArray<T, N>& SmallArray<T, N>::operator=(SmallArray&& q) noexcept
+{
+	if (this != &q)
+	{
+		this->~SmallArray();
+		new (this) SmallArray(std::move(q));
+	}
+	return *this;
+}
+
+template<typename T, uint N>
+SmallArray<T, N>& SmallArray<T, N>::operator=(const SmallArray& q) throws
+{
+	if (this != &q) operator=(SmallArray(q));
+	return *this;
+}
+
+template<typename T, uint N>
+SmallArray<T, N>& SmallArray<T, N>::operator=(Array<T>&& q) noexcept
+{
+	this->~SmallArray();
+	new (this) SmallArray(std::move(q));
+	return *this;
+}
+
+template<typename T, uint N>
+bool SmallArray<T, N>::operator==(const SmallArray& q) const noexcept
+{
+	if (cnt != q.cnt) return false;
+	for (uint i = cnt; i--;)
+	{
+		if (ne(data[i], q.data[i])) return false;
+	}
+	return true;
+}
+
+template<typename T, uint N>
+uint SmallArray<T, N>::indexof(REForVALUE(T) item) const noexcept
+{
+	// find first occurance
+	// using == (find pointers by identity) except str/cstr: eq()
+	// or return ~0u
+
+	for (uint i = 0; i < cnt; i++)
+	{
+		if (item_eq(data[i], item)) return i;
+	}
+	return ~0u;
+}
+
+template<typename T, uint N>
+void SmallArray<T, N>::growmax(uint newmax) throws
+{
+	// grow data[]
+	// only grows, never shrinks
+	//
+	// newmax > maxCount: throws
+	// newmax > max: moves data[] to the heap or resizes it and overallocates ~12%
+
+	if (newmax > max)
+	{
+		if (newmax < maxCount) newmax = ::min(maxCount, newmax + newmax / 8 + 4);
+
+		if (isInline())
+		{
+			T* newdata = Array<T>::allocate(newmax);
+			memcopy(newdata, data, cnt);
+			data = newdata;
+		}
+		else data = Array<T>::reallocate(data, cnt, max, newmax);
+		max = newmax;
+	}
+}
+
+template<typename T, uint N>
+void SmallArray<T, N>::grow(uint newcnt) throws
+{
+	// grow data[]
+	// only grows, never shrinks
+	//
+	// newcnt ≤ cnt: does nothing
+
+	if (newcnt <= cnt) return;
+
+	growmax(newcnt);
+
+	memclr(cnt, newcnt - cnt);
+	cnt = newcnt;
+}
+
+template<typename T, uint N>
+void SmallArray<T, N>::shrink(uint newcnt) noexcept
+{
+	// shrink data[]
+	// does nothing if new count ≥ current count
+	// moves data[] back into buffer[] if the items fit
+
+	if (newcnt >= cnt) return;
+
+	for (uint i = newcnt; i < cnt; i++) data[i].~T();
+	cnt = newcnt;
+
+	if (!isInline() && newcnt <= N)
+	{
+		T*	 olddata = data;
+		uint oldmax	 = max;
+		init();
+		memcopy(data, olddata, newcnt);
+		cnt = newcnt;
+		deallocate(olddata, oldmax);
+	}
+}
+
+template<typename T, uint N>
+void SmallArray<T, N>::removeat(uint idx, bool fast) noexcept
+{
+	// remove item at index
+	// idx < cnt
+
+	assert(idx < cnt);
+
+	data[idx].~T();
+	if (--cnt == idx) return;
+
+	if (fast) { new (data + idx) T(std::move(data[cnt])); }
+	else { memmove(idx, idx + 1, cnt - idx); }
+}
+
+template<typename T, uint N>
+void SmallArray<T, N>::removerange(uint a, uint e) noexcept
+{
+	// remove range of data
+
+	if (e > cnt) e = cnt;
+	if (a >= e) return;
+
+	for (uint i = a; i < e; i++) data[i].~T();
+	memmove(a, e, cnt - e);
+	cnt -= e - a;
+}
+
+template<typename T, uint N>
+void SmallArray<T, N>::insertat(uint idx, T t) throws
+{
+	// insert item at index
+	// idx ≤ cnt
+
+	assert(idx <= cnt);
+
+	growmax(cnt + 1);
+	memmove(idx + 1, idx, cnt - idx);
+	cnt++;
+	new (data + idx) T(std::move(t));
+}
@@ -0,0 +1,158 @@
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+
+#include "Templates/SmallArray.h"
+#include "Templates/Array.h"
+#include "doctest/doctest/doctest.h"
+
+
+TEST_CASE("SmallArray")
+{
+	SUBCASE("") { logline("●●● %s:", __FILE__); }
+
+	SUBCASE("inline and spilled")
+	{
+		SmallArray<int, 4> a;
+		CHECK(a.count() == 0);
+		CHECK(a.isInline());
+
+		a << 3 << 1 << 2;
+		CHECK(a.count() == 3);
+		CHECK(a.isInline());
+		a.append(0);
+		CHECK(a.isInline());
+		CHECK_UNARY(a[0] == 3 && a[1] == 1 && a[2] == 2 && a[3] == 0);
+
+		a.append(5);
+		CHECK(!a.isInline());
+		CHECK(a.count() == 5);
+		CHECK_UNARY(a[0] == 3 && a[1] == 1 && a[2] == 2 && a[3] == 0 && a[4] == 5);
+
+		a.sort();
+		CHECK_UNARY(a[0] == 0 && a[1] == 1 && a[2] == 2 && a[3] == 3 && a[4] == 5);
+		a.rsort();
+		CHECK_UNARY(a.first() == 5 && a.last() == 0);
+
+		CHECK(a.indexof(2) == 2);
+		CHECK(a.indexof(7) == ~0u);
+		CHECK(a.contains(3));
+
+		a.removeat(1);
+		CHECK_UNARY(a.count() == 4 && a[0] == 5 && a[1] == 2 && a[3] == 0);
+		a.insertat(0, 9);
+		CHECK_UNARY(a.count() == 5 && a[0] == 9 && a[1] == 5);
+		a.removerange(1, 3);
+		CHECK_UNARY(a.count() == 3 && a[0] == 9 && a[1] == 1 && a[2] == 0);
+
+		a.shrink(2);
+		CHECK(a.isInline());
+		CHECK_UNARY(a.count() == 2 && a[0] == 9 && a[1] == 1);
+
+		a.grow(10);
+		CHECK(!a.isInline());
+		CHECK_UNARY(a.count() == 10 && a[1] == 1 && a[2] == 0 && a[9] == 0);
+
+		a.purge();
+		CHECK(a.count() == 0);
+		CHECK(a.isInline());
+	}
+
+	SUBCASE("copy and move")
+	{
+		SmallArray<int, 4> a, b;
+		a << 1 << 2;
+		b << 1 << 2 << 3 << 4 << 5;
+
+		SmallArray<int, 4> a2(a), b2(b);
+		CHECK(a2 == a);
+		CHECK(b2 == b);
+		CHECK(a2 != b2);
+		CHECK(a2.isInline());
+		CHECK(!b2.isInline());
+
+		SmallArray<int, 4> a3(std::move(a2)), b3(std::move(b2));
+		CHECK(a3 == a);
+		CHECK(b3 == b);
+		CHECK(a2.count() == 0);
+		CHECK(b2.count() == 0);
+		CHECK(b2.isInline());
+
+		a3 = b;
+		CHECK(a3 == b);
+		b3 = std::move(a);
+		CHECK(b3.count() == 2);
+		CHECK(b3[1] == 2);
+		CHECK(b3.isInline());
+	}
+
+	SUBCASE("to and from Array")
+	{
+		SmallArray<int, 4> a, b;
+		a << 1 << 2;
+		b << 1 << 2 << 3 << 4 << 5;
+
+		const int* data = b.getData();
+		Array<int> aa	= std::move(a);
+		Array<int> ba	= std::move(b);
+		CHECK(aa.count() == 2);
+		CHECK(ba.count() == 5);
+		CHECK(ba.getData() == data); // handed over
+		CHECK(a.count() == 0);
+		CHECK(b.count() == 0);
+		CHECK(aa[1] == 2);
+		CHECK(ba[4] == 5);
+
+		SmallArray<int, 4> a2(std::move(aa));
+		SmallArray<int, 4> b2(std::move(ba));
+		CHECK(aa.count() == 0);
+		CHECK(ba.count() == 0);
+		CHECK(a2.isInline());
+		CHECK(b2.getData() == data);
+		CHECK(a2.count() == 2);
+		CHECK(b2[4] == 5);
+	}
+
+	SUBCASE("cstr")
+	{
+		SmallArray<cstr, 2> a;
+		a << "foo" << "bar" << "baz";
+		char s[] = "bar";
+		CHECK(a.indexof(s) == 1);
+		a.appendifnew(s);
+		CHECK(a.count() == 3);
+		a.removeitem("foo");
+		CHECK(a.count() == 2);
+		CHECK(eq(a[0], "bar"));
+	}
+}
+
+
+TEST_CASE("SmallArray performance test" * doctest::skip(false))
+{
+	// create and destroy many tiny arrays with 1 to 8 items
+
+	static constexpr uint N = 1000000;
+
+	uint   sum1 = 0, sum2 = 0;
+	double t0 = now();
+	for (uint i = 0; i < N; i++)
+	{
+		Array<uint> a;
+		for (uint j = 0; j <= i % 8; j++) a.append(j);
+		sum1 += a.count();
+	}
+	double t1 = now();
+	for (uint i = 0; i < N; i++)
+	{
+		SmallArray<uint, 8> a;
+		for (uint j = 0; j <= i % 8; j++) a.append(j);
+		sum2 += a.count();
+	}
+	double t2 = now();
+
+	CHECK(sum1 == sum2);
+	logline("Array<uint>:        %.1f ns per array", (t1 - t0) * 1e9 / N);
+	logline("SmallArray<uint,8>: %.1f ns per array", (t2 - t1) * 1e9 / N);
+}
@@ -6,6 +6,7 @@
 #define loglevel 1
 #include "Templates/sort.h"
 #include "Templates/Array.h"
+#include "Templates/StrArray.h"
 #include "doctest/doctest/doctest.h"
 
 
@@ -211,6 +212,213 @@ TEST_CASE("sort")
 	}
 }
 
+struct Pair
+{
+	int	 key, idx;
+	bool operator>(const Pair& q) const { return key > q.key; }
+	bool operator!=(const Pair& q) const { return key != q.key || idx != q.idx; }
+};
+
+static bool is_stably_sorted(const Array<Pair>& a)
+{
+	for (uint i = 1; i < a.count(); i++)
+	{
+		if (a[i - 1].key > a[i].key) return false;
+		if (a[i - 1].key == a[i].key && a[i - 1].idx > a[i].idx) return false;
+	}
+	return true;
+}
+
+TEST_CASE("stable_sort, radix_sort")
+{
+	SUBCASE("stable_sort")
+	{
+		for (uint n : {0u, 1u, 2u, 31u, 32u, 33u, 100u, 1000u, 12345u})
+		{
+			for (int range : {3, 100, 1 << 30})
+			{
+				Array<Pair> a;
+				for (uint i = 0; i < n; i++) a.append(Pair {int(random() % range), int(i)});
+				Array<Pair> b(a);
+				a.stable_sort();
+				CHECK(is_stably_sorted(a));
+				b.radix_sort([](const Pair& p) { return p.key; });
+				CHECK(a == b);
+			}
+		}
+	}
+
+	SUBCASE("stable_sort with runs")
+	{
+		Array<Pair> a;
+		for (int i = 0; i < 1000; i++) a.append(Pair {i / 3, i});			// ascending
+		for (int i = 0; i < 1000; i++) a.append(Pair {1000 - i, i + 1000}); // strictly descending
+		for (int i = 0; i < 1000; i++) a.append(Pair {i % 7, i + 2000});
+		for (int i = 0; i < 10; i++) a.append(Pair {5, i + 3000}); // short run
+		a.stable_sort();
+		CHECK(is_stably_sorted(a));
+		CHECK(a.count() == 3010);
+	}
+
+	SUBCASE("stable_rsort, comparator")
+	{
+		Array<int> a;
+		for (int i = 0; i < 1000; i++) a.append(int(random() % 1000) - 500);
+		Array<int> b(a), c(a);
+		a.stable_rsort();
+		b.rsort();
+		CHECK(a == b);
+		c.stable_sort(lt);
+		CHECK(c == b);
+	}
+
+	SUBCASE("radix_sort number types")
+	{
+		Array<int64> a;
+		for (int i = 0; i < 5000; i++) a.append((int64(random()) << 32 | uint(random())) - 0x7fffffffffffffff / 2);
+		a << 0 << -1 << 1 << 0x7fffffffffffffff << -0x7fffffffffffffff - 1;
+		Array<int64> b(a);
+		a.radix_sort();
+		b.sort();
+		CHECK(a == b);
+
+		Array<double> f;
+		for (int i = 0; i < 5000; i++) f.append((double(random()) - double(RAND_MAX / 2)) / 1e5);
+		f << 0.0 << -0.0 << 1e300 << -1e300 << 1e-300;
+		f.radix_sort();
+		uint errors = 0;
+		for (uint i = 1; i < f.count(); i++) errors += f[i - 1] > f[i];
+		CHECK(errors == 0);
+
+		Array<uint8> c;
+		for (int i = 0; i < 5000; i++) c.append(uint8(random()));
+		Array<uint8> d(c);
+		c.radix_sort();
+		d.sort();
+		CHECK(c == d);
+
+		Array<float> g;
+		for (int i = 0; i < 5000; i++) g.append(float(int(random() % 2001) - 1000) / 7.0f);
+		Array<float> h(g);
+		g.radix_sort();
+		h.sort();
+		CHECK(g == h);
+	}
+}
+
+TEST_CASE("sort performance test" * doctest::skip(false))
+{
+	static const uint N = 1000000;
+
+	Array<uint32> random_data, presorted, reversed, duplicates;
+	for (uint i = 0; i < N; i++) random_data.append(uint32(random()));
+	for (uint i = 0; i < N; i++) presorted.append(i);
+	for (uint i = 0; i < N; i++) reversed.append(N - i);
+	for (uint i = 0; i < N; i++) duplicates.append(uint32(random() % 16));
+
+	struct
+	{
+		cstr				 name;
+		const Array<uint32>& data;
+	} inputs[] = {{"random", random_data}, {"presorted", presorted}, {"reversed", reversed}, {"duplicates", duplicates}};
+
+	for (auto& input : inputs)
+	{
+		Array<uint32> a(input.data), b(input.data), c(input.data);
+
+		// sort() is quadratic for reversed input:
+		bool skip_sort = &input.data == &reversed;
+
+		double t0 = now();
+		if (!skip_sort) a.sort();
+		double t1 = now();
+		b.stable_sort();
+		double t2 = now();
+		c.radix_sort();
+		double t3 = now();
+
+		if (skip_sort) a = c;
+		CHECK(a == b);
+		CHECK(a == c);
+		logline("%-10s uint32[%u]: sort %s sec, stable_sort %.3f sec, radix_sort %.3f sec", input.name, N,
+				skip_sort ? " n.a." : usingstr("%.3f", t1 - t0), t2 - t1, t3 - t2);
+	}
+}
+
+TEST_CASE("parallel_sort")
+{
+	SUBCASE("same result as stable_sort")
+	{
+		for (int range : {50, 1 << 30})
+		{
+			Array<Pair> a;
+			for (uint i = 0; i < 300000; i++) a.append(Pair {int(random() % range), int(i)});
+			Array<Pair> b(a);
+			b.stable_sort();
+
+			for (uint nthreads : {1u, 2u, 3u, 4u, 7u})
+			{
+				Array<Pair> c(a);
+				parallel_sort(c.getData(), c.getData() + c.count(), gt, nthreads);
+				CHECK(c == b);
+			}
+		}
+	}
+
+	SUBCASE("Array, StrArray")
+	{
+		Array<int> a;
+		for (int i = 0; i < 200000; i++) a.append(int(random()) - RAND_MAX / 2);
+		Array<int> b(a), c(a);
+		a.parallel_sort();
+		b.sort();
+		CHECK(a == b);
+		a.parallel_rsort();
+		b.rsort();
+		CHECK(a == b);
+		c.parallel_sort(lt);
+		CHECK(c == b);
+
+		StrArray s, t;
+		for (uint i = 0; i < 100000; i++) s.append(usingstr("/foo/%u/bar%u", uint(random() % 1000), i));
+		for (uint i = 0; i < s.count(); i++) t.append(s[i]);
+		s.parallel_sort();
+		t.sort();
+		CHECK(s == t);
+	}
+
+	SUBCASE("small")
+	{
+		Array<int> a;
+		a.parallel_sort();
+		a << 3 << 1 << 2;
+		a.parallel_sort();
+		CHECK_UNARY(a[0] == 1 && a[1] == 2 && a[2] == 3);
+	}
+}
+
+TEST_CASE("parallel_sort performance test" * doctest::skip(false))
+{
+	static const uint N = 4000000;
+
+	Array<uint32> a;
+	for (uint i = 0; i < N; i++) a.append(uint32(random()));
+	Array<uint32> b(a), c(a);
+
+	double t0 = now();
+	a.sort();
+	double t1 = now();
+	b.parallel_sort();
+	double t2 = now();
+	parallel_sort(c.getData(), c.getData() + N, gt, 4);
+	double t3 = now();
+
+	CHECK(a == b);
+	CHECK(a == c);
+	logline("uint32[%u]: sort %.3f sec, parallel_sort %.3f sec (%u cores), with 4 threads %.3f sec", N, t1 - t0,
+			t2 - t1, std::thread::hardware_concurrency(), t3 - t2);
+}
+
 /*
 
 
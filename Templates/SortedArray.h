@@ -0,0 +1,192 @@
+#pragma once
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+#include "Templates/Array.h"
+#include "kio/kio.h"
+#include "kio/util/msbit.h"
+
+
+/*	SortedArray<T> is a read-only sorted array for fast searching.
+
+	The items are stored in Eytzinger layout: the binary search tree is stored in BFS order,
+	the root is tree[1], the children of tree[k] are tree[2k] and tree[2k+1], tree[0] is unused.
+	The first levels of the tree are packed together and stay in the cache,
+	the search is branchless and the cache line 4 levels ahead is prefetched.
+	lookup_many() searches a batch of keys side by side to overlap the memory latency.
+
+	A SortedArray is built from an Array<T> which is sorted with stable_sort().
+	Items are compared with lt(). Duplicates are allowed.
+
+	lower_bound() returns a pointer to the item in the tree or nullptr.
+	The items in the tree can be visited in sorted order with next().
+*/
+
+
+template<typename T>
+class SortedArray
+{
+	Array<T> tree; // tree[1 .. cnt]
+	uint	 cnt	= 0;
+	uint	 height = 0; // number of levels
+
+	static constexpr uint BATCH = 16; // lookup_many(): keys searched side by side
+	static constexpr uint SPAN	= 64 / sizeof(T) ? 64 / sizeof(T) : 1; // items per cache line
+
+	void build(const T* q, uint& i, uint k) noexcept;
+	uint index_of(const T* p) const noexcept { return uint(p - tree.getData()); }
+
+public:
+	SortedArray() noexcept = default;
+	explicit SortedArray(Array<T> q) throws;
+
+	// access data members:
+	uint	 count() const noexcept { return cnt; }
+	const T* getData() const noexcept { return cnt ? &tree[1] : nullptr; } // items in BFS order
+	const T& first() const noexcept;									   // smallest item
+	const T& last() const noexcept;										   // largest item
+
+	// search:
+	const T* lower_bound(REForVALUE(T) key) const noexcept; // first item ≥ key or nullptr
+	bool	 contains(REForVALUE(T) key) const noexcept
+	{
+		const T* p = lower_bound(key);
+		return p && !lt(key, *p);
+	}
+	const T* next(const T* p) const noexcept; // next item in sorted order or nullptr
+	Array<T> range(REForVALUE(T) a, REForVALUE(T) e) const throws; // items in range [a..[e
+
+	// search a batch of keys:
+	void lookup_many(const T* keys, uint n, const T** lower_bounds) const noexcept;
+};
+
+
+// -----------------------------------------------------------------------
+//					  I M P L E M E N T A T I O N S
+// -----------------------------------------------------------------------
+
+template<typename T>
+inline str tostr(const SortedArray<T>& array)
+{
+	// return 1-line description of array for debugging and logging:
+	return usingstr("SortedArray<T>[%u]", array.count());
+}
+
+template<typename T>
+SortedArray<T>::SortedArray(Array<T> q) throws : tree(q.count() + 1), cnt(q.count())
+{
+	q.stable_sort();
+	uint i = 0;
+	build(q.getData(), i, 1);
+	height = cnt ? uint(msbit(cnt)) + 1 : 0;
+}
+
+template<typename T>
+void SortedArray<T>::build(const T* q, uint& i, uint k) noexcept
+{
+	// fill the tree in-order from the sorted items q[]
+	// recursion depth = height
+
+	if (k > cnt) return;
+	build(q, i, 2 * k);
+	tree[k] = q[i++];
+	build(q, i, 2 * k + 1);
+}
+
+template<typename T>
+const T& SortedArray<T>::first() const noexcept
+{
+	assert(cnt);
+	uint k = 1;
+	while (2 * k <= cnt) k = 2 * k;
+	return tree[k];
+}
+
+template<typename T>
+const T& SortedArray<T>::last() const noexcept
+{
+	assert(cnt);
+	uint k = 1;
+	while (2 * k + 1 <= cnt) k = 2 * k + 1;
+	return tree[k];
+}
+
+template<typename T>
+const T* SortedArray<T>::lower_bound(REForVALUE(T) key) const noexcept
+{
+	// descend to a leaf: go right if tree[k] < key
+	// then go up again to the last node where we went left
+
+	const T* data = tree.getData();
+	uint	 k	  = 1;
+	while (k <= cnt)
+	{
+		__builtin_prefetch(data + k * SPAN); // the prefetch of an address beyond the end is harmless
+		k = 2 * k + lt(data[k], key);
+	}
+	k >>= __builtin_ffs(int(~k));
+	return k ? data + k : nullptr;
+}
+
+template<typename T>
+const T* SortedArray<T>::next(const T* p) const noexcept
+{
+	// return the next item in sorted order
+	// if p has a right subtree then its leftmost node
+	// else go up while p is a right child and then once more
+
+	uint k = index_of(p);
+	assert(k >= 1 && k <= cnt);
+
+	if (2 * k + 1 <= cnt)
+	{
+		k = 2 * k + 1;
+		while (2 * k <= cnt) k = 2 * k;
+	}
+	else k >>= __builtin_ffs(int(~k));
+	return k ? &tree[k] : nullptr;
+}
+
+template<typename T>
+Array<T> SortedArray<T>::range(REForVALUE(T) a, REForVALUE(T) e) const throws
+{
+	// return all items in range [a..[e in sorted order
+
+	Array<T> z;
+	for (const T* p = lower_bound(a); p && lt(*p, e); p = next(p)) z.append(*p);
+	return z;
+}
+
+template<typename T>
+void SortedArray<T>::lookup_many(const T* keys, uint n, const T** z) const noexcept
+{
+	// search lower_bound() for n keys and store the results in z[]
+	// the keys are searched in batches side by side:
+	// the prefetches for all keys of a batch are in flight at the same time
+
+	const T* data = tree.getData();
+	uint	 k[BATCH];
+
+	for (uint i0 = 0; i0 < n; i0 += BATCH)
+	{
+		uint m = min(BATCH, n - i0);
+		for (uint j = 0; j < m; j++) k[j] = 1;
+
+		for (uint level = 0; level < height; level++)
+		{
+			for (uint j = 0; j < m; j++)
+			{
+				if (k[j] > cnt) continue; // the last level may be incomplete
+				__builtin_prefetch(data + k[j] * SPAN);
+				k[j] = 2 * k[j] + lt(data[k[j]], keys[i0 + j]);
+			}
+		}
+
+		for (uint j = 0; j < m; j++)
+		{
+			uint kk	  = k[j] >> __builtin_ffs(int(~k[j]));
+			z[i0 + j] = kk ? data + kk : nullptr;
+		}
+	}
+}
@@ -0,0 +1,161 @@
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+
+#include "Templates/SortedArray.h"
+#include "Templates/StrArray.h"
+#include "doctest/doctest/doctest.h"
+#include <algorithm>
+
+
+TEST_CASE("SortedArray")
+{
+	SUBCASE("") { logline("●●● %s:", __FILE__); }
+
+	SUBCASE("empty")
+	{
+		SortedArray<int> a;
+		CHECK(a.count() == 0);
+		CHECK(a.lower_bound(0) == nullptr);
+		CHECK(!a.contains(0));
+		CHECK(a.range(0, 100).count() == 0);
+
+		SortedArray<int> b {Array<int>()};
+		CHECK(b.count() == 0);
+		CHECK(!b.contains(0));
+	}
+
+	SUBCASE("all sizes up to 200")
+	{
+		uint errors = 0;
+		for (uint n = 1; n <= 200; n++)
+		{
+			Array<int> q;
+			for (uint i = 0; i < n; i++) q << int(i * 2 + 10); // 10, 12, 14 ...
+			q.shuffle();
+			SortedArray<int> a(q);
+
+			errors += a.count() != n;
+			errors += a.first() != 10 || a.last() != int(n * 2 + 8);
+
+			for (int key = 0; key < int(n * 2 + 20); key++)
+			{
+				const int* p = a.lower_bound(key);
+				int		   x = key <= 10 ? 10 : (key + 1) / 2 * 2; // expected lower bound
+				if (x > int(n * 2 + 8)) errors += p != nullptr;
+				else errors += p == nullptr || *p != x;
+				errors += a.contains(key) != (key >= 10 && key % 2 == 0 && key <= int(n * 2 + 8));
+			}
+
+			// visit all items in sorted order:
+			uint cnt = 0;
+			int	 x	 = 0;
+			for (const int* p = &a.first(); p; p = a.next(p), cnt++)
+			{
+				errors += *p <= x;
+				x = *p;
+			}
+			errors += cnt != n;
+		}
+		CHECK(errors == 0);
+	}
+
+	SUBCASE("duplicates and range")
+	{
+		Array<int> q;
+		q << 5 << 3 << 5 << 1 << 5 << 9 << 3;
+		SortedArray<int> a(q);
+		CHECK(a.range(0, 100) == (Array<int>() << 1 << 3 << 3 << 5 << 5 << 5 << 9));
+		CHECK(a.range(3, 9) == (Array<int>() << 3 << 3 << 5 << 5 << 5));
+		CHECK(a.range(4, 5).count() == 0);
+		CHECK(a.range(6, 2).count() == 0);
+		CHECK(*a.lower_bound(4) == 5);
+		CHECK(a.next(a.lower_bound(9)) == nullptr);
+	}
+
+	SUBCASE("cstr")
+	{
+		StrArray q;
+		q << "foo" << "bar" << "baz" << "a" << "zz";
+		SortedArray<cstr> a(Array<cstr>(q.getData(), q.count()));
+		CHECK(a.contains("baz"));
+		CHECK(a.contains(usingstr("%s", "foo"))); // compared by value
+		CHECK(!a.contains("b"));
+		CHECK(eq(*a.lower_bound("b"), "bar"));
+		CHECK(eq(a.first(), "a"));
+		CHECK(eq(a.last(), "zz"));
+		CHECK(a.lower_bound("zzz") == nullptr);
+	}
+
+	SUBCASE("lookup_many")
+	{
+		Array<uint32> q;
+		for (uint i = 0; i < 1000; i++) q << uint32(random());
+		SortedArray<uint32> a(q);
+
+		Array<uint32> keys;
+		for (uint i = 0; i < 1000; i++) keys << (i & 1 ? q[i] : uint32(random()));
+		keys << 0 << ~0u;
+		Array<const uint32*> z(keys.count());
+		a.lookup_many(keys.getData(), keys.count(), z.getData());
+
+		uint errors = 0;
+		for (uint i = 0; i < keys.count(); i++) errors += z[i] != a.lower_bound(keys[i]);
+		CHECK(errors == 0);
+		CHECK(z[1000] == &a.first());
+		CHECK(z[1001] == nullptr);
+	}
+}
+
+
+static void compare_searches(uint n, uint nqueries)
+{
+	Array<uint32> q(n);
+	for (uint i = 0; i < n; i++) q[i] = uint32(random());
+
+	SortedArray<uint32> a(q);
+	Array<uint32>		sorted(q);
+	sorted.stable_sort();
+
+	Array<uint32> keys(nqueries);
+	for (uint i = 0; i < nqueries; i++) keys[i] = uint32(random());
+	Array<const uint32*> z(nqueries);
+
+	uint   found1 = 0, found2 = 0, found3 = 0, found4 = 0;
+	double t0 = now();
+	for (uint i = 0; i < nqueries; i++)
+	{
+		const uint32* p = std::lower_bound(sorted.getData(), sorted.getData() + n, keys[i]);
+		found1 += p != sorted.getData() + n;
+	}
+	double t1 = now();
+	for (uint i = 0; i < nqueries; i++) found2 += a.lower_bound(keys[i]) != nullptr;
+	double t2 = now();
+	a.lookup_many(keys.getData(), nqueries, z.getData());
+	for (uint i = 0; i < nqueries; i++) found3 += z[i] != nullptr;
+	double t3 = now();
+	CHECK(found1 == found2);
+	CHECK(found1 == found3);
+
+	// linear search with a small number of queries:
+	uint   nlinear = n <= 1000 ? nqueries : n <= 100000 ? 1000 : 0;
+	double t4	   = now();
+	for (uint i = 0; i < nlinear; i++) found4 += q.indexof(keys[i]) != ~0u;
+	double t5 = now();
+	CHECK(found4 <= nlinear); // use the result
+
+	cstr lin = nlinear ? usingstr("%9.1f ns", (t5 - t4) * 1e9 / nlinear) : "     n.a.";
+	logline("%9u items:  std::lower_bound %5.1f ns,  SortedArray %5.1f ns,  lookup_many %5.1f ns,  indexof %s", n,
+			(t1 - t0) * 1e9 / nqueries, (t2 - t1) * 1e9 / nqueries, (t3 - t2) * 1e9 / nqueries, lin);
+}
+
+TEST_CASE("SortedArray performance test" * doctest::skip(false))
+{
+	for (uint n = 1000; n <= 10000000; n *= 10) { compare_searches(n, 1000000); }
+}
+
+TEST_CASE("SortedArray 100M performance test" * doctest::skip(true))
+{
+	compare_searches(100000000, 1000000); // needs ~2 GB
+}
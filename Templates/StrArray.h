@@ -152,6 +152,8 @@ public:
 	void insertrange(uint a, uint e) throws { SUPER::insertrange(a, e); }
 	void insertsorted(cstr s) throws; // uses gt()
 
+	using SUPER::parallel_rsort;
+	using SUPER::parallel_sort;
 	using SUPER::revert;
 	using SUPER::rol;
 	using SUPER::ror;
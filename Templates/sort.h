@@ -6,6 +6,10 @@
 #include "kio/kio.h"
 #include "relational_operators.h"
 #include "template_helpers.h"
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 
 // macro returns the type of the compare function for item type:
@@ -37,3 +41,394 @@ inline void rsort(TYPE* a, TYPE* e)
 {
 	sort(a, e, lt);
 }
+
+
+// ------------------------------------------------------------
+//			Stable sort range [a ... [e
+// ------------------------------------------------------------
+
+/*	Natural merge sort:
+	existing ascending runs and strictly descending runs (which are reversed) are detected
+	and short runs are extended to MINRUN items with a binary insertion sort.
+	then adjacent runs are merged until only one run is left.
+
+	Advantages:
+		the order of items with equal value is preserved
+		presorted and reversed data is sorted in O(n)
+		only gt() is needed
+	Disadvantages:
+		needs a temp buffer for n/2 items
+		items are moved with memcpy(), same as in Array<T>
+*/
+
+namespace kio
+{
+namespace sort_helpers
+{
+static constexpr uint MINRUN = 32;
+
+template<typename TYPE>
+inline void move_items(TYPE* z, const TYPE* q, size_t n) noexcept
+{
+	memcpy(reinterpret_cast<void*>(z), reinterpret_cast<const void*>(q), n * sizeof(TYPE));
+}
+
+template<typename TYPE>
+void insertion_sort(TYPE* a, TYPE* m, TYPE* e, COMPARATOR(TYPE) gt) noexcept
+{
+	// stable binary insertion sort
+	// range [a..[m is already sorted
+
+	alignas(TYPE) char z[sizeof(TYPE)];
+	for (; m < e; m++)
+	{
+		// find insertion point behind all items ≤ *m:
+		TYPE* lo = a;
+		TYPE* hi = m;
+		while (lo < hi)
+		{
+			TYPE* mid = lo + (hi - lo) / 2;
+			if (gt(*mid, *m)) hi = mid;
+			else lo = mid + 1;
+		}
+		if (lo == m) continue;
+
+		move_items(reinterpret_cast<TYPE*>(z), m, 1);
+		memmove(reinterpret_cast<void*>(lo + 1), reinterpret_cast<const void*>(lo), size_t(m - lo) * sizeof(TYPE));
+		move_items(lo, reinterpret_cast<TYPE*>(z), 1);
+	}
+}
+
+template<typename TYPE>
+void merge(TYPE* a, TYPE* m, TYPE* e, TYPE* tmp, COMPARATOR(TYPE) gt) noexcept
+{
+	// merge sorted ranges [a..[m and [m..[e
+	// the shorter range is moved to tmp[]
+	// an item from the right range is only taken if it is strictly smaller => stable
+
+	if (a == m || m == e || !gt(m[-1], *m)) return; // already in order
+
+	// skip items which are already in place:
+	while (!gt(*a, *m)) a++;
+	while (!gt(m[-1], e[-1])) e--;
+
+	if (m - a <= e - m) // merge upwards:
+	{
+		TYPE* l	 = tmp;
+		TYPE* le = tmp + (m - a);
+		TYPE* r	 = m;
+		TYPE* z	 = a;
+		move_items(tmp, a, size_t(m - a));
+
+		while (l < le && r < e)
+		{
+			if (gt(*l, *r)) move_items(z++, r++, 1);
+			else move_items(z++, l++, 1);
+		}
+		move_items(z, l, size_t(le - l));
+	}
+	else // merge downwards:
+	{
+		TYPE* l	 = m;
+		TYPE* r	 = tmp + (e - m);
+		TYPE* z	 = e;
+		move_items(tmp, m, size_t(e - m));
+
+		while (l > a && r > tmp)
+		{
+			if (gt(l[-1], r[-1])) move_items(--z, --l, 1);
+			else move_items(--z, --r, 1);
+		}
+		move_items(z - (r - tmp), tmp, size_t(r - tmp));
+	}
+}
+
+template<typename TYPE>
+TYPE* next_run(TYPE* a, TYPE* e, COMPARATOR(TYPE) gt) noexcept
+{
+	// find the end of the run starting at a
+	// a strictly descending run is reversed
+	// a short run is extended to MINRUN items
+
+	TYPE* p = a + 1;
+	if (p >= e) return e;
+
+	if (gt(*a, *p)) // strictly descending:
+	{
+		while (++p < e && gt(p[-1], *p)) {}
+		for (TYPE *pa = a, *pe = p - 1; pa < pe; pa++, pe--) std::swap(*pa, *pe);
+	}
+	else // ascending:
+	{
+		while (++p < e && !gt(p[-1], *p)) {}
+	}
+
+	if (p - a < MINRUN && p < e)
+	{
+		TYPE* m = p;
+		p		= e - a < MINRUN ? e : a + MINRUN;
+		insertion_sort(a, m, p, gt);
+	}
+	return p;
+}
+} // namespace sort_helpers
+} // namespace kio
+
+template<typename TYPE>
+void stable_sort(TYPE* a, TYPE* e, COMPARATOR(TYPE) gt) throws
+{
+	using namespace kio::sort_helpers;
+
+	if (e - a < 2) return;
+	size_t n = size_t(e - a);
+
+	// find runs:
+	std::unique_ptr<TYPE*[]> runs(new TYPE*[n / MINRUN + 2]);
+	size_t					 nruns = 0;
+	for (TYPE* p = a; p < e; p = next_run(p, e, gt)) runs[nruns++] = p;
+	runs[nruns] = e;
+
+	// merge adjacent runs until only one is left:
+	if (nruns > 1)
+	{
+		std::unique_ptr<char[]> tmp(new char[(n / 2 + 1) * sizeof(TYPE)]);
+		while (nruns > 1)
+		{
+			size_t i = 0;
+			for (; i + 1 < nruns; i += 2)
+			{
+				merge(runs[i], runs[i + 1], runs[i + 2], reinterpret_cast<TYPE*>(tmp.get()), gt);
+				runs[i / 2] = runs[i];
+			}
+			if (i < nruns) runs[i / 2] = runs[i];
+			nruns		= (nruns + 1) / 2;
+			runs[nruns] = e;
+		}
+	}
+}
+
+template<typename TYPE>
+inline void stable_sort(TYPE* a, TYPE* e) throws
+{
+	::stable_sort(a, e, gt);
+}
+template<typename TYPE>
+inline void stable_rsort(TYPE* a, TYPE* e) throws
+{
+	::stable_sort(a, e, lt);
+}
+
+
+// ------------------------------------------------------------
+//			Radix sort range [a ... [e
+// ------------------------------------------------------------
+
+/*	LSD radix sort with 8 bit digits:
+	keyfn(item) must return an integer or floating point key.
+	items are sorted in ascending order of their keys.
+	the order of items with equal keys is preserved.
+	passes where all keys have the same digit are skipped.
+
+	Disadvantage:
+		needs temp buffers for n items and 2*n keys
+		items are moved with memcpy(), same as in Array<T>
+*/
+
+namespace kio
+{
+namespace sort_helpers
+{
+// convert key to unsigned int with the same order:
+template<typename K>
+inline typename std::enable_if<std::is_integral<K>::value && sizeof(K) <= 4, uint32>::type radix_key(K k) noexcept
+{
+	return std::is_signed<K>::value ? uint32(int32(k)) ^ 0x80000000u : uint32(k);
+}
+template<typename K>
+inline typename std::enable_if<std::is_integral<K>::value && sizeof(K) == 8, uint64>::type radix_key(K k) noexcept
+{
+	return std::is_signed<K>::value ? uint64(k) ^ 0x8000000000000000u : uint64(k);
+}
+inline uint32 radix_key(float k) noexcept
+{
+	uint32 u;
+	memcpy(&u, &k, 4);
+	return u & 0x80000000u ? ~u : u | 0x80000000u;
+}
+inline uint64 radix_key(double k) noexcept
+{
+	uint64 u;
+	memcpy(&u, &k, 8);
+	return u & 0x8000000000000000u ? ~u : u | 0x8000000000000000u;
+}
+} // namespace sort_helpers
+} // namespace kio
+
+template<typename TYPE, typename KEYFN>
+void radix_sort(TYPE* a, TYPE* e, KEYFN keyfn) throws
+{
+	using namespace kio::sort_helpers;
+	using KEY				  = decltype(radix_key(keyfn(*a)));
+	static constexpr uint NUM = sizeof(KEY); // number of digits
+
+	if (e - a < 2) return;
+	size_t n = size_t(e - a);
+
+	std::unique_ptr<KEY[]>	keys(new KEY[n * 2]);
+	std::unique_ptr<char[]> items(new char[n * sizeof(TYPE)]);
+
+	// calculate keys and count digits for all passes:
+	std::unique_ptr<size_t[][256]> counts(new size_t[NUM][256]);
+	memset(counts.get(), 0, NUM * sizeof(counts[0]));
+	for (size_t i = 0; i < n; i++)
+	{
+		KEY k	= radix_key(keyfn(a[i]));
+		keys[i] = k;
+		for (uint d = 0; d < NUM; d++) { counts[d][(k >> (d * 8)) & 0xff]++; }
+	}
+
+	TYPE* src	  = a;
+	TYPE* dst	  = reinterpret_cast<TYPE*>(items.get());
+	KEY*  srckeys = keys.get();
+	KEY*  dstkeys = keys.get() + n;
+
+	for (uint d = 0; d < NUM; d++)
+	{
+		size_t* count = counts[d];
+		uint	shift = d * 8;
+		if (count[(srckeys[0] >> shift) & 0xff] == n) continue; // all keys have the same digit
+
+		size_t pos[256];
+		for (size_t i = 0, sum = 0; i < 256; i++)
+		{
+			pos[i] = sum;
+			sum += count[i];
+		}
+
+		for (size_t i = 0; i < n; i++)
+		{
+			size_t j	 = pos[(srckeys[i] >> shift) & 0xff]++;
+			dstkeys[j] = srckeys[i];
+			move_items(dst + j, src + i, 1);
+		}
+
+		std::swap(src, dst);
+		std::swap(srckeys, dstkeys);
+	}
+
+	if (src != a) move_items(a, src, n);
+}
+
+template<typename TYPE>
+inline void radix_sort(TYPE* a, TYPE* e) throws
+{
+	// sort integer or floating point numbers:
+	::radix_sort(a, e, [](TYPE k) { return k; });
+}
+
+
+// ------------------------------------------------------------
+//			Parallel sort range [a ... [e
+// ------------------------------------------------------------
+
+/*	Parallel stable sort for large arrays on multi-core machines:
+	the range is split into one chunk per thread and the chunks are sorted with stable_sort() on worker threads.
+	then adjacent chunks are merged in parallel until only one chunk is left.
+	the last merge runs on a single thread.
+
+	the result is identical to stable_sort() for any strict weak order
+	and independent of the number of threads.
+	ranges with less than PARALLEL_MIN items per thread are sorted with stable_sort() on the caller's thread.
+
+	nthreads = 0: use std::thread::hardware_concurrency()
+	if a thread can't be started then its job is done on the caller's thread.
+	exceptions thrown on worker threads are passed to the caller.
+*/
+
+namespace kio
+{
+namespace sort_helpers
+{
+static constexpr size_t PARALLEL_MIN = 1 << 15; // min. items per thread
+
+template<typename FN>
+void run_parallel(uint n, FN fn) throws
+{
+	// call fn(0) … fn(n-1) on n threads
+	// fn(0) runs on the caller's thread
+
+	std::exception_ptr error;
+	std::mutex		   mutex;
+	auto			   job = [&](uint i) {
+		  try
+		  {
+			  fn(i);
+		  }
+		  catch (...)
+		  {
+			  std::lock_guard<std::mutex> _(mutex);
+			  if (!error) error = std::current_exception();
+		  }
+	};
+
+	std::unique_ptr<std::thread[]> threads(new std::thread[n]);
+	for (uint i = 1; i < n; i++)
+	{
+		try
+		{
+			threads[i] = std::thread(job, i);
+		}
+		catch (...)
+		{
+			job(i);
+		}
+	}
+	job(0);
+	for (uint i = 1; i < n; i++)
+	{
+		if (threads[i].joinable()) threads[i].join();
+	}
+	if (error) std::rethrow_exception(error);
+}
+} // namespace sort_helpers
+} // namespace kio
+
+template<typename TYPE>
+void parallel_sort(TYPE* a, TYPE* e, COMPARATOR(TYPE) gt, uint nthreads = 0) throws
+{
+	using namespace kio::sort_helpers;
+
+	size_t n = size_t(e - a);
+	if (nthreads == 0) nthreads = std::thread::hardware_concurrency();
+	if (nthreads > n / PARALLEL_MIN) nthreads = uint(n / PARALLEL_MIN);
+	if (nthreads < 2) return ::stable_sort(a, e, gt);
+
+	// sort chunks:
+	std::unique_ptr<TYPE*[]> chunks(new TYPE*[nthreads + 1]);
+	for (uint i = 0; i <= nthreads; i++) chunks[i] = a + n * i / nthreads;
+	run_parallel(nthreads, [&](uint i) { ::stable_sort(chunks[i], chunks[i + 1], gt); });
+
+	// merge adjacent chunks until only one is left:
+	// a merge of [ra..[re needs (re-ra)/2 items in tmp[] => each merge uses its own part of tmp[]
+	std::unique_ptr<char[]> tmp(new char[(n / 2 + 1) * sizeof(TYPE)]);
+	for (uint nchunks = nthreads; nchunks > 1; nchunks = (nchunks + 1) / 2)
+	{
+		run_parallel(nchunks / 2, [&](uint i) {
+			TYPE* ra = chunks[2 * i];
+			merge(ra, chunks[2 * i + 1], chunks[2 * i + 2], reinterpret_cast<TYPE*>(tmp.get()) + (ra - a) / 2, gt);
+		});
+		for (uint i = 0; i < (nchunks + 1) / 2; i++) chunks[i] = chunks[2 * i];
+		chunks[(nchunks + 1) / 2] = e;
+	}
+}
+
+template<typename TYPE>
+inline void parallel_sort(TYPE* a, TYPE* e) throws
+{
+	::parallel_sort(a, e, gt);
+}
+template<typename TYPE>
+inline void parallel_rsort(TYPE* a, TYPE* e) throws
+{
+	::parallel_sort(a, e, lt);
+}
@@ -6,6 +6,7 @@
 #include "kio/kio.h"
 #include <condition_variable>
 #include <mutex>
+#include <shared_mutex>
 #include <thread>
 
 
@@ -37,6 +38,22 @@ public:
 };
 
 
+// reader/writer lock:
+// any number of readers or one writer
+class PRWLock : public std::shared_timed_mutex
+{
+	static constexpr PRWLock* NV(volatile PRWLock* p) { return const_cast<PRWLock*>(p); }
+
+public:
+	void lock() volatile { NV(this)->shared_timed_mutex::lock(); }
+	void unlock() volatile { NV(this)->shared_timed_mutex::unlock(); }
+	bool trylock() volatile { return NV(this)->shared_timed_mutex::try_lock(); } // true = success
+	void lock_shared() volatile { NV(this)->shared_timed_mutex::lock_shared(); }
+	void unlock_shared() volatile { NV(this)->shared_timed_mutex::unlock_shared(); }
+	bool trylock_shared() volatile { return NV(this)->shared_timed_mutex::try_lock_shared(); } // true = success
+};
+
+
 // =====================================================================
 // class which locks a mutex, PLock or similar in it's ctor and
 // unlocks it in it's dtor
@@ -49,6 +66,15 @@ public:
 	PLocker(volatile MUTEX* lock) : std::lock_guard<MUTEX>(*const_cast<MUTEX*>(lock)) {}
 };
 
+// same for a PRWLock or similar which is locked for reading:
+template<typename MUTEX>
+class PSharedLocker : public std::shared_lock<MUTEX>
+{
+public:
+	PSharedLocker(volatile MUTEX& lock) : std::shared_lock<MUTEX>(const_cast<MUTEX&>(lock)) {}
+	PSharedLocker(volatile MUTEX* lock) : std::shared_lock<MUTEX>(*const_cast<MUTEX*>(lock)) {}
+};
+
 
 // =====================================================================
 // Semaphore
@@ -4,6 +4,12 @@
 
 #include "utf8.h"
 #include "kio/kio.h"
+#if UTF8_SSE2
+  #include <emmintrin.h>
+#endif
+#if UTF8_AVX2
+  #include <immintrin.h>
+#endif
 
 
 namespace utf8
@@ -48,19 +54,13 @@ static cptr str_comp(cstr a, cstr b) noexcept
 //	4fup: c < %11111100		c <= %11111011		c = %111110xx
 //	5fup:										c = %111111xx
 
-uint charcount(cstr q) noexcept
-{
-	// count characters in utf-8 string
-	// the "Golden Rule": every non-fup makes a char
 
-	uint rval = 0;
-	if (q)
-		while (char c = *q++)
-		{
-			if (no_fup(c)) rval++;
-		}
-	return rval;
-}
+// ---------------------------------------------------------------------
+//			scalar kernels
+// ---------------------------------------------------------------------
+
+namespace scalar
+{
 uint charcount(cptr q, uint qsize) noexcept
 {
 	// count characters in utf-8 string
@@ -76,49 +76,516 @@ uint charcount(cptr q, uint qsize) noexcept
 	return rval;
 }
 
-uint max_css(cstr q) noexcept
+uint max_css(cptr q, uint qsize) noexcept
 {
 	// calculate size shift for required character size (ucs1, ucs2 or ucs4) to store utf-8 string
 	// note: csz = 1 << css
 
-	if (q)
-		while (char c = *q++)
+	cptr e = q + qsize;
+	while (q < e)
+	{
+		char c = *q++;
+		if (uchar(c) <= 0xC3) continue;
+		if (uchar(c) >= 0xF0) return 2;
+		while (q < e)
 		{
-			if (uchar(c) <= 0xC3) continue;
-			if (uchar(c) >= 0xF0) return 2;
-			while ((c = *q++))
-			{
-				if (uchar(c) >= 0xF0) return 2;
-			}
-			return 1;
+			if (uchar(*q++) >= 0xF0) return 2;
 		}
+		return 1;
+	}
 	return 0;
 }
-bool fits_in_ucs1(cstr q) noexcept
+
+bool fits_in_ucs1(cptr q, uint qsize) noexcept
 {
-	// test whether utf-8 string q can be encoded to ucs1
-	// note: if q contains broken characters then these will be replaced with '?' not $FFFD
-	//       and thus will not break the result of this function
+	for (cptr e = q + qsize; q < e;)
+	{
+		if (uchar(*q++) > 0xC3) return no;
+	}
+	return yes;
+}
 
-	if (q)
-		while (char c = *q++)
+bool fits_in_ucs2(cptr q, uint qsize) noexcept
+{
+	for (cptr e = q + qsize; q < e;)
+	{
+		if (uchar(*q++) >= 0xF0) return no;
+	}
+	return yes;
+}
+
+bool is_valid(cptr q, uint qsize) noexcept
+{
+	// test for valid utf-8 acc. to RFC 3629:
+	// no unexpected or missing fups, no overlong encodings, no surrogates $D800…$DFFF, nothing above $10FFFF
+	// 0 is a valid character
+
+	cptr e = q + qsize;
+	while (q < e)
+	{
+		uchar c = uchar(*q++);
+		if (c < 0x80) continue;
+
+		uint  n;		   // number of fups
+		uchar lo = 0x80; // range for the first fup
+		uchar hi = 0xBF;
+		if (c < 0xC2) return no; // fup or overlong 2-byte code
+		else if (c < 0xE0) n = 1;
+		else if (c < 0xF0)
+		{
+			n = 2;
+			if (c == 0xE0) lo = 0xA0; // overlong
+			if (c == 0xED) hi = 0x9F; // surrogate
+		}
+		else if (c < 0xF5)
+		{
+			n = 3;
+			if (c == 0xF0) lo = 0x90; // overlong
+			if (c == 0xF4) hi = 0x8F; // > $10FFFF
+		}
+		else return no; // > $10FFFF
+
+		if (uint(e - q) < n) return no; // truncated
+		if (uchar(*q) < lo || uchar(*q) > hi) return no;
+		for (uint i = 1; i < n; i++)
 		{
-			if (uchar(c) > 0xC3) return no;
+			if (!is_fup(q[i])) return no;
 		}
+		q += n;
+	}
 	return yes;
 }
-bool fits_in_ucs2(cstr q) noexcept
+} // namespace scalar
+
+
+// ---------------------------------------------------------------------
+//			SSE2 kernels
+// ---------------------------------------------------------------------
+
+#if UTF8_SSE2
+namespace sse2
 {
-	// test whether utf-8 string q can be encoded to ucs2
+static inline __m128i load(cptr p) noexcept { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
 
-	if (q)
-		while (char c = *q++)
+static inline bool any_ge(__m128i v, __m128i c) noexcept
+{
+	// any unsigned byte in v ≥ the byte in c?
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(v, c), v)) != 0;
+}
+
+static bool any_ge(cptr q, uint qsize, uchar c) noexcept
+{
+	cptr		  e	 = q + qsize;
+	const __m128i cc = _mm_set1_epi8(char(c));
+	for (; e - q >= 32; q += 32)
+	{
+		if (any_ge(_mm_max_epu8(load(q), load(q + 16)), cc)) return yes;
+	}
+	while (q < e)
+	{
+		if (uchar(*q++) >= c) return yes;
+	}
+	return no;
+}
+
+uint charcount(cptr q, uint qsize) noexcept
+{
+	// count non-fups 32 bytes at a time:
+	// no_fup(c) = int8(c) > int8(0xBF)
+	// the compare results (-1) are subtracted from byte counters
+	// which are summed up with psadbw before they can overflow
+
+	cptr		  e	  = q + qsize;
+	const __m128i fup = _mm_set1_epi8(char(0xBF));
+	uint		  rval = 0;
+
+	while (e - q >= 32)
+	{
+		__m128i acc = _mm_setzero_si128();
+		for (uint i = 0; i < 127 && e - q >= 32; i++, q += 32)
 		{
-			if (uchar(c) >= 0xF0) return no;
+			acc = _mm_sub_epi8(acc, _mm_cmpgt_epi8(load(q), fup));
+			acc = _mm_sub_epi8(acc, _mm_cmpgt_epi8(load(q + 16), fup));
 		}
-	return yes;
+		__m128i sum = _mm_sad_epu8(acc, _mm_setzero_si128());
+		rval += uint(_mm_cvtsi128_si32(sum)) + uint(_mm_cvtsi128_si32(_mm_srli_si128(sum, 8)));
+	}
+	return rval + scalar::charcount(q, uint(e - q));
+}
+
+uint max_css(cptr q, uint qsize) noexcept
+{
+	// the result depends only on the highest byte: ≥ 0xF0 ⇒ 2, > 0xC3 ⇒ 1
+
+	cptr		  e	 = q + qsize;
+	const __m128i f0 = _mm_set1_epi8(char(0xF0));
+	__m128i		  m	 = _mm_setzero_si128();
+	for (; e - q >= 32; q += 32)
+	{
+		m = _mm_max_epu8(m, _mm_max_epu8(load(q), load(q + 16)));
+		if (any_ge(m, f0)) return 2;
+	}
+
+	alignas(16) uchar bu[16];
+	_mm_store_si128(reinterpret_cast<__m128i*>(bu), m);
+	uchar c = 0;
+	for (uint i = 0; i < 16; i++) { c = max(c, bu[i]); }
+	while (q < e) { c = max(c, uchar(*q++)); }
+	return c >= 0xF0 ? 2 : c > 0xC3 ? 1 : 0;
+}
+
+bool fits_in_ucs1(cptr q, uint qsize) noexcept { return !any_ge(q, qsize, 0xC4); }
+bool fits_in_ucs2(cptr q, uint qsize) noexcept { return !any_ge(q, qsize, 0xF0); }
+} // namespace sse2
+#endif
+
+
+// ---------------------------------------------------------------------
+//			AVX2 kernels
+// ---------------------------------------------------------------------
+
+#if UTF8_AVX2
+  #define AVX2 __attribute__((target("avx2")))
+
+namespace avx2
+{
+AVX2 static inline __m256i load(cptr p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+
+AVX2 static inline bool any_ge(__m256i v, __m256i c) noexcept
+{
+	// any unsigned byte in v ≥ the byte in c?
+	return _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(v, c), v)) != 0;
+}
+
+AVX2 static bool any_ge(cptr q, uint qsize, uchar c) noexcept
+{
+	cptr		  e	 = q + qsize;
+	const __m256i cc = _mm256_set1_epi8(char(c));
+	for (; e - q >= 64; q += 64)
+	{
+		if (any_ge(_mm256_max_epu8(load(q), load(q + 32)), cc)) return yes;
+	}
+	if (e - q >= 32)
+	{
+		if (any_ge(load(q), cc)) return yes;
+		q += 32;
+	}
+	while (q < e)
+	{
+		if (uchar(*q++) >= c) return yes;
+	}
+	return no;
+}
+
+AVX2 uint charcount(cptr q, uint qsize) noexcept
+{
+	// count non-fups 32 bytes at a time: same as sse2::charcount()
+
+	cptr		  e	  = q + qsize;
+	const __m256i fup = _mm256_set1_epi8(char(0xBF));
+	uint		  rval = 0;
+
+	while (e - q >= 32)
+	{
+		__m256i acc = _mm256_setzero_si256();
+		for (uint i = 0; i < 255 && e - q >= 32; i++, q += 32)
+		{
+			acc = _mm256_sub_epi8(acc, _mm256_cmpgt_epi8(load(q), fup));
+		}
+		__m256i sum = _mm256_sad_epu8(acc, _mm256_setzero_si256());
+		__m128i s	= _mm_add_epi64(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+		rval += uint(_mm_cvtsi128_si32(s)) + uint(_mm_cvtsi128_si32(_mm_srli_si128(s, 8)));
+	}
+	return rval + scalar::charcount(q, uint(e - q));
+}
+
+AVX2 uint max_css(cptr q, uint qsize) noexcept
+{
+	// the result depends only on the highest byte: ≥ 0xF0 ⇒ 2, > 0xC3 ⇒ 1
+
+	cptr		  e	 = q + qsize;
+	const __m256i f0 = _mm256_set1_epi8(char(0xF0));
+	__m256i		  m	 = _mm256_setzero_si256();
+	for (; e - q >= 64; q += 64)
+	{
+		m = _mm256_max_epu8(m, _mm256_max_epu8(load(q), load(q + 32)));
+		if (any_ge(m, f0)) return 2;
+	}
+	if (e - q >= 32)
+	{
+		m = _mm256_max_epu8(m, load(q));
+		q += 32;
+	}
+
+	alignas(32) uchar bu[32];
+	_mm256_store_si256(reinterpret_cast<__m256i*>(bu), m);
+	uchar c = 0;
+	for (uint i = 0; i < 32; i++) { c = max(c, bu[i]); }
+	while (q < e) { c = max(c, uchar(*q++)); }
+	return c >= 0xF0 ? 2 : c > 0xC3 ? 1 : 0;
+}
+
+AVX2 bool fits_in_ucs1(cptr q, uint qsize) noexcept { return !any_ge(q, qsize, 0xC4); }
+AVX2 bool fits_in_ucs2(cptr q, uint qsize) noexcept { return !any_ge(q, qsize, 0xF0); }
+
+
+/*	utf-8 validation after John Keiser and Daniel Lemire:
+	"Validating UTF-8 In Less Than One Instruction Per Byte", Software: Practice and Experience, 2021.
+
+	Every byte is checked together with the previous byte:
+	3 lookup tables, indexed by the high and low nibble of the previous byte and by the high nibble of this byte,
+	return a set of error bits for each combination. An error is only present if all 3 tables agree.
+	The remaining errors, missing or surplus 3rd and 4th bytes, are found by testing
+	whether the byte 2 or 3 positions before is a 3- or 4-byte lead.
+*/
+
+static constexpr uint8 TOO_SHORT	  = 1 << 0; // 11______ 0_______   or   11______ 11______
+static constexpr uint8 TOO_LONG		  = 1 << 1; // 0_______ 10______
+static constexpr uint8 OVERLONG_3	  = 1 << 2; // 11100000 100_____
+static constexpr uint8 TOO_LARGE	  = 1 << 3; // 11110100 1001____   or   11110100 101_____   etc.
+static constexpr uint8 SURROGATE	  = 1 << 4; // 11101101 101_____
+static constexpr uint8 OVERLONG_2	  = 1 << 5; // 1100000_ 10______
+static constexpr uint8 TOO_LARGE_1000 = 1 << 6; // 11110101 1000____   etc.
+static constexpr uint8 OVERLONG_4	  = 1 << 6; // 11110000 1000____
+static constexpr uint8 TWO_CONTS	  = 1 << 7; // 10______ 10______
+static constexpr uint8 CARRY		  = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+  #define T16(A, B, C, D, E, F, G, H, I, J, K, L, M, N, O, P)                                            \
+	  _mm256_setr_epi8(char(A), char(B), char(C), char(D), char(E), char(F), char(G), char(H), char(I), \
+					   char(J), char(K), char(L), char(M), char(N), char(O), char(P), char(A), char(B), \
+					   char(C), char(D), char(E), char(F), char(G), char(H), char(I), char(J), char(K), \
+					   char(L), char(M), char(N), char(O), char(P))
+
+AVX2 static inline __m256i high_nibbles(__m256i v) noexcept
+{
+	return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F));
+}
+
+template<int N>
+AVX2 static inline __m256i prev(__m256i input, __m256i prev_input) noexcept
+{
+	// the bytes shifted by N positions with the last N bytes of prev_input shifted in
+	return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(prev_input, input, 0x21), 16 - N);
+}
+
+AVX2 static inline __m256i special_cases(__m256i input, __m256i prev1) noexcept
+{
+	const __m256i byte_1_high = T16(
+		// 0_______ ________ <ascii in byte 1>
+		TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+		// 10______ ________ <fup in byte 1>
+		TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+		// 1100____ ________ <2-byte lead>
+		TOO_SHORT | OVERLONG_2,
+		// 1101____ ________ <2-byte lead>
+		TOO_SHORT,
+		// 1110____ ________ <3-byte lead>
+		TOO_SHORT | OVERLONG_3 | SURROGATE,
+		// 1111____ ________ <4+-byte lead>
+		TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4);
+
+	const __m256i byte_1_low = T16(
+		// ____0000 ________
+		CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+		// ____0001 ________
+		CARRY | OVERLONG_2,
+		// ____001_ ________
+		CARRY, CARRY,
+		// ____0100 ________
+		CARRY | TOO_LARGE,
+		// ____0101 ________
+		CARRY | TOO_LARGE | TOO_LARGE_1000,
+		// ____011_ ________
+		CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+		// ____1___ ________
+		CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+		CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+		// ____1101 ________
+		CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+		// ____111_ ________
+		CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000);
+
+	const __m256i byte_2_high = T16(
+		// ________ 0_______ <ascii in byte 2>
+		TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+		// ________ 1000____
+		TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+		// ________ 1001____
+		TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+		// ________ 101_____
+		TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+		TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+		// ________ 11______
+		TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT);
+
+	__m256i a = _mm256_shuffle_epi8(byte_1_high, high_nibbles(prev1));
+	__m256i b = _mm256_shuffle_epi8(byte_1_low, _mm256_and_si256(prev1, _mm256_set1_epi8(0x0F)));
+	__m256i c = _mm256_shuffle_epi8(byte_2_high, high_nibbles(input));
+	return _mm256_and_si256(_mm256_and_si256(a, b), c);
+}
+
+AVX2 static inline __m256i multibyte_lengths(__m256i input, __m256i prev_input, __m256i special_cases) noexcept
+{
+	// the 3rd and 4th bytes of a sequence are flagged as TWO_CONTS by special_cases()
+	// a byte must be a 3rd or 4th byte if the byte 2 positions before is ≥ 0xE0 or 3 positions before is ≥ 0xF0
+
+	__m256i is_third  = _mm256_subs_epu8(prev<2>(input, prev_input), _mm256_set1_epi8(char(0xE0 - 0x80)));
+	__m256i is_fourth = _mm256_subs_epu8(prev<3>(input, prev_input), _mm256_set1_epi8(char(0xF0 - 0x80)));
+	__m256i must23_80 = _mm256_and_si256(_mm256_or_si256(is_third, is_fourth), _mm256_set1_epi8(char(0x80)));
+	return _mm256_xor_si256(must23_80, special_cases);
+}
+
+AVX2 static inline __m256i is_incomplete(__m256i input) noexcept
+{
+	// a lead byte in the last 3 bytes which needs more bytes than follow in this block
+
+	const __m256i max_value = _mm256_setr_epi8(
+		char(0xFF), char(0xFF), char(0xFF), char(0xFF), char(0xFF), char(0xFF), char(0xFF), char(0xFF), char(0xFF),
+		char(0xFF), char(0xFF), char(0xFF), char(0xFF), char(0xFF), char(0xFF), char(0xFF), char(0xFF), char(0xFF),
+		char(0xFF), char(0xFF), char(0xFF), char(0xFF), char(0xFF), char(0xFF), char(0xFF), char(0xFF), char(0xFF),
+		char(0xFF), char(0xFF), char(0xF0 - 1), char(0xE0 - 1), char(0xC0 - 1));
+	return _mm256_subs_epu8(input, max_value);
+}
+
+AVX2 static inline void check_block(__m256i input, __m256i& error, __m256i& prev_input, __m256i& prev_incomplete) noexcept
+{
+	if (_mm256_movemask_epi8(input) == 0)
+	{
+		// ascii only: the previous block must not end with an incomplete character
+		error = _mm256_or_si256(error, prev_incomplete);
+	}
+	else
+	{
+		__m256i sc		= special_cases(input, prev<1>(input, prev_input));
+		error			= _mm256_or_si256(error, multibyte_lengths(input, prev_input, sc));
+		prev_incomplete = is_incomplete(input);
+	}
+	prev_input = input;
+}
+
+AVX2 bool is_valid(cptr q, uint qsize) noexcept
+{
+	// test for valid utf-8 acc. to RFC 3629: same as scalar::is_valid()
+	// the last block is padded with 0: then an incomplete character at the end is detected as TOO_SHORT
+
+	cptr	e				= q + qsize;
+	__m256i error			= _mm256_setzero_si256();
+	__m256i prev_input		= _mm256_setzero_si256();
+	__m256i prev_incomplete = _mm256_setzero_si256();
+
+	for (; e - q >= 32; q += 32) { check_block(load(q), error, prev_input, prev_incomplete); }
+
+	if (q < e)
+	{
+		alignas(32) char bu[32] = {0};
+		memcpy(bu, q, size_t(e - q));
+		check_block(load(bu), error, prev_input, prev_incomplete);
+	}
+
+	error = _mm256_or_si256(error, prev_incomplete);
+	return _mm256_testz_si256(error, error);
+}
+
+  #undef T16
+  #undef AVX2
+} // namespace avx2
+#endif
+
+
+// ---------------------------------------------------------------------
+//			dispatcher
+// ---------------------------------------------------------------------
+
+bool has_avx2() noexcept
+{
+#if UTF8_AVX2
+	static const bool f = (__builtin_cpu_init(), __builtin_cpu_supports("avx2"));
+	return f;
+#else
+	return no;
+#endif
+}
+
+uint charcount(cptr q, uint qsize) noexcept
+{
+	// count characters in utf-8 string
+	// the "Golden Rule": every non-fup makes a char
+
+#if UTF8_AVX2
+	if (has_avx2()) return avx2::charcount(q, qsize);
+#endif
+#if UTF8_SSE2
+	return sse2::charcount(q, qsize);
+#else
+	return scalar::charcount(q, qsize);
+#endif
 }
 
+uint max_css(cptr q, uint qsize) noexcept
+{
+	// calculate size shift for required character size (ucs1, ucs2 or ucs4) to store utf-8 string
+	// note: csz = 1 << css
+
+#if UTF8_AVX2
+	if (has_avx2()) return avx2::max_css(q, qsize);
+#endif
+#if UTF8_SSE2
+	return sse2::max_css(q, qsize);
+#else
+	return scalar::max_css(q, qsize);
+#endif
+}
+
+bool fits_in_ucs1(cptr q, uint qsize) noexcept
+{
+	// test whether utf-8 string q can be encoded to ucs1
+	// note: if q contains broken characters then these will be replaced with '?' not $FFFD
+	//       and thus will not break the result of this function
+
+#if UTF8_AVX2
+	if (has_avx2()) return avx2::fits_in_ucs1(q, qsize);
+#endif
+#if UTF8_SSE2
+	return sse2::fits_in_ucs1(q, qsize);
+#else
+	return scalar::fits_in_ucs1(q, qsize);
+#endif
+}
+
+bool fits_in_ucs2(cptr q, uint qsize) noexcept
+{
+	// test whether utf-8 string q can be encoded to ucs2
+
+#if UTF8_AVX2
+	if (has_avx2()) return avx2::fits_in_ucs2(q, qsize);
+#endif
+#if UTF8_SSE2
+	return sse2::fits_in_ucs2(q, qsize);
+#else
+	return scalar::fits_in_ucs2(q, qsize);
+#endif
+}
+
+bool is_valid(cptr q, uint qsize) noexcept
+{
+	// test for valid utf-8 acc. to RFC 3629
+
+#if UTF8_AVX2
+	if (has_avx2()) return avx2::is_valid(q, qsize);
+#endif
+	return scalar::is_valid(q, qsize);
+}
+
+// 0-terminated strings:
+// strlen() is fast and the string is in the cache for the second pass.
+// the kernels must not read beyond the end of the string.
+
+uint charcount(cstr q) noexcept { return q ? charcount(q, uint(strlen(q))) : 0; }
+uint max_css(cstr q) noexcept { return q ? max_css(q, uint(strlen(q))) : 0; }
+bool fits_in_ucs1(cstr q) noexcept { return q ? fits_in_ucs1(q, uint(strlen(q))) : yes; }
+bool fits_in_ucs2(cstr q) noexcept { return q ? fits_in_ucs2(q, uint(strlen(q))) : yes; }
+bool is_valid(cstr q) noexcept { return q ? is_valid(q, uint(strlen(q))) : yes; }
+
 uint utf8strlen(const ucs1char* q, uint cnt) noexcept
 {
 	// calculate required size for an utf-8 string to store ucs1 string
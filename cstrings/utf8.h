@@ -257,9 +257,57 @@ inline cptr prevchar(cptr a, cptr p) noexcept
 extern uint charcount(cstr) noexcept;				// count characters in utf-8 string; 0-terminated
 extern uint charcount(cptr q, uint qsize) noexcept; // count characters in utf-8 string
 extern uint max_css(cstr) noexcept;					// character size shift required for utf-8 string
+extern uint max_css(cptr q, uint qsize) noexcept;
 inline uint max_csz(cstr s) noexcept { return 1u << max_css(s); }
 extern bool fits_in_ucs1(cstr) noexcept;
+extern bool fits_in_ucs1(cptr q, uint qsize) noexcept;
 extern bool fits_in_ucs2(cstr) noexcept;
+extern bool fits_in_ucs2(cptr q, uint qsize) noexcept;
+extern bool is_valid(cstr) noexcept; // test for valid utf-8 acc. to RFC 3629; 0-terminated
+extern bool is_valid(cptr q, uint qsize) noexcept;
+
+/*	The above functions use SSE2 or AVX2 kernels if available.
+	AVX2 is detected at runtime. is_valid() needs AVX2, else it uses the scalar kernel.
+	The kernels are exported for the tests:
+*/
+#if defined(__SSE2__)
+  #define UTF8_SSE2 1
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  #define UTF8_AVX2 1
+#endif
+
+extern bool has_avx2() noexcept; // cpu supports AVX2
+
+namespace scalar
+{
+extern uint charcount(cptr q, uint qsize) noexcept;
+extern uint max_css(cptr q, uint qsize) noexcept;
+extern bool fits_in_ucs1(cptr q, uint qsize) noexcept;
+extern bool fits_in_ucs2(cptr q, uint qsize) noexcept;
+extern bool is_valid(cptr q, uint qsize) noexcept;
+} // namespace scalar
+
+#if UTF8_SSE2
+namespace sse2
+{
+extern uint charcount(cptr q, uint qsize) noexcept;
+extern uint max_css(cptr q, uint qsize) noexcept;
+extern bool fits_in_ucs1(cptr q, uint qsize) noexcept;
+extern bool fits_in_ucs2(cptr q, uint qsize) noexcept;
+} // namespace sse2
+#endif
+
+#if UTF8_AVX2
+namespace avx2 // must only be called if has_avx2()
+{
+extern uint charcount(cptr q, uint qsize) noexcept;
+extern uint max_css(cptr q, uint qsize) noexcept;
+extern bool fits_in_ucs1(cptr q, uint qsize) noexcept;
+extern bool fits_in_ucs2(cptr q, uint qsize) noexcept;
+extern bool is_valid(cptr q, uint qsize) noexcept;
+} // namespace avx2
+#endif
 
 inline uint charcount(const ucs1char* q) noexcept
 {
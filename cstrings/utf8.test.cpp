@@ -0,0 +1,324 @@
+// Copyright (c) 2025 kio@little-bat.de
+// BSD-2-Clause license
+// https://opensource.org/licenses/BSD-2-Clause
+
+#include "Templates/Array.h"
+#include "doctest/doctest/doctest.h"
+#include "utf8.h"
+
+
+/*	The SSE2 and AVX2 kernels are compared with the scalar kernels:
+	single bytes and byte sequences are tested at all positions in a string,
+	so that they are tested in every lane, across block boundaries and in the scalar tail.
+*/
+
+namespace
+{
+using Charcount = uint (*)(cptr, uint);
+using Test		= bool (*)(cptr, uint);
+
+struct Kernels
+{
+	cstr	  name;
+	Charcount charcount;
+	Charcount max_css;
+	Test	  fits_in_ucs1;
+	Test	  fits_in_ucs2;
+	Test	  is_valid; // or nullptr
+};
+
+Array<Kernels> simd_kernels()
+{
+	Array<Kernels> z;
+#if UTF8_SSE2
+	z << Kernels {"sse2", utf8::sse2::charcount, utf8::sse2::max_css, utf8::sse2::fits_in_ucs1,
+				  utf8::sse2::fits_in_ucs2, nullptr};
+#endif
+#if UTF8_AVX2
+	if (utf8::has_avx2())
+		z << Kernels {"avx2", utf8::avx2::charcount, utf8::avx2::max_css, utf8::avx2::fits_in_ucs1,
+					  utf8::avx2::fits_in_ucs2, utf8::avx2::is_valid};
+#endif
+	return z;
+}
+
+const Kernels scalar_kernels {"scalar", utf8::scalar::charcount, utf8::scalar::max_css, utf8::scalar::fits_in_ucs1,
+							  utf8::scalar::fits_in_ucs2, utf8::scalar::is_valid};
+
+uint compare(const Kernels& k, cptr q, uint n)
+{
+	// compare kernels k with the scalar kernels
+	// returns number of mismatches
+
+	const Kernels& s = scalar_kernels;
+
+	uint errors = (k.charcount(q, n) != s.charcount(q, n)) + (k.max_css(q, n) != s.max_css(q, n)) +
+				  (k.fits_in_ucs1(q, n) != s.fits_in_ucs1(q, n)) + (k.fits_in_ucs2(q, n) != s.fits_in_ucs2(q, n));
+	if (k.is_valid) errors += k.is_valid(q, n) != s.is_valid(q, n);
+	return errors;
+}
+
+uint compare_is_valid(const Kernels& k, cptr q, uint n)
+{
+	// the other kernels test single bytes and are fully covered by "all bytes at all positions"
+	return k.is_valid(q, n) != utf8::scalar::is_valid(q, n);
+}
+
+uint64 random64() { return (uint64(random()) << 33) ^ (uint64(random()) << 11) ^ uint64(random()); }
+} // namespace
+
+
+TEST_CASE("utf8")
+{
+	SUBCASE("") { logline("●●● %s:", __FILE__); }
+
+	SUBCASE("kernels")
+	{
+		Array<Kernels> kernels = simd_kernels();
+		for (uint i = 0; i < kernels.count(); i++) logline("utf8 kernel: %s", kernels[i].name);
+		CHECK(utf8::has_avx2() == (kernels.count() && kernels.last().is_valid != nullptr));
+	}
+
+	SUBCASE("is_valid")
+	{
+		CHECK(utf8::is_valid(""));
+		CHECK(utf8::is_valid("aÄÿ€𝄞"));
+		CHECK(utf8::is_valid("\x7F\xC2\x80\xDF\xBF\xE0\xA0\x80\xEF\xBF\xBF\xF0\x90\x80\x80\xF4\x8F\xBF\xBF"));
+		CHECK(utf8::is_valid("x", 2)); // with the 0
+		CHECK(!utf8::is_valid("\x80"));
+		CHECK(!utf8::is_valid("\xC0\x80"));			// overlong
+		CHECK(!utf8::is_valid("\xC1\xBF"));			// overlong
+		CHECK(!utf8::is_valid("\xE0\x9F\xBF"));		// overlong
+		CHECK(!utf8::is_valid("\xF0\x8F\xBF\xBF"));	// overlong
+		CHECK(!utf8::is_valid("\xED\xA0\x80"));		// surrogate
+		CHECK(!utf8::is_valid("\xF4\x90\x80\x80"));	// > $10FFFF
+		CHECK(!utf8::is_valid("\xF5\x80\x80\x80"));	// > $10FFFF
+		CHECK(!utf8::is_valid("\xF8\x88\x80\x80\x80")); // 5 bytes
+		CHECK(!utf8::is_valid("\xE2\x82"));			// truncated
+		CHECK(!utf8::is_valid("\xE2\x82x"));			// truncated
+		CHECK(!utf8::is_valid("\xC3\xA4\xA4"));		// unexpected fup
+		CHECK(!utf8::is_valid("\xFF"));
+
+		Array<Kernels> kernels = simd_kernels();
+		for (uint i = 0; i < kernels.count(); i++)
+		{
+			if (!kernels[i].is_valid) continue;
+			cstr s = "\xF0\x90\x80\x80 aÄÿ€𝄞 abcdefghijklmnopqrstuvwxyz 0123456789 aÄÿ€𝄞 \xE2\x82";
+			CHECK(!kernels[i].is_valid(s, uint(strlen(s))));
+			CHECK(kernels[i].is_valid(s, uint(strlen(s)) - 2));
+		}
+	}
+
+	SUBCASE("all bytes at all positions")
+	{
+		// every byte at every position in strings of 0 to 99 bytes
+		// the other bytes are ascii or 2-byte characters
+
+		Array<Kernels> kernels = simd_kernels();
+		char		   bu[100];
+		uint		   errors = 0;
+
+		for (uint k = 0; k < kernels.count(); k++)
+		{
+			for (uint n = 1; n < 100; n++)
+			{
+				for (uint i = 0; i < n; i++) bu[i] = n & 1 ? 'a' + char(i % 26) : i & 1 ? char(0xA4) : char(0xC3);
+				for (uint i = 0; i < n; i++)
+				{
+					char c = bu[i];
+					for (uint b = 0; b < 256; b++)
+					{
+						bu[i] = char(b);
+						errors += compare(kernels[k], bu, n);
+					}
+					bu[i] = c;
+				}
+			}
+		}
+		CHECK(errors == 0);
+	}
+
+	SUBCASE("all 1, 2 and 3 byte sequences")
+	{
+		// is_valid(): every sequence across the block boundaries at 16 and 32
+		// and at the end of the string
+
+		Array<Kernels> kernels = simd_kernels();
+		char		   bu[40];
+		uint		   errors = 0;
+
+		for (uint k = 0; k < kernels.count(); k++)
+		{
+			if (!kernels[k].is_valid) continue;
+			memset(bu, 'a', sizeof(bu));
+			for (uint i = 0; i < 0x1000000; i++)
+			{
+				bu[15] = bu[30] = char(i >> 16);
+				bu[16] = bu[31] = char(i >> 8);
+				bu[17] = bu[32] = char(i);
+				errors += compare_is_valid(kernels[k], bu, 40);
+				errors += compare_is_valid(kernels[k], bu, 33);
+			}
+		}
+		CHECK(errors == 0);
+	}
+
+	SUBCASE("4 byte sequences")
+	{
+		// is_valid(): all lead bytes with fups and other bytes from the interesting ranges
+		// at all positions around the block boundary at 32
+
+		static const uchar other[] = {0x00, 0x41, 0x7F, 0x80, 0x8F, 0x90, 0x9F, 0xA0, 0xBF,
+									  0xC0, 0xC2, 0xDF, 0xE0, 0xED, 0xEF, 0xF0, 0xF4, 0xF5};
+
+		Array<Kernels> kernels = simd_kernels();
+		char		   bu[48];
+		uint		   errors = 0;
+
+		for (uint k = 0; k < kernels.count(); k++)
+		{
+			if (!kernels[k].is_valid) continue;
+			for (uint pos = 26; pos <= 32; pos++)
+			{
+				memset(bu, 'a', sizeof(bu));
+				for (uint b = 0x80; b < 0x100; b++)
+					for (uchar c1 : other)
+						for (uchar c2 : other)
+							for (uchar c3 : other)
+							{
+								bu[pos]		= char(b);
+								bu[pos + 1] = char(c1);
+								bu[pos + 2] = char(c2);
+								bu[pos + 3] = char(c3);
+								errors += compare_is_valid(kernels[k], bu, 48);
+								errors += compare_is_valid(kernels[k], bu, pos + 4);
+							}
+			}
+		}
+		CHECK(errors == 0);
+	}
+
+	SUBCASE("random strings")
+	{
+		// long strings of valid characters with some broken bytes
+		// at all alignments and with all lengths of the scalar tail
+
+		static cstr chars[] = {"a", "Z", "\t", "ä", "ÿ", "€", "\xEF\xBF\xBF", "𝄞", "\xF4\x8F\xBF\xBF", "\xC2\x80"};
+
+		Array<Kernels> kernels = simd_kernels();
+		Array<char>	   bu;
+		uint		   errors = 0;
+
+		for (uint i = 0; i < 2000; i++)
+		{
+			bu.purge();
+			uint n = 32 + uint(random()) % 3000;
+			while (bu.count() < n)
+			{
+				cstr c = chars[uint(random()) % NELEM(chars)];
+				bu.append(c, uint(strlen(c)));
+			}
+			if (i & 1) bu[uint(random()) % bu.count()] = char(random());
+
+			uint a = uint(random()) % 32;
+			for (uint k = 0; k < kernels.count(); k++)
+			{
+				errors += compare(kernels[k], bu.getData() + a, bu.count() - a);
+				errors += compare(kernels[k], bu.getData(), bu.count() - a);
+			}
+		}
+		CHECK(errors == 0);
+
+		// the byte counters must not overflow:
+		bu.purge();
+		bu.grow(100000);
+		memset(bu.getData(), 'a', bu.count());
+		CHECK(utf8::charcount(bu.getData(), bu.count()) == bu.count());
+		for (uint k = 0; k < kernels.count(); k++) CHECK(kernels[k].charcount(bu.getData(), bu.count()) == bu.count());
+	}
+
+	SUBCASE("0-terminated strings")
+	{
+		CHECK(utf8::charcount(cstr(nullptr)) == 0);
+		CHECK(utf8::max_css(cstr(nullptr)) == 0);
+		CHECK(utf8::fits_in_ucs1(cstr(nullptr)));
+		CHECK(utf8::fits_in_ucs2(cstr(nullptr)));
+		CHECK(utf8::is_valid(cstr(nullptr)));
+
+		cstr s = "abcdefghijklmnopqrstuvwxyz 0123456789 aÄÿ abcdefghijklmnopqrstuvwxyz";
+		CHECK(utf8::charcount(s) == strlen(s) - 2);
+		CHECK(utf8::max_css(s) == 0);
+		CHECK(utf8::fits_in_ucs1(s));
+		s = "abcdefghijklmnopqrstuvwxyz 0123456789 aÄÿ€ abcdefghijklmnopqrstuvwxyz";
+		CHECK(utf8::charcount(s) == strlen(s) - 4);
+		CHECK(utf8::max_css(s) == 1);
+		CHECK(!utf8::fits_in_ucs1(s));
+		CHECK(utf8::fits_in_ucs2(s));
+		s = "abcdefghijklmnopqrstuvwxyz 0123456789 aÄÿ€𝄞 abcdefghijklmnopqrstuvwxyz";
+		CHECK(utf8::charcount(s) == strlen(s) - 7);
+		CHECK(utf8::max_css(s) == 2);
+		CHECK(!utf8::fits_in_ucs2(s));
+		CHECK(utf8::is_valid(s));
+	}
+}
+
+
+static void time_kernels(const Kernels& k, cptr q, uint n, uint reps, cstr where)
+{
+	// run every kernel reps times over the text and log the throughput
+
+	uint   cc = 0, cs = 0;
+	bool   u1 = yes, u2 = yes, ok = yes;
+	double t0 = now();
+	for (uint i = 0; i < reps; i++) cc += k.charcount(q, n);
+	double t1 = now();
+	for (uint i = 0; i < reps; i++) cs |= k.max_css(q, n);
+	double t2 = now();
+	for (uint i = 0; i < reps; i++) u1 &= k.fits_in_ucs1(q, n);
+	double t3 = now();
+	for (uint i = 0; i < reps; i++) u2 &= k.fits_in_ucs2(q, n);
+	double t4 = now();
+	for (uint i = 0; k.is_valid && i < reps; i++) ok &= k.is_valid(q, n);
+	double t5 = now();
+
+	CHECK(cc == reps * scalar_kernels.charcount(q, n));
+	CHECK(cs == 0);
+	CHECK(u1);
+	CHECK(u2);
+	CHECK(ok);
+
+	double bytes = double(n) * reps;
+	auto   gbs	 = [bytes](double t) { return bytes / t / 1e9; };
+	str	   s	 = usingstr("utf8::%-6s %s: charcount %5.2f GB/s, max_css %5.2f GB/s, fits_in_ucs1 %5.2f GB/s, "
+							"fits_in_ucs2 %5.2f GB/s",
+							k.name, where, gbs(t1 - t0), gbs(t2 - t1), gbs(t3 - t2), gbs(t4 - t3));
+	if (k.is_valid) s = catstr(s, usingstr(", is_valid %5.2f GB/s", gbs(t5 - t4)));
+	logline("%s", s);
+}
+
+TEST_CASE("utf8 performance test" * doctest::skip(false))
+{
+	// log file like text: mostly ascii with some 2-byte characters which fit in ucs1
+	// so that no function can return early
+	// 64 MB are limited by the memory bandwidth, 64 kB in the L2 cache show the speed of the kernels
+
+	static const uint N = 64 << 20;
+	static const uint M = 64 << 10;
+
+	Array<char> text(0u, N + 100);
+	while (text.count() < N)
+	{
+		cstr s = usingstr("%08x: Größe=%u, Preis=%u EUR, Status=%s\n", uint(random64()), uint(random()) % 1000,
+						  uint(random()) % 100, random() & 15 ? "ok" : "Fehler: ungültig");
+		text.append(s, uint(strlen(s)));
+	}
+	CHECK(utf8::scalar::is_valid(text.getData(), text.count()));
+	uint m = M;
+	while (utf8::is_fup(text[m])) { m--; }
+
+	Array<Kernels> kernels = simd_kernels();
+	kernels.insertat(0, scalar_kernels);
+
+	for (uint k = 0; k < kernels.count(); k++) time_kernels(kernels[k], text.getData(), text.count(), 1, "64 MB");
+	for (uint k = 0; k < kernels.count(); k++) time_kernels(kernels[k], text.getData(), m, N / M, "64 kB");
+}
@@ -55,6 +55,18 @@ inline uint32 hash(long key) { return hash(uint32(key)); }
   #endif
 #endif
 
+inline uint64 fmix64(uint64 k) noexcept
+{
+	// murmur3 finalizer: bijective
+	// spreads a hash() over 64 bits, e.g. for double hashing
+	k ^= k >> 33;
+	k *= 0xff51afd7ed558ccdull;
+	k ^= k >> 33;
+	k *= 0xc4ceb9fe1a85ec53ull;
+	k ^= k >> 33;
+	return k;
+}
+
 // keys must compare what is hashed:
 template<typename T>
 inline bool same(T a, T b)
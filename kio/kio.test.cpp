@@ -45,6 +45,16 @@ TEST_CASE("kio/util/")
 		for (int8 a = 0x2f, n = 0; n < 8; n++, a = int8((a << 1) + (a < 0))) { CHECK(count1bits(a) == 5); }
 	}
 
+	SUBCASE("lsbit")
+	{
+		CHECK(lsbit(uint32(1)) == 0);
+		CHECK(lsbit(uint32(0x80000000)) == 31);
+		CHECK(lsbit(uint32(0x01020300)) == 8);
+		CHECK(lsbit(uint64(1)) == 0);
+		CHECK(lsbit(uint64(0x8000000000000000)) == 63);
+		CHECK(lsbit(uint64(0x0102030000000000)) == 40);
+	}
+
 	SUBCASE("count1bits")
 	{
 		uint8 bu[] = {
@@ -23,21 +23,29 @@ inline uint count1bits(uint16 z) noexcept
 
 inline uint count1bits(uint32 z) noexcept
 {
+#if defined(__POPCNT__) || defined(__aarch64__)
+	return uint(__builtin_popcount(z)); // hardware popcount
+#else
 	z = ((z & 0xAAAAAAAAu) >> 1) + (z & 0x55555555u);
 	z = ((z & 0xCCCCCCCCu) >> 2) + (z & 0x33333333u);
 	z = ((z & 0xF0F0F0F0u) >> 4) + (z & 0x0F0F0F0Fu);
 	z = ((z & 0xFF00FF00u) >> 8) + (z & 0x00FF00FFu);
 	return (z >> 16) + (z & 0x0000FFFFu);
+#endif
 }
 
 inline uint count1bits(uint64 z) noexcept
 {
+#if defined(__POPCNT__) || defined(__aarch64__)
+	return uint(__builtin_popcountll(z)); // hardware popcount
+#else
 	z = ((z & 0xAAAAAAAAAAAAAAAAuL) >> 1) + (z & 0x5555555555555555uL);
 	z = ((z & 0xCCCCCCCCCCCCCCCCuL) >> 2) + (z & 0x3333333333333333uL);
 	z = ((z & 0xF0F0F0F0F0F0F0F0uL) >> 4) + (z & 0x0F0F0F0F0F0F0F0FuL);
 	z = ((z & 0xFF00FF00FF00FF00uL) >> 8) + (z & 0x00FF00FF00FF00FFuL);
 	z = ((z & 0xFFFF0000FFFF0000uL) >> 16) + (z & 0x0000FFFF0000FFFFuL);
 	return uint32(z >> 32) + uint32(z);
+#endif
 }
 
 inline uint count1bits(int8 z) noexcept { return count1bits(uint8(z)); }
@@ -66,6 +66,15 @@ inline constexpr int msbit(uint64 n) noexcept
 	return b;
 } // 0 .. 63
 
+/* ----	Calculate the position of the rightmost '1' bit -----------------
+		return value:
+				lsbit(n>0) = number of trailing '0' bits
+		note:	lsbit(n=1) = 0
+		caveat:	lsbit(n=0) = undefined		// illegal argument!
+*/
+inline int lsbit(uint32 n) noexcept { return __builtin_ctz(n); }	 // 0 .. 31
+inline int lsbit(uint64 n) noexcept { return __builtin_ctzll(n); } // 0 .. 63
+
 // this is a PITA
 #include <type_traits>
 #define only_if_int8 \
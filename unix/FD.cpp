@@ -10,6 +10,7 @@
 
 
 #include "FD.h"
+#include "Templates/PooledStrArray.h"
 #include "Templates/StrArray.h"
 #include "kio/kio.h"
 #include <fcntl.h>
@@ -617,6 +618,20 @@ void FD::read_file(StrArray& a, uint32 maxsize)
 	for (uint i = 0; i < z.count(); i++) a.append(z[i]);
 }
 
+/*	read file into PooledStrArray
+	the file is read into one chunk of the pool and split in place
+	the lines are appended, same as for StrArray
+*/
+void FD::read_file(PooledStrArray& a, uint32 maxsize)
+{
+	off_t sz = file_remaining();
+	if (sz > maxsize) throw FileError(fd, fpath, limiterror, "fd547");
+	uint32 n = uint32(sz);
+	ptr	   s = a.alloc_buffer(n);
+	read_bytes(s, n);
+	a.split_buffer(s, s + n);
+}
+
 
 /*	write StrArray to file
 	the lines are separated with '\n'
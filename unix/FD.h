@@ -136,7 +136,8 @@ public:
 
 	void read_file(Array<str>&, uint32 max = 1 << 28); // temp mem
 	void read_file(Array<cstr>& a, uint32 max = 1 << 28) { read_file(reinterpret_cast<Array<str>&>(a), max); }
-	void read_file(class StrArray&, uint32 max = 1 << 28); // new[]
+	void read_file(class StrArray&, uint32 max = 1 << 28);		 // new[]
+	void read_file(class PooledStrArray&, uint32 max = 1 << 28); // pool
 	void write_file(const Array<str>&);
 	void write_file(const Array<cstr>& a) { write_file(reinterpret_cast<const Array<str>&>(a)); }
 